@@ -151,14 +151,14 @@ Check : 'endl' -e '[^:_]endl[^a-z]'
 Check '<cassert>' -e 'assert('
 Check '<cstddef>' -e '[^_N]NULL\([^P]\|$\)'
 Check '<cstdio>' -e fopen -e fclose -e fflush -e '[^A-Z_]FILE[^A-Z_]' -e 'printf(' -e fseek -e 'puts(' -e 'putc('
-Check '<cstdlib>' -e '[^_a-z]exit[^_]' -e '[^.>]free[^a-z]' -e malloc -e getenv -e strtol -e EXIT_SUCCESS -e EXIT_FAILURE
-Check '<cstring>' -e strdup -e strlen -e strndup -e strcmp -e strncmp -e strncpy -e strchr -e strrchr -e strerror -e memset -e memcpy
+Check '<cstdlib>' -e '[^_a-z]exit[^_]' -e '[^.>]free[^a-z]' -e malloc -e atexit -e getenv -e strtol -e EXIT_SUCCESS -e EXIT_FAILURE
+Check '<cstring>' -e strdup -e strlen -e strndup -e strcmp -e strncmp -e strcpy -e strncpy -e strchr -e strrchr -e strstr -e strerror -e memset -e memcpy
 Check '<csignal>' -e signal -e sigaction
 Check '<cerrno>' -e '[^c]errno'
-Check '<ctime>' -e time_t
+Check '<ctime>' -e time_t -e clock
 Check '<fcntl\.h>' -e '[^a-z_.]open(' -e '[^a-z_.]close(' -e '[^a-z_.]open (' -e '[^a-z_.]close ('
 Check '<unistd\.h>' -e '[^a-z]_exit' -e '[^a-z]exec[lv]' -e setuid -e getuid -e chown -e '[^a-z_.]close(' -e isatty
-Check '<sys/types\.h>' -e uid_t -e gid_t -e "size_t[^y]" -e off_t
+Check '<sys/types\.h>' -e uid_t -e gid_t -e "size_t[^y]" -e off_t -e pid_t
 Check '<sys/stat\.h>' -e fchown -e fchmod -e 'stat[^a-z]'
 Check '<sys/mman\.h>' -e mmap
 
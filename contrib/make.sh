@@ -24,6 +24,8 @@ Available options are
   -G  Use default CXX (mnemonic: GNU)
   -s  With sqlite
   -S  Without sqlite
+  -p  With PCRE2
+  -P  Without PCRE2
   -C  Avoid CCACHE
   -x  Recache (i.e. ignore broken ccache)
   -X  Clear CCACHE
@@ -114,7 +116,7 @@ command -v clang++ >/dev/null 2>&1 && clang=: || clang=false
 dialect='enable'
 nopie_security=:
 OPTIND=1
-while getopts 'q1234gGdnewWsSrOoCxXyYdc:j:hH' opt
+while getopts 'q1234gGdnewWsSpPrOoCxXyYdc:j:hH' opt
 do	case $opt in
 	q)	quiet=:;;
 	1)	separate_all=false;;
@@ -133,6 +135,8 @@ do	case $opt in
 	W)	warnings=false;;
 	s)	configure_extra=$configure_extra' --with-sqlite';;
 	S)	configure_extra=$configure_extra' --without-sqlite';;
+	p)	configure_extra=$configure_extra' --with-pcre2';;
+	P)	configure_extra=$configure_extra' --without-pcre2';;
 	r)	use_chown=:;;
 	O)	optimization=:;;
 	o)	nopie_security=false;;
@@ -14,6 +14,8 @@
 #include <ctime>
 
 #include <fstream>
+#include <istream>
+#include <sstream>
 #include <string>
 
 #include "cache/base.h"
@@ -31,6 +33,25 @@
 using std::string;
 
 using std::ifstream;
+using std::istream;
+using std::istringstream;
+
+static void parse_lines(WordMap *map, istream *is) ATTRIBUTE_NONNULL_;
+
+/**
+Add the "key=value" lines of is to map
+**/
+static void parse_lines(WordMap *map, istream *is) {
+	while(likely(is->good())) {
+		string lbuf;
+		getline(*is, lbuf);
+		string::size_type p(lbuf.find('='));
+		if(p == string::npos) {
+			continue;
+		}
+		(*map)[lbuf.substr(0, p)].assign(lbuf, p + 1, string::npos);
+	}
+}
 
 bool AssignReader::get_map(const char *file) {
 	if(currfile == NULLPTR) {
@@ -48,20 +69,24 @@ bool AssignReader::get_map(const char *file) {
 	if(unlikely(!is.is_open())) {
 		return (currstate = false);
 	}
-
-	while(likely(is.good())) {
-		string lbuf;
-		getline(is, lbuf);
-		string::size_type p(lbuf.find('='));
-		if(p == string::npos) {
-			continue;
-		}
-		(*cf)[lbuf.substr(0, p)].assign(lbuf, p + 1, string::npos);
-	}
+	parse_lines(cf, &is);
 	is.close();
 	return (currstate = true);
 }
 
+void AssignReader::set_content(const char *filename, const string& content) {
+	if(currfile == NULLPTR) {
+		currfile = new string(filename);
+		cf = new WordMap;
+	} else {
+		currfile->assign(filename);
+		cf->clear();
+	}
+	istringstream is(content);
+	parse_lines(cf, &is);
+	currstate = true;
+}
+
 const char *AssignReader::get_md5sum(const char *filename) {
 	if(unlikely(!get_map(filename))) {
 		return NULLPTR;
@@ -41,6 +41,12 @@ class AssignReader : public BasicReader {
 		void get_keywords_slot_iuse_restrict(const std::string& filename, std::string *eapi, std::string *keywords, std::string *slotname, std::string *iuse, std::string *required_use, std::string *restr, std::string *props, Depend *dep) ATTRIBUTE_NONNULL_;
 		void read_file(const char *filename, Package *pkg) ATTRIBUTE_NONNULL_;
 
+		/**
+		Use content (e.g. from an archive) as the data of filename
+		instead of reading the file
+		**/
+		void set_content(const char *filename, const std::string& content) ATTRIBUTE_NONNULL_;
+
 	private:
 		bool get_map(const char *file) ATTRIBUTE_NONNULL_;
 
@@ -15,6 +15,7 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include <cerrno>
 #include <csignal>
 #include <cstdlib>
 #include <cstring>
@@ -51,6 +52,7 @@ class EbuildExecSettings {
 		string portage_rootpath;
 		string portage_bin_path, portage_pym_path, exec_ebuild_sh;
 		bool read_portage_paths, know_portage_paths;
+		EbuildExec::Jobs::size_type max_jobs;
 
 		void init();
 		bool init_ebuild_sh(const EbuildExec *e);
@@ -66,10 +68,9 @@ void ebuild_sig_handler(int sig) {
 // Take care:
 // Since handler_arg is static, add_handler will not be reentrant,
 // even for different instances of EbuildExec.
-// However, as long as add_handler() and remove_handler() are
-// only called internally within the same public function
-// of EbuildExec (and EbuildExec does not call other instances),
-// this is not a problem from "outside" this class.
+// However, the handler is only set while some job of the instance is
+// running, and all jobs are waited for before another instance is used.
+// Hence, this is not a problem from "outside" this class.
 
 void EbuildExec::add_handler() {
 GCC_DIAG_OFF(old-style-cast)
@@ -79,8 +80,8 @@ GCC_DIAG_OFF(old-style-cast)
 	got_exit_signal = false;
 #ifdef HAVE_SIGACTION
 	sigaction(SIGHUP, NULLPTR, &handleHUP);
-	sigaction(SIGHUP, NULLPTR, &handleINT);
-	sigaction(SIGHUP, NULLPTR, &handleTERM);
+	sigaction(SIGINT, NULLPTR, &handleINT);
+	sigaction(SIGTERM, NULLPTR, &handleTERM);
 	have_set_signals = true;
 	m_handler.sa_handler = ebuild_sig_handler;
 	m_handler.sa_flags = 0;
@@ -124,7 +125,7 @@ void EbuildExec::remove_handler() {
 		return;
 #ifdef HAVE_SIGACTION
 	sigaction(SIGHUP,  &handleHUP,  NULLPTR);
-	sigaction(SIGINT,  &handleHUP,  NULLPTR);
+	sigaction(SIGINT,  &handleINT,  NULLPTR);
 	sigaction(SIGTERM, &handleTERM, NULLPTR);
 #else
 	signal(SIGHUP,  handleHUP);
@@ -134,24 +135,31 @@ void EbuildExec::remove_handler() {
 	have_set_signals = false;
 }
 
+void EbuildExec::Job::delete_environment() {
+	delete[] c_env;
+	c_env = NULLPTR;
+	delete envstrings;
+	envstrings = NULLPTR;
+}
+
 // You should have called add_handler() in advance
-bool EbuildExec::make_tempfile() {
+bool EbuildExec::make_tempfile(Job *job) {
 	char temp[256];
 	strcpy(temp, "/tmp/ebuild-cache.XXXXXXXX");  // NOLINT(runtime/printf)
 	int fd(mkstemp(temp));
 	if(fd == -1) {
 		return false;
 	}
-	cachefile.assign(temp);
-	cache_defined = true;
+	job->cachefile.assign(temp);
+	job->cache_defined = true;
 	close(fd);
 	return true;
 }
 
-void EbuildExec::delete_cachefile() {
-	if(unlikely(!cache_defined))
+void EbuildExec::delete_cachefile(Job *job) {
+	if(unlikely(!job->cache_defined))
 		return;
-	const char *c(cachefile.c_str());
+	const char *c(job->cachefile.c_str());
 	if(is_pure_file(c)) {
 		if(unlink(c) < 0)
 			base->m_error_callback(eix::format(_("cannot unlink tempfile %s")) % c);
@@ -160,18 +168,48 @@ void EbuildExec::delete_cachefile() {
 	} else {
 		base->m_error_callback(eix::format(_("tempfile %s is not a file")) % c);
 	}
-	remove_handler();
-	cache_defined = false;
-	cachefile.clear();
+	job->cache_defined = false;
+	job->cachefile.clear();
+}
+
+void EbuildExec::release_job(Job *job) {
+	Jobs::iterator it(jobs.begin());
+	for(; likely(it != jobs.end()); ++it) {
+		if(*it == job) {
+			break;
+		}
+	}
+	if(unlikely(it == jobs.end())) {
+		return;
+	}
+	jobs.erase(it);
+	delete_cachefile(job);
+	job->delete_environment();
+	delete job;
+	if(jobs.empty()) {
+		remove_handler();
+	}
+}
+
+void EbuildExec::release_all() {
+	while(!jobs.empty()) {
+		Job *job(jobs.back());
+		if(job->child != -1) {
+			kill(job->child, SIGTERM);
+			int status;
+			wait_child(job, &status);
+		}
+		release_job(job);
+	}
 }
 
 /**
-This is a subfunction of make_cachefile() to ensure that make_cachefile()
+This is a subfunction of start_job() to ensure that start_job()
 has no local variable when vfork() is called.
 **/
-void EbuildExec::calc_environment(const char *name, const string& dir, const Package& package, const Version& version, const string& eapi) {
-	c_env = NULLPTR;
-	envstrings = NULLPTR;
+void EbuildExec::calc_environment(Job *job, const char *name, const string& dir, const Package& package, const Version& version, const string& eapi) {
+	job->c_env = NULLPTR;
+	job->envstrings = NULLPTR;
 	// non-sh: environment is kept except for possibly new PORTDIR_OVERLAY
 	if(!use_ebuild_sh) {  // Shortcut if this is done globally or undesired
 #ifndef HAVE_SETENV
@@ -194,7 +232,7 @@ void EbuildExec::calc_environment(const char *name, const string& dir, const Pac
 	// if(use_ebuild_sh)
 	{  // NOLINT(whitespace/braces)
 		base->env_add_package(&env, package, version, dir, name);
-		env["dbkey"] = cachefile;
+		env["dbkey"] = job->cachefile;
 		const string& portage_rootpath(settings->portage_rootpath);
 		if(likely(!portage_rootpath.empty())) {
 			env["PORTAGE_ROOTPATH"] = portage_rootpath;
@@ -223,97 +261,157 @@ void EbuildExec::calc_environment(const char *name, const string& dir, const Pac
 	env["PORTDIR_OVERLAY"] = (*(base->portagesettings))["PORTDIR_OVERLAY"].c_str();
 
 	// transform env into c_env (pointing to envstrings[i].c_str())
-	c_env = new const char *[env.size() + 1];
+	job->c_env = new const char *[env.size() + 1];
 	WordVec::size_type i(0);
 	if(!env.empty()) {
-		envstrings = new WordVec(env.size());
+		job->envstrings = new WordVec(env.size());
 		for(WordMap::const_iterator it(env.begin());
 			likely(it != env.end()); ++it) {
-			(*envstrings)[i] = ((it->first) + '=' + (it->second));
-			c_env[i] = (*envstrings)[i].c_str();
+			(*(job->envstrings))[i] = ((it->first) + '=' + (it->second));
+			job->c_env[i] = (*(job->envstrings))[i].c_str();
 			++i;
 		}
 	}
-	c_env[i] = NULLPTR;
+	job->c_env[i] = NULLPTR;
 }
 
 static CONSTEXPR int EXECLE_FAILED = 127;
 
-string *EbuildExec::make_cachefile(const char *name, const string& dir, const Package& package, const Version& version, const string& eapi) {
+EbuildExec::Jobs::size_type EbuildExec::max_jobs() const {
+	// "ebuild depend" always writes to the same file
+	if(unlikely(!use_ebuild_sh) || unlikely(settings == NULLPTR)) {
+		return 1;
+	}
+	return settings->max_jobs;
+}
+
+EbuildExec::Job *EbuildExec::start_job(const char *name, const string& dir, const Package& package, const Version& version, const string& eapi) {
 	if(unlikely(!calc_settings())) {
 		return NULLPTR;
 	}
 
 	// Make cachefile and calculate exec_name
 
-	add_handler();
+	if(!have_set_signals) {
+		add_handler();
+	}
+	Job *job(new Job);
+	jobs.push_back(job);
 	if(use_ebuild_sh) {
-		exec_name = settings->exec_ebuild_sh.c_str();
-		if(!make_tempfile()) {
+		job->exec_name = settings->exec_ebuild_sh.c_str();
+		if(!make_tempfile(job)) {
 			base->m_error_callback(_("creation of tempfile failed"));
-			remove_handler();
+			release_job(job);
 			return NULLPTR;
 		}
 	} else {
-		exec_name = "ebuild";
-		cachefile = settings->ebuild_depend_temp;
-		cache_defined = true;
+		job->exec_name = "ebuild";
+		job->cachefile = settings->ebuild_depend_temp;
+		job->cache_defined = true;
 	}
-	calc_environment(name, dir, package, version, eapi);
+	calc_environment(job, name, dir, package, version, eapi);
 #ifndef HAVE_SETENV
-	if((!use_ebuild_sh) && (c_env != NULLPTR)) {
-		exec_name = settings->exec_ebuild.c_str();
+	if((!use_ebuild_sh) && (job->c_env != NULLPTR)) {
+		job->exec_name = settings->exec_ebuild.c_str();
 	}
 #endif
 
 #ifdef HAVE_VFORK
-	pid_t child = vfork();
+	job->child = vfork();
 #else
-	pid_t child = fork();
+	job->child = fork();
 #endif
-	if(unlikely(child == -1)) {
+	if(unlikely(job->child == -1)) {
 		base->m_error_callback(_("forking failed"));
+		release_job(job);
 		return NULLPTR;
 	}
-	if(child == 0) {
+	if(job->child == 0) {
 		if(use_ebuild_sh) {
-			execle(exec_name, exec_name, "depend", static_cast<const char *>(NULLPTR), c_env);
+			execle(job->exec_name, job->exec_name, "depend", static_cast<const char *>(NULLPTR), job->c_env);
 		} else {
 #ifndef HAVE_SETENV
-			if(c_env != NULLPTR)
-				execle(exec_name, exec_name, name, "depend", static_cast<const char *>(NULLPTR), c_env);
+			if(job->c_env != NULLPTR)
+				execle(job->exec_name, job->exec_name, name, "depend", static_cast<const char *>(NULLPTR), job->c_env);
 			else
 #endif
-				execlp(exec_name, exec_name, name, "depend", static_cast<const char *>(NULLPTR));
+				execlp(job->exec_name, job->exec_name, name, "depend", static_cast<const char *>(NULLPTR));
 		}
 		_exit(EXECLE_FAILED);
 	}
-	while(waitpid(child, &exec_status, 0) != child ) { }
-
 	// Free memory needed only for the child process:
-	delete[] c_env;
-	delete envstrings;
+	job->delete_environment();
+	return job;
+}
+
+bool EbuildExec::wait_child(Job *job, int *status) {
+	bool ok(true);
+	while(waitpid(job->child, status, 0) != job->child) {
+		if(errno != EINTR) {
+			job->aborted = true;
+			ok = false;
+			break;
+		}
+	}
+	job->child = -1;
+	return ok;
+}
+
+/**
+A signal arrived: Stop all other jobs and remove all tempfiles
+before reraising the signal
+**/
+void EbuildExec::cleanup_on_signal() {
+	int sig(type_of_exit_signal);
+	for(Jobs::iterator it(jobs.begin()); likely(it != jobs.end()); ++it) {
+		if((*it)->child != -1) {
+			kill((*it)->child, sig);
+		}
+	}
+	// The jobs are released by the caller, also if raise() returns
+	for(Jobs::iterator it(jobs.begin()); likely(it != jobs.end()); ++it) {
+		Job *job(*it);
+		if(job->child != -1) {
+			int status;
+			wait_child(job, &status);
+		}
+		job->aborted = true;
+		delete_cachefile(job);
+	}
+	got_exit_signal = false;
+	remove_handler();
+	raise(sig);
+}
+
+const string *EbuildExec::wait_job(Job *job) {
+	if(unlikely(job->aborted)) {
+		return NULLPTR;
+	}
+	int exec_status;
+	bool waited(wait_child(job, &exec_status));
 
 GCC_DIAG_OFF(old-style-cast)
 	// Only now we check for the child exit status or signals:
 	if(unlikely(got_exit_signal)) {
 		base->m_error_callback(eix::format(_("got signal %s")) % type_of_exit_signal);
+	} else if(unlikely(!waited)) {
+		base->m_error_callback(eix::format(_("cannot wait for %s: %s")) % job->exec_name % strerror(errno));
+		return NULLPTR;
 	} else if(unlikely(WIFSIGNALED(exec_status))) {
 		got_exit_signal = true;
 		type_of_exit_signal = WTERMSIG(exec_status);
 		base->m_error_callback(eix::format(_("ebuild got signal %s")) % type_of_exit_signal);
 	}
 	if(unlikely(got_exit_signal)) {
-		delete_cachefile();
-		raise(type_of_exit_signal);
+		cleanup_on_signal();
 		return NULLPTR;
 	}
 	if(likely(WIFEXITED(exec_status))) {
 		if(likely(!(WEXITSTATUS(exec_status)))) {  // the only good case:
-			return &cachefile;
+			return &(job->cachefile);
 		}
 		if((WEXITSTATUS(exec_status)) == EXECLE_FAILED) {
-			base->m_error_callback(eix::format(_("could not start %s")) % exec_name);
+			base->m_error_callback(eix::format(_("could not start %s")) % job->exec_name);
 		} else {
 			base->m_error_callback(eix::format(_("ebuild failed with status %s")) % WEXITSTATUS(exec_status));
 		}
@@ -321,7 +419,6 @@ GCC_DIAG_OFF(old-style-cast)
 		base->m_error_callback(_("child aborted in a strange way"));
 	}
 GCC_DIAG_ON(old-style-cast)
-	delete_cachefile();
 	return NULLPTR;
 }
 
@@ -378,6 +475,18 @@ void EbuildExecSettings::init() {
 	exec_ebuild_sh = "ebuild.sh";
 	portage_rootpath = eix["PORTAGE_ROOTPATH"];
 	read_portage_paths = false;
+	max_jobs = eix.getInteger("EBUILD_JOBS");
+#if defined(HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+	if(max_jobs == 0) {
+		long cpus(sysconf(_SC_NPROCESSORS_ONLN));
+		if(cpus > 0) {
+			max_jobs = static_cast<EbuildExec::Jobs::size_type>(cpus);
+		}
+	}
+#endif
+	if(max_jobs == 0) {
+		max_jobs = 1;
+	}
 }
 
 bool EbuildExecSettings::init_ebuild_sh(const EbuildExec *e) {
@@ -10,10 +10,14 @@
 #ifndef SRC_CACHE_COMMON_EBUILD_EXEC_H_
 #define SRC_CACHE_COMMON_EBUILD_EXEC_H_ 1
 
+#include <sys/types.h>
+
 #include <csignal>
 
 #include <string>
+#include <vector>
 
+#include "eixTk/null.h"
 #include "eixTk/stringtypes.h"
 
 class EbuildExecSettings;
@@ -23,16 +27,53 @@ class Version;
 
 void ebuild_sig_handler(int sig) ATTRIBUTE_SIGNAL;
 
+/**
+Run a pool of up to max_jobs() concurrent "ebuild depend" processes
+**/
 class EbuildExec {
 		friend void ebuild_sig_handler(int sig) ATTRIBUTE_SIGNAL;
 		friend class EbuildExecSettings;
 
+	public:
+		/**
+		One ebuild process with its own tempfile and environment
+		**/
+		class Job {
+				friend class EbuildExec;
+
+			private:
+				std::string cachefile;
+				bool cache_defined;
+				/**
+				The process could not be waited for or was stopped by
+				cleanup_on_signal(): Its cachefile must not be used
+				**/
+				bool aborted;
+				pid_t child;
+				/**
+				local data for start_job which should be saved for vfork
+				**/
+				const char *exec_name;
+				const char **c_env;
+				WordVec *envstrings;
+
+				Job() :
+					cache_defined(false),
+					aborted(false),
+					child(-1),
+					c_env(NULLPTR),
+					envstrings(NULLPTR) {
+				}
+
+				void delete_environment();
+		};
+		typedef std::vector<Job *> Jobs;
+
 	private:
 		const BasicCache *base;
 		static EbuildExec *handler_arg;
-		volatile bool have_set_signals, got_exit_signal, cache_defined;
+		volatile bool have_set_signals, got_exit_signal;
 		volatile int type_of_exit_signal;
-		std::string cachefile;
 #ifdef HAVE_SIGACTION
 		struct sigaction handleTERM, handleINT, handleHUP, m_handler;
 #else
@@ -41,36 +82,65 @@ class EbuildExec {
 		/* volatile */ signal_handler *handleTERM, *handleINT, *handleHUP;
 #endif
 		bool use_ebuild_sh;
-		/**
-		local data for make_cachefile which should be saved for vfork
-		**/
-		const char *exec_name;
-		const char **c_env;
-		int exec_status;
-		WordVec *envstrings;
-		void calc_environment(const char *name, const std::string& dir, const Package& package, const Version& version, const std::string& eapi) ATTRIBUTE_NONNULL_;
+		Jobs jobs;
+		void calc_environment(Job *job, const char *name, const std::string& dir, const Package& package, const Version& version, const std::string& eapi) ATTRIBUTE_NONNULL_;
 
 		static EbuildExecSettings *settings;
 
 		void add_handler();
 		void remove_handler();
-		bool make_tempfile();
+		bool make_tempfile(Job *job) ATTRIBUTE_NONNULL_;
+		void delete_cachefile(Job *job) ATTRIBUTE_NONNULL_;
+		/**
+		@return false (and mark job as aborted) if waiting failed
+		**/
+		bool wait_child(Job *job, int *status) ATTRIBUTE_NONNULL_;
+		void cleanup_on_signal();
 		bool portageq(std::string *result, const char *var) const;
 		bool calc_settings();
 
 	public:
-		std::string *make_cachefile(const char *name, const std::string& dir, const Package& package, const Version& version, const std::string& eapi) ATTRIBUTE_NONNULL_;
-		void delete_cachefile();
+		/**
+		Start the ebuild process for version in the background.
+		If full() is true, a job must be released first.
+		@return NULLPTR on failure (an error is already reported)
+		**/
+		Job *start_job(const char *name, const std::string& dir, const Package& package, const Version& version, const std::string& eapi) ATTRIBUTE_NONNULL_;
+
+		/**
+		Wait until job has finished.
+		@return the name of the generated cachefile or NULLPTR on failure.
+		In any case, release_job() must be called afterwards.
+		**/
+		const std::string *wait_job(Job *job) ATTRIBUTE_NONNULL_;
+
+		/**
+		Delete the cachefile of a finished job and release its slot
+		**/
+		void release_job(Job *job) ATTRIBUTE_NONNULL_;
+
+		/**
+		Kill all outstanding jobs and remove their cachefiles
+		**/
+		void release_all();
+
+		/**
+		@return the maximal number of concurrent jobs
+		**/
+		Jobs::size_type max_jobs() const ATTRIBUTE_PURE;
+
+		bool full() const {
+			return (jobs.size() >= max_jobs());
+		}
 
 		EbuildExec(bool will_use_sh, const BasicCache *b) ATTRIBUTE_NONNULL_ :
 			base(b),
 			have_set_signals(false),
-			cache_defined(false),
 			use_ebuild_sh(will_use_sh) {
 		}
 
 		~EbuildExec() {
-			delete_cachefile();
+			release_all();
 		}
 
 		bool use_sh() const {
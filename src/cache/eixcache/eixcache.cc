@@ -26,6 +26,7 @@
 #include "eixTk/stringutils.h"
 #include "portage/basicversion.h"
 #include "portage/conf/portagesettings.h"
+#include "portage/keywords.h"
 #include "portage/package.h"
 #include "portage/packagetree.h"
 #include "portage/version.h"
@@ -163,29 +164,47 @@ bool EixCache::get_destcat(PackageTree *packagetree, const char *cat_name, Categ
 	return false;
 }
 
-void EixCache::get_package(Package *p) {
+/**
+If transplant is true, the versions are moved out of p instead of copied;
+this requires that p was read without calculating masks.
+**/
+void EixCache::get_package(Package *p, bool transplant) {
 	if(dest_cat == NULLPTR) {
 		return;
 	}
 	bool have_onetime_info(false), have_pkg(false);
 	Package *pkg(NULLPTR);
-	for(Package::iterator it(p->begin()); likely(it != p->end()); ++it) {
+	for(Package::iterator it(p->begin()); likely(it != p->end()); ) {
 		if(m_only_overlay) {
-			if(likely(it->overlay_key != m_get_overlay))
+			if(likely(it->overlay_key != m_get_overlay)) {
+				++it;
 				continue;
+			}
+		}
+		Version *version;
+		if(transplant) {
+			version = *it;
+			it = p->erase(it);
+			// Forget what refers to the source database:
+			version->maskflags.set(MaskFlags::MASK_NONE);
+			version->reponame.clear();
+			version->priority = 0;
+			version->overlay_key = m_overlay_key;
+		} else {
+			version = new Version;
+			*static_cast<BasicVersion *>(version) = *static_cast<BasicVersion *>(*it);
+			version->overlay_key = m_overlay_key;
+			version->set_full_keywords(it->get_full_keywords());
+			version->slotname = it->slotname;
+			version->subslotname = it->subslotname;
+			version->restrictFlags = it->restrictFlags;
+			version->propertiesFlags = it->propertiesFlags;
+			version->iuse = it->iuse;
+			version->required_use = it->required_use;
+			version->eapi = it->eapi;
+			version->depend = it->depend;
+			++it;
 		}
-		Version *version(new Version);
-		*static_cast<BasicVersion *>(version) = *static_cast<BasicVersion *>(*it);
-		version->overlay_key = m_overlay_key;
-		version->set_full_keywords(it->get_full_keywords());
-		version->slotname = it->slotname;
-		version->subslotname = it->subslotname;
-		version->restrictFlags = it->restrictFlags;
-		version->propertiesFlags = it->propertiesFlags;
-		version->iuse = it->iuse;
-		version->required_use = it->required_use;
-		version->eapi = it->eapi;
-		version->depend = it->depend;
 		if(pkg == NULLPTR) {
 			pkg = dest_cat->findPackage(p->name);
 			if(pkg != NULLPTR) {
@@ -260,6 +279,7 @@ bool EixCache::readCategories(PackageTree *packagetree, const char *cat_name, Ca
 	}
 
 	PackageReader reader(&db, header);
+	reader.skip_masks();
 	for(; reader.next(); reader.skip()) {
 		if(unlikely(!reader.read(PackageReader::NAME))) {
 			break;
@@ -280,9 +300,11 @@ bool EixCache::readCategories(PackageTree *packagetree, const char *cat_name, Ca
 			break;
 		}
 		p = reader.get();
+		// The last slave may take the versions; the others have to copy
 		for(Slaves::const_iterator sl(slaves.begin());
-			unlikely(sl != slaves.end()); ++sl) {
-			(*sl)->get_package(p);
+			unlikely(sl != slaves.end()); ) {
+			EixCache *curr(*sl);
+			curr->get_package(p, (++sl == slaves.end()));
 		}
 	}
 	const char *err_cstr(reader.get_errtext());
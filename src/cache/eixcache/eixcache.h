@@ -37,7 +37,7 @@ class EixCache : public BasicCache {
 		void thiserror(const std::string& msg);
 		bool get_overlaydat(const DBHeader& header);
 		bool get_destcat(PackageTree *packagetree, const char *cat_name, Category *category, const std::string& pcat);
-		void get_package(Package *p) ATTRIBUTE_NONNULL_;
+		void get_package(Package *p, bool transplant) ATTRIBUTE_NONNULL_;
 
 	public:
 		~EixCache();
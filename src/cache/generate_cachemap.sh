@@ -12,8 +12,8 @@ to_classname() {
 
 cache_plain='sqlite'
 cache_stars=$cache_plain
-cache_vary='eix metadata'
-cache_includes="parse eixcache metadata $cache_plain"
+cache_vary='eix metadata tar'
+cache_includes="parse eixcache metadata tar $cache_plain"
 
 cat<<END
 // AUTOGENERATED BY MAKE .. DO NOT EDIT!
@@ -127,7 +127,7 @@ ParseCache::~ParseCache() {
 		delete *it;
 	}
 	if(ebuild_exec != NULLPTR) {
-		ebuild_exec->delete_cachefile();
+		ebuild_exec->release_all();
 		delete ebuild_exec;
 		ebuild_exec = NULLPTR;
 	}
@@ -185,9 +185,14 @@ void ParseCache::set_checking(string *str, const char *item, const VarsReader& e
 	}
 }
 
-void ParseCache::parse_exec(const char *fullpath, const string& dirpath, bool read_onetime_info, bool *have_onetime_info, Package *pkg, Version *version) {
+void ParseCache::parse_exec(const char *fullpath, const string& dirpath, bool read_onetime_info, PendingPackage *package, Version *version) {
+	Package *pkg(package->pkg);
 	version->overlay_key = m_overlay_key;
-	string keywords, restr, props, iuse, required_use, slot, eapi;
+	Pending p;
+	p.package = package;
+	p.version = version;
+	p.job = NULLPTR;
+	p.have_data = true;
 	bool ok(try_parse);
 	if(ok || ebuild_sh) {
 		VarsReader::Flags flags(VarsReader::NONE);
@@ -209,17 +214,17 @@ void ParseCache::parse_exec(const char *fullpath, const string& dirpath, bool re
 		}
 
 		if(ok) {
-			set_checking(&keywords, "KEYWORDS", ebuild, &ok);
-			set_checking(&slot, "SLOT", ebuild, &ok);
+			set_checking(&(p.keywords), "KEYWORDS", ebuild, &ok);
+			set_checking(&(p.slot), "SLOT", ebuild, &ok);
 			// Empty SLOT is not ok:
-			if(ok && (ebuild_exec != NULLPTR) && slot.empty()) {
+			if(ok && (ebuild_exec != NULLPTR) && p.slot.empty()) {
 				ok = false;
 			}
-			set_checking(&restr, "RESTRICT", ebuild);
-			set_checking(&props, "PROPERTIES", ebuild);
-			set_checking(&iuse, "IUSE", ebuild, &ok);
+			set_checking(&(p.restr), "RESTRICT", ebuild);
+			set_checking(&(p.props), "PROPERTIES", ebuild);
+			set_checking(&(p.iuse), "IUSE", ebuild, &ok);
 			if(Version::use_required_use) {
-				set_checking(&required_use, "REQUIRED_USE", ebuild);
+				set_checking(&(p.required_use), "REQUIRED_USE", ebuild);
 			}
 			if(Depend::use_depend) {
 				string depend, rdepend, pdepend, hdepend;
@@ -233,14 +238,15 @@ void ParseCache::parse_exec(const char *fullpath, const string& dirpath, bool re
 				set_checking(&(pkg->homepage), "HOMEPAGE",    ebuild, &ok);
 				set_checking(&(pkg->licenses), "LICENSE",     ebuild, &ok);
 				set_checking(&(pkg->desc),     "DESCRIPTION", ebuild, &ok);
-				*have_onetime_info = true;
+				package->have_onetime_info = true;
+				++(package->onetime_generation);
 			}
 		}
 		const string *s(ebuild.find("EAPI"));
 		if(likely(s != NULLPTR)) {
-			eapi = *s;
+			p.eapi = *s;
 		} else {
-			eapi.assign("0");
+			p.eapi.assign("0");
 		}
 	}
 	if(verbose) {
@@ -255,36 +261,107 @@ void ParseCache::parse_exec(const char *fullpath, const string& dirpath, bool re
 			used_type);
 	}
 	if(!ok) {
-		string *cachefile(ebuild_exec->make_cachefile(fullpath, dirpath, *pkg, *version, eapi));
+		while(ebuild_exec->full()) {
+			finish_pending();
+		}
+		p.job = ebuild_exec->start_job(fullpath, dirpath, *pkg, *version, p.eapi);
+		if(likely(p.job != NULLPTR)) {
+			p.fullpath.assign(fullpath);
+			p.onetime_generation = package->onetime_generation;
+			if(read_onetime_info) {
+				package->have_onetime_info = true;
+			}
+		} else {
+			m_error_callback(eix::format(_("cannot properly execute %s")) % fullpath);
+		}
+	}
+	add_pending(&p);
+}
+
+/**
+Finish p immediately if nothing is queued; otherwise queue a copy of it
+**/
+void ParseCache::add_pending(Pending *p) {
+	if(pending.empty() && (p->job == NULLPTR)) {
+		if(p->version != NULLPTR) {
+			finish_version(p);
+		} else {
+			finish_package(p->package);
+		}
+		return;
+	}
+	pending.push_back(*p);
+}
+
+void ParseCache::finish_version(Pending *p) {
+	Version *version(p->version);
+	Package *pkg(p->package->pkg);
+	if(p->job != NULLPTR) {
+		const string *cachefile(ebuild_exec->wait_job(p->job));
 		if(likely(cachefile != NULLPTR)) {
 			FlatReader reader(this);
-			reader.get_keywords_slot_iuse_restrict(*cachefile, &eapi, &keywords, &slot, &iuse, &required_use, &restr, &props, &(version->depend));
-			reader.read_file(cachefile->c_str(), pkg);
-			ebuild_exec->delete_cachefile();
+			reader.get_keywords_slot_iuse_restrict(*cachefile, &(p->eapi), &(p->keywords), &(p->slot), &(p->iuse), &(p->required_use), &(p->restr), &(p->props), &(version->depend));
+			// Do not override data set by a version parsed later
+			if(p->onetime_generation == p->package->onetime_generation) {
+				reader.read_file(cachefile->c_str(), pkg);
+			}
 		} else {
-			m_error_callback(eix::format(_("cannot properly execute %s")) % fullpath);
+			m_error_callback(eix::format(_("cannot properly execute %s")) % p->fullpath);
 		}
+		ebuild_exec->release_job(p->job);
+		p->job = NULLPTR;
 	}
-	version->eapi.assign(eapi);
-	version->set_slotname(slot);
-	version->set_full_keywords(keywords);
-	version->set_restrict(restr);
-	version->set_properties(props);
-	version->set_iuse(iuse);
-	version->set_required_use(required_use);
-	pkg->addVersionFinalize(version);
+	if(p->have_data) {
+		version->eapi.assign(p->eapi);
+		version->set_slotname(p->slot);
+		version->set_full_keywords(p->keywords);
+		version->set_restrict(p->restr);
+		version->set_properties(p->props);
+		version->set_iuse(p->iuse);
+		version->set_required_use(p->required_use);
+	}
+	pkg->addVersion(version);
 }
 
-void ParseCache::readPackage(Category *cat, const string& pkg_name, const string& directory_path, const WordVec& files) {
-	bool have_onetime_info, have_pkg;
+void ParseCache::finish_package(PendingPackage *package) {
+	if(package->have_onetime_info) {
+		if(!package->have_pkg) {
+			package->cat->addPackage(package->pkg);
+		}
+	} else {
+		delete package->pkg;
+	}
+	delete package;
+}
+
+/**
+Finish the oldest queued entry, waiting for its ebuild job if necessary
+**/
+void ParseCache::finish_pending() {
+	Pending& p(pending.front());
+	if(p.version != NULLPTR) {
+		finish_version(&p);
+	} else {
+		finish_package(p.package);
+	}
+	pending.pop_front();
+}
 
+void ParseCache::readPackage(Category *cat, const string& pkg_name, const string& directory_path, const WordVec& files) {
+	PendingPackage *package(new PendingPackage);
+	package->cat = cat;
+	package->onetime_generation = 0;
 	Package *pkg(cat->findPackage(pkg_name));
 	if(pkg != NULLPTR) {
-		have_onetime_info = have_pkg = true;
+		package->have_onetime_info = package->have_pkg = true;
 	} else {
-		have_onetime_info = have_pkg = false;
+		package->have_onetime_info = package->have_pkg = false;
 		pkg = new Package(m_catname, pkg_name);
 	}
+	package->pkg = pkg;
+	// Versions are added to pkg only when finished, so we keep track
+	// of the latest one here
+	const Version *latest(pkg->empty() ? NULLPTR : pkg->latest());
 
 	for(WordVec::const_iterator fileit(files.begin());
 		likely(fileit != files.end()); ++fileit) {
@@ -301,7 +378,7 @@ void ParseCache::readPackage(Category *cat, const string& pkg_name, const string
 			continue;
 		}
 
-		/* Make version and add it to package. */
+		/* Make version; it is added to package when finished */
 		Version *version(new Version);
 		string errtext;
 		BasicVersion::ParseResult r(version->parseVersion(ver, &errtext));
@@ -312,16 +389,15 @@ void ParseCache::readPackage(Category *cat, const string& pkg_name, const string
 			delete version;
 			continue;
 		}
-		pkg->addVersionStart(version);
 
 		string full_path(directory_path + '/' + (*fileit));
 
 		/* For the latest version read/change corresponding data */
 		bool read_onetime_info(true);
-		if(have_onetime_info) {
-			if(*(pkg->latest()) != *version) {
-				read_onetime_info = false;
-			}
+		if((latest == NULLPTR) || !(*version < *latest)) {
+			latest = version;
+		} else if(package->have_onetime_info) {
+			read_onetime_info = false;
 		}
 
 		bool know_ebuild_time(false), have_ebuild_time(false);
@@ -350,7 +426,7 @@ void ParseCache::readPackage(Category *cat, const string& pkg_name, const string
 			}
 		}
 		if(it == further.end()) {
-			parse_exec(full_path.c_str(), directory_path, read_onetime_info, &have_onetime_info, pkg, version);
+			parse_exec(full_path.c_str(), directory_path, read_onetime_info, package, version);
 		} else {
 			if(verbose) {
 				m_error_callback(eix::format("%s/%s-%s: %s") %
@@ -360,20 +436,26 @@ void ParseCache::readPackage(Category *cat, const string& pkg_name, const string
 			(*it)->get_version_info(pkg_name.c_str(), ver, version);
 			if(read_onetime_info) {
 				(*it)->get_common_info(pkg_name.c_str(), ver, pkg);
-				have_onetime_info = true;
+				package->have_onetime_info = true;
+				++(package->onetime_generation);
 			}
+			Pending p;
+			p.package = package;
+			p.version = version;
+			p.job = NULLPTR;
+			p.have_data = false;
+			add_pending(&p);
 		}
 
 		free(ver);
 	}
 
-	if(have_onetime_info) {
-		if(!have_pkg) {
-			cat->addPackage(pkg);
-		}
-	} else {
-		delete pkg;
-	}
+	Pending p;
+	p.package = package;
+	p.version = NULLPTR;
+	p.job = NULLPTR;
+	p.have_data = false;
+	add_pending(&p);
 }
 
 bool ParseCache::readCategoryPrepare(const char *cat_name) {
@@ -407,5 +489,8 @@ bool ParseCache::readCategory(Category *cat) {
 			readPackage(cat, *pit, pkg_path, files);
 		}
 	}
+	while(!pending.empty()) {
+		finish_pending();
+	}
 	return true;
 }
@@ -10,16 +10,18 @@
 #ifndef SRC_CACHE_PARSE_PARSE_H_
 #define SRC_CACHE_PARSE_PARSE_H_ 1
 
+#include <list>
 #include <string>
 #include <vector>
 
 #include "cache/base.h"
+#include "cache/common/ebuild_exec.h"
 #include "eixTk/null.h"
 #include "eixTk/stringtypes.h"
 #include "portage/extendedversion.h"
 
 class Category;
-class EbuildExec;
+class Package;
 class VarsReader;
 class Version;
 
@@ -40,8 +42,47 @@ class ParseCache : public BasicCache {
 			set_checking(str, item, ebuild, NULLPTR);
 		}
 
-		void parse_exec(const char *fullpath, const std::string& dirpath, bool read_onetime_info, bool *have_onetime_info, Package *pkg, Version *version) ATTRIBUTE_NONNULL_;
+		/**
+		The package currently read; it is shared with all its Pending versions
+		**/
+		class PendingPackage {
+			public:
+				Category *cat;
+				Package *pkg;
+				bool have_pkg, have_onetime_info;
+				/**
+				Incremented whenever homepage/licenses/description are set
+				immediately; a finished ebuild job sets them only if this
+				has not happened since the job was started
+				**/
+				unsigned int onetime_generation;
+		};
+
+		/**
+		Versions whose data depends on an ebuild job are completed only
+		after the job has finished. All later versions are queued as well,
+		so that the package is modified in the original order.
+		An entry with version NULLPTR finalizes the package.
+		**/
+		class Pending {
+			public:
+				PendingPackage *package;
+				Version *version;
+				EbuildExec::Job *job;
+				std::string fullpath;
+				std::string eapi, keywords, slot, iuse, required_use, restr, props;
+				bool have_data;
+				unsigned int onetime_generation;
+		};
+		typedef std::list<Pending> PendingList;
+		PendingList pending;
+
+		void parse_exec(const char *fullpath, const std::string& dirpath, bool read_onetime_info, PendingPackage *package, Version *version) ATTRIBUTE_NONNULL_;
 		void readPackage(Category *cat, const std::string& pkg_name, const std::string& directory_path, const WordVec& files) ATTRIBUTE_NONNULL_;
+		void add_pending(Pending *p) ATTRIBUTE_NONNULL_;
+		void finish_version(Pending *p) ATTRIBUTE_NONNULL_;
+		void finish_package(PendingPackage *package) ATTRIBUTE_NONNULL_;
+		void finish_pending();
 
 	public:
 		ParseCache() : BasicCache(), verbose(false), ebuild_exec(NULLPTR) {
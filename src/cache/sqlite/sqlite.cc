@@ -15,12 +15,14 @@
 #include <sqlite3.h>
 
 #include <cstdlib>
+#include <cstring>
 
 #ifdef SQLITE_ONLY_DEBUG
 #include <iostream>
 #endif
 #include <map>
 #include <string>
+#include <vector>
 
 #include "cache/sqlite/sqlite.h"
 #include "eixTk/formated.h"
@@ -28,7 +30,6 @@
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
 #include "eixTk/stringutils.h"
-#include "eixTk/unused.h"
 #include "portage/basicversion.h"
 #include "portage/depend.h"
 #include "portage/package.h"
@@ -47,31 +48,12 @@ using std::cout;
 
 
 
-/**
-All stuff related to our sqlite_callback()
-Essentially, this is just a C-wrapper to get the implicit this argument in
-*/
-SqliteCache *SqliteCache::callback_arg;
-
 inline static const char *welldefine(const char *s) ATTRIBUTE_CONST;
 
 inline static const char *welldefine(const char *s) {
 	return ((s != NULLPTR) ? s : "");
 }
 
-int sqlite_callback(void *NotUsed ATTRIBUTE_UNUSED, int argc, char **argv, char **azColName) {
-	UNUSED(NotUsed);
-#ifdef SQLITE_ONLY_DEBUG
-	for(int i(0); likely(i < argc); ++i) {
-		cout << eix::format("%s: %s = %s\n")
-			% i % azColName[i] % welldefine(argv[i]);
-	}
-#else
-	SqliteCache::callback_arg->sqlite_callback_cpp(argc, const_cast<const char **>(argv), const_cast<const char **>(azColName));
-#endif
-	return 0;
-}
-
 /**
 The following is all related to get the proper index for the lookups.
 The main idea is the following: We let
@@ -82,8 +64,8 @@ for all mandatory data is stored in SqliteCache::maxindex.
 
 The class TrueIndex and the static (and only) instance *true_index
 is used to calculate the initial value of trueindex/maxindex
-at the first database access by first filling it with default parameters
-and - for the case that appropriate data is stored in azColName -
+once for each prepared statement by first filling it with default parameters
+and - for the case that appropriate data is stored in the column names -
 modifying this correspondingly: This has the advantage that if some
 portage versions use different names, we still have (hopefully correct)
 default values.
@@ -178,66 +160,99 @@ class TrueIndex : public TrueIndexMapper {
 			return max_index;
 		}
 
-		static const char *c_str(const char **argv, SqliteCache::TrueIndexMap *trueindex, const TrueIndexRes i) ATTRIBUTE_NONNULL((2)) {
-			int t((*trueindex)[i]);
+		static const char *c_str(sqlite3_stmt *statement, const SqliteCache::TrueIndexMap& trueindex, const TrueIndexRes i) ATTRIBUTE_NONNULL_ {
+			int t(trueindex[i]);
 			if(t < 0) {
 				return "";
 			}
-			return welldefine(argv[t]);
+			return welldefine(reinterpret_cast<const char *>(sqlite3_column_text(statement, t)));
 		}
 };
 
 TrueIndex *SqliteCache::true_index = NULLPTR;
 
-void SqliteCache::sqlite_callback_cpp(int argc, const char **argv, const char **azColName) {
-	// If an earlier error occurred, we ignore later calls:
-	if(unlikely(sqlite_callback_error)) {
-		return;
+SqliteCache::~SqliteCache() {
+	close_db();
+}
+
+bool SqliteCache::open_db() {
+	if(likely(db != NULLPTR)) {
+		return true;
+	}
+	if(unlikely(db_failed)) {
+		return false;
+	}
+	string sqlitefile(m_prefix + PORTAGE_CACHE_PATH + m_scheme);
+	// Cut all trailing '/' and append ".sqlite" to the name
+	string::size_type pos(sqlitefile.find_last_not_of('/'));
+	if(unlikely(pos == string::npos)) {
+		db_failed = true;
+		m_error_callback(_("database path incorrect"));
+		return false;
+	}
+	sqlitefile.resize(pos + 1);
+	sqlitefile.append(".sqlite");
+
+	if(sqlite3_open_v2(sqlitefile.c_str(), &db, SQLITE_OPEN_READONLY, NULLPTR) != SQLITE_OK) {
+		sqlite3_close(db);
+		db = NULLPTR;
+		db_failed = true;
+		m_error_callback(eix::format(_("cannot open cache file %s")) % sqlitefile);
+		return false;
 	}
+	return true;
+}
 
-	if(maxindex == 0) {
-		if(unlikely(true_index == NULLPTR)) {
-			true_index = new TrueIndex;
-		}
-		maxindex = true_index->calc(argc, azColName, &trueindex);
+void SqliteCache::close_db() {
+	finalize_stmt();
+	if(db != NULLPTR) {
+		sqlite3_close(db);
+		db = NULLPTR;
+	}
+}
+
+void SqliteCache::finalize_stmt() {
+	if(stmt != NULLPTR) {
+		sqlite3_finalize(stmt);
+		stmt = NULLPTR;
 	}
+}
+
+/**
+@return the prepared statement or NULLPTR (without error message)
+**/
+sqlite3_stmt *SqliteCache::prepare(const char *query) {
+	sqlite3_stmt *statement(NULLPTR);
+	if(sqlite3_prepare_v2(db, query, -1, &statement, NULLPTR) != SQLITE_OK) {
+		sqlite3_finalize(statement);
+		return NULLPTR;
+	}
+	return statement;
+}
 
+bool SqliteCache::calc_trueindex(sqlite3_stmt *statement) {
+	if(unlikely(true_index == NULLPTR)) {
+		true_index = new TrueIndex;
+	}
+	int argc(sqlite3_column_count(statement));
+	std::vector<const char *> names(static_cast<std::vector<const char *>::size_type>(argc) + 1);
+	for(int i(0); likely(i < argc); ++i) {
+		names[i] = welldefine(sqlite3_column_name(statement, i));
+	}
+	maxindex = true_index->calc(argc, &(names[0]), &trueindex);
 	if(argc <= trueindex[TrueIndex::NAME]) {
-		sqlite_callback_error = true;
 		m_error_callback(_("sqlite dataset does not contain a package name"));
-		return;
+		return false;
 	}
-	string catarg(TrueIndex::c_str(argv, &trueindex, TrueIndex::NAME));
 	if(argc <= maxindex) {
-		sqlite_callback_error = true;
-		m_error_callback(eix::format(_("sqlite dataset for %s is too small")) % catarg);
-		return;
-	}
-	string::size_type pos(catarg.find('/'));
-	if(pos == string::npos) {
-		sqlite_callback_error = true;
-		m_error_callback(eix::format(_("\"%s\" not of the form package/category-version")) % catarg);
-		return;
-	}
-	string name_ver(catarg, pos + 1);
-	catarg.resize(pos);
-	// Does the catarg match category?
-	// Currently, we do not add non-matching categories with this method.
-	Category *dest_cat;
-	if(unlikely(packagetree == NULLPTR)) {
-		if(cat_name != catarg) {
-			return;
-		}
-		dest_cat = category;
-	} else if(never_add_categories) {
-		dest_cat = packagetree->find(catarg);
-		if(unlikely(dest_cat == NULLPTR)) {
-			return;
-		}
-	} else {
-		dest_cat = &((*packagetree)[catarg]);
+		m_error_callback(_("sqlite dataset is too small"));
+		return false;
 	}
-	char **aux(ExplodeAtom::split(name_ver.c_str()));
+	return true;
+}
+
+void SqliteCache::add_row(sqlite3_stmt *statement, const char *name_ver, const string& cat_name, Category *dest_cat) {
+	char **aux(ExplodeAtom::split(name_ver));
 	if(unlikely(aux == NULLPTR)) {
 		m_error_callback(eix::format(_("cannot split \"%s\" into package and version")) % name_ver);
 		return;
@@ -247,7 +262,7 @@ void SqliteCache::sqlite_callback_cpp(int argc, const char **argv, const char **
 
 	/* If none was found create one */
 	if(pkg == NULLPTR) {
-		pkg = dest_cat->addPackage(catarg, aux[0]);
+		pkg = dest_cat->addPackage(cat_name, aux[0]);
 	}
 
 	/* Create a new version and add it to package */
@@ -261,26 +276,26 @@ void SqliteCache::sqlite_callback_cpp(int argc, const char **argv, const char **
 		delete version;
 	} else {
 		// reading slots and stability
-		version->set_slotname(TrueIndex::c_str(argv, &trueindex, TrueIndex::SLOT));
-		version->set_restrict(TrueIndex::c_str(argv, &trueindex, TrueIndex::RESTRICT));
-		version->set_properties(TrueIndex::c_str(argv, &trueindex, TrueIndex::PROPERTIES));
-		version->set_full_keywords(TrueIndex::c_str(argv, &trueindex, TrueIndex::KEYWORDS));
-		version->set_iuse(TrueIndex::c_str(argv, &trueindex, TrueIndex::IUSE));
-		version->set_required_use(TrueIndex::c_str(argv, &trueindex, TrueIndex::REQUIRED_USE));
-		version->eapi.assign(TrueIndex::c_str(argv, &trueindex, TrueIndex::EAPI));
-		version->depend.set(TrueIndex::c_str(argv, &trueindex, TrueIndex::DEPEND),
-			TrueIndex::c_str(argv, &trueindex, TrueIndex::RDEPEND),
-			TrueIndex::c_str(argv, &trueindex, TrueIndex::PDEPEND),
-			TrueIndex::c_str(argv, &trueindex, TrueIndex::HDEPEND),
+		version->set_slotname(TrueIndex::c_str(statement, trueindex, TrueIndex::SLOT));
+		version->set_restrict(TrueIndex::c_str(statement, trueindex, TrueIndex::RESTRICT));
+		version->set_properties(TrueIndex::c_str(statement, trueindex, TrueIndex::PROPERTIES));
+		version->set_full_keywords(TrueIndex::c_str(statement, trueindex, TrueIndex::KEYWORDS));
+		version->set_iuse(TrueIndex::c_str(statement, trueindex, TrueIndex::IUSE));
+		version->set_required_use(TrueIndex::c_str(statement, trueindex, TrueIndex::REQUIRED_USE));
+		version->eapi.assign(TrueIndex::c_str(statement, trueindex, TrueIndex::EAPI));
+		version->depend.set(TrueIndex::c_str(statement, trueindex, TrueIndex::DEPEND),
+			TrueIndex::c_str(statement, trueindex, TrueIndex::RDEPEND),
+			TrueIndex::c_str(statement, trueindex, TrueIndex::PDEPEND),
+			TrueIndex::c_str(statement, trueindex, TrueIndex::HDEPEND),
 			false);
 		version->overlay_key = m_overlay_key;
 		pkg->addVersion(version);
 
 		/* For the newest version, add all remaining data */
 		if(*(pkg->latest()) == *version) {
-			pkg->homepage = TrueIndex::c_str(argv, &trueindex, TrueIndex::HOMEPAGE);
-			pkg->licenses = TrueIndex::c_str(argv, &trueindex, TrueIndex::LICENSE);
-			pkg->desc     = TrueIndex::c_str(argv, &trueindex, TrueIndex::DESCRIPTION);
+			pkg->homepage = TrueIndex::c_str(statement, trueindex, TrueIndex::HOMEPAGE);
+			pkg->licenses = TrueIndex::c_str(statement, trueindex, TrueIndex::LICENSE);
+			pkg->desc     = TrueIndex::c_str(statement, trueindex, TrueIndex::DESCRIPTION);
 		}
 	}
 	/* Free old split */
@@ -288,38 +303,107 @@ void SqliteCache::sqlite_callback_cpp(int argc, const char **argv, const char **
 	free(aux[1]);
 }
 
-bool SqliteCache::readCategories(PackageTree *pkgtree, const char *catname, Category *cat) {
-	char *errormessage(NULLPTR);
-	string sqlitefile(m_prefix + PORTAGE_CACHE_PATH + m_scheme);
-	// Cut all trailing '/' and append ".sqlite" to the name
-	string::size_type pos(sqlitefile.find_last_not_of('/'));
-	if(unlikely(pos == string::npos)) {
-		m_error_callback(_("database path incorrect"));
+bool SqliteCache::read_rows(sqlite3_stmt *statement, PackageTree *packagetree, const string& cat_name, Category *category) {
+	// Since the rows are ordered by category, we need to look up
+	// the destination category only when the category changes.
+	string curr_cat;
+	bool have_cat(false);
+	Category *dest_cat(NULLPTR);
+	int rc(sqlite3_step(statement));
+	for(; likely(rc == SQLITE_ROW); rc = sqlite3_step(statement)) {
+#ifdef SQLITE_ONLY_DEBUG
+		for(int i(0); likely(i < sqlite3_column_count(statement)); ++i) {
+			cout << eix::format("%s: %s = %s\n")
+				% i % sqlite3_column_name(statement, i)
+				% welldefine(reinterpret_cast<const char *>(sqlite3_column_text(statement, i)));
+		}
+		continue;
+#endif
+		const char *key(TrueIndex::c_str(statement, trueindex, TrueIndex::NAME));
+		const char *slash(std::strchr(key, '/'));
+		if(unlikely(slash == NULLPTR)) {
+			m_error_callback(eix::format(_("\"%s\" not of the form package/category-version")) % key);
+			return false;
+		}
+		string::size_type len(slash - key);
+		if(!have_cat || (curr_cat.size() != len) ||
+			(curr_cat.compare(0, len, key, len) != 0)) {
+			have_cat = true;
+			curr_cat.assign(key, len);
+			// Does the category match?
+			// Currently, we do not add non-matching categories with this method.
+			if(unlikely(packagetree == NULLPTR)) {
+				dest_cat = ((curr_cat == cat_name) ? category : NULLPTR);
+			} else if(never_add_categories) {
+				dest_cat = packagetree->find(curr_cat);
+			} else {
+				dest_cat = &((*packagetree)[curr_cat]);
+			}
+		}
+		if(dest_cat != NULLPTR) {
+			add_row(statement, slash + 1, curr_cat, dest_cat);
+		}
+	}
+	if(unlikely(rc != SQLITE_DONE)) {
+		m_error_callback(eix::format(_("sqlite error: %s")) % sqlite3_errmsg(db));
 		return false;
 	}
-	sqlitefile.resize(pos + 1);
-	sqlitefile.append(".sqlite");
+	return true;
+}
 
-	sqlite3 *db(NULLPTR);
-	if(sqlite3_open(sqlitefile.c_str(), &db) != SQLITE_OK) {
-		sqlite3_close(db);
-		m_error_callback(eix::format(_("cannot open cache file %s")) % sqlitefile);
+bool SqliteCache::read_all(PackageTree *packagetree, const string& cat_name, Category *category) {
+	sqlite3_stmt *statement(prepare("select * from portage_packages order by portage_package_key"));
+	if(unlikely(statement == NULLPTR)) {
+		// Maybe the column has a different name
+		statement = prepare("select * from portage_packages");
+	}
+	if(unlikely(statement == NULLPTR)) {
+		m_error_callback(eix::format(_("sqlite error: %s")) % sqlite3_errmsg(db));
+		return false;
+	}
+	bool ok(calc_trueindex(statement) &&
+		read_rows(statement, packagetree, cat_name, category));
+	sqlite3_finalize(statement);
+	return ok;
+}
+
+bool SqliteCache::read_category(const string& cat_name, Category *category) {
+	if(stmt == NULLPTR) {
+		// The range corresponds to the prefix "cat_name/" since '0' follows '/'
+		stmt = prepare("select * from portage_packages"
+			" where portage_package_key >= ?1 and portage_package_key < ?2"
+			" order by portage_package_key");
+		if(unlikely(stmt == NULLPTR)) {
+			// Maybe the column has a different name
+			return read_all(NULLPTR, cat_name, category);
+		}
+		if(unlikely(!calc_trueindex(stmt))) {
+			finalize_stmt();
+			return false;
+		}
+	}
+	string from(cat_name), to(cat_name);
+	from.append(1, '/');
+	to.append(1, '0');
+	sqlite3_bind_text(stmt, 1, from.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text(stmt, 2, to.c_str(), -1, SQLITE_TRANSIENT);
+	bool ok(read_rows(stmt, NULLPTR, cat_name, category));
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+	return ok;
+}
+
+bool SqliteCache::readCategories(PackageTree *pkgtree, const char *catname, Category *cat) {
+	if(unlikely(!open_db())) {
 		return false;
 	}
-	callback_arg = this;
-	sqlite_callback_error = false;
-	maxindex = 0;
-	packagetree = pkgtree;
-	category = cat;
-	cat_name = catname;
-	int rc(sqlite3_exec(db, "select * from portage_packages", sqlite_callback, NULLPTR, &errormessage));
-	sqlite3_close(db);
-	trueindex.clear();
-	if(rc != SQLITE_OK) {
-		sqlite_callback_error = true;
-		m_error_callback(eix::format(_("sqlite error: %s")) % errormessage);
+	if(pkgtree != NULLPTR) {
+		return read_all(pkgtree, "", NULLPTR);
+	}
+	if(unlikely((catname == NULLPTR) || (cat == NULLPTR))) {
+		return true;
 	}
-	return !sqlite_callback_error;
+	return read_category(catname, cat);
 }
 
 #else /* Not WITH_SQLITE */
@@ -328,12 +412,18 @@ bool SqliteCache::readCategories(PackageTree *pkgtree, const char *catname, Cate
 #include "eixTk/i18n.h"  // NOLINT(build/include)
 #include "eixTk/unused.h"  // NOLINT(build/include)
 
+SqliteCache::~SqliteCache() {
+}
+
 bool SqliteCache::readCategories(PackageTree *pkgtree ATTRIBUTE_UNUSED, const char *catname ATTRIBUTE_UNUSED, Category *cat ATTRIBUTE_UNUSED) {
 	UNUSED(pkgtree);
 	UNUSED(catname);
 	UNUSED(cat);
-	m_error_callback(_("cache method sqlite is not compiled in.\n"
-		"Recompile eix, using configure option --with-sqlite to add sqlite support"));
+	if(!db_failed) {
+		db_failed = true;
+		m_error_callback(_("cache method sqlite is not compiled in.\n"
+			"Recompile eix, using configure option --with-sqlite to add sqlite support"));
+	}
 	return false;
 }
 
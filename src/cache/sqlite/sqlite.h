@@ -10,50 +10,83 @@
 #ifndef SRC_CACHE_SQLITE_SQLITE_H_
 #define SRC_CACHE_SQLITE_SQLITE_H_ 1
 
+#include <string>
 #include <vector>
 
 #include "cache/base.h"
+#include "eixTk/null.h"
 
 class Category;
 class PackageTree;
 class TrueIndex;
+struct sqlite3;
+struct sqlite3_stmt;
 
 class SqliteCache : public BasicCache {
-		friend int sqlite_callback(void *NotUsed, int argc, char **argv, char **azColName);
-
 	public:  // actually private, but this is too clumsy...
 		typedef std::vector<int> TrueIndexMap;
 
 	private:
 		bool never_add_categories;
-		void sqlite_callback_cpp(int argc, const char **argv, const char **azColName) ATTRIBUTE_NONNULL((4));
 		TrueIndexMap trueindex;
 		int maxindex;
+		static TrueIndex *true_index;
 
 		/**
-		This variable is actually the this-parameter for our sqlite_callback function.
-		Note that this makes readCategories non-reentrant.
+		The database is opened at the first access and kept open
 		**/
-		static SqliteCache *callback_arg;
+		sqlite3 *db;
+		bool db_failed;
 		/**
-		Our sqlite_callback() will set this to true in case of an error
+		The statement selecting a single category, kept for further
+		categories (e.g. eix-update --watch)
 		**/
-		bool sqlite_callback_error;
+		sqlite3_stmt *stmt;
+
+		bool open_db();
+		void close_db();
+		sqlite3_stmt *prepare(const char *query);
+		bool calc_trueindex(sqlite3_stmt *statement) ATTRIBUTE_NONNULL_;
+
 		/**
-		Parameter passing to sqlite_callback()
+		Read all rows in one scan; only rows of category cat_name are
+		added to category unless packagetree is not NULLPTR.
+		@return false if an error occurred
 		**/
-		PackageTree *packagetree;
-		Category *category;
-		const char *cat_name;
-		static TrueIndex *true_index;
+		bool read_all(PackageTree *packagetree, const std::string& cat_name, Category *category);
+
+		/**
+		Read only the rows of category cat_name into category
+		@return false if an error occurred
+		**/
+		bool read_category(const std::string& cat_name, Category *category) ATTRIBUTE_NONNULL_;
+
+		/**
+		Read all rows of statement. Only rows of category cat_name are
+		added to category unless packagetree is not NULLPTR.
+		@return false if an error occurred
+		**/
+		bool read_rows(sqlite3_stmt *statement, PackageTree *packagetree, const std::string& cat_name, Category *category) ATTRIBUTE_NONNULL((2));
+
+		/**
+		Add the current row of statement to dest_cat
+		**/
+		void add_row(sqlite3_stmt *statement, const char *name_ver, const std::string& cat_name, Category *dest_cat) ATTRIBUTE_NONNULL_;
+
+		void finalize_stmt();
 
 	public:
-		SqliteCache() : BasicCache(), never_add_categories(true) {
+		SqliteCache() : BasicCache(), never_add_categories(true), db(NULLPTR), db_failed(false), stmt(NULLPTR) {
 		}
 
-		explicit SqliteCache(bool add_categories) : BasicCache(), never_add_categories(!add_categories) {
+		explicit SqliteCache(bool add_categories) : BasicCache(), never_add_categories(!add_categories), db(NULLPTR), db_failed(false), stmt(NULLPTR) {
 		}
 
+		~SqliteCache();
+
+		/**
+		All categories are read in one scan; only sqlite* adds categories
+		**/
 		bool can_read_multiple_categories() const ATTRIBUTE_CONST_VIRTUAL {
 			return true;
 		}
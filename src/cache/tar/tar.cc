@@ -0,0 +1,384 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <string>
+
+#include "cache/common/assign_reader.h"
+#include "cache/tar/tar.h"
+#include "eixTk/eixint.h"
+#include "eixTk/formated.h"
+#include "eixTk/i18n.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/stringutils.h"
+#include "portage/basicversion.h"
+#include "portage/depend.h"
+#include "portage/package.h"
+#include "portage/packagetree.h"
+#include "portage/version.h"
+
+using std::string;
+
+/* Subpath to the archive in the repository */
+#define TAR_PATH "metadata/md5-cache.tar"
+
+#define TAR_BLOCK 512
+
+static bool tar_number(eix::OffsetType *ret, const char *field, string::size_type len) ATTRIBUTE_NONNULL_;
+static bool tar_checksum(const char *header) ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+static eix::OffsetType tar_padded(eix::OffsetType len) ATTRIBUTE_CONST;
+static bool tar_read(FILE *fp, string *s, eix::OffsetType len) ATTRIBUTE_NONNULL_;
+static bool tar_seek(FILE *fp, eix::OffsetType offset) ATTRIBUTE_NONNULL_;
+static void tar_pax_path(string *path, const string& records) ATTRIBUTE_NONNULL_;
+static void tar_string(string *s, const char *field, string::size_type len) ATTRIBUTE_NONNULL_;
+
+/**
+Parse a numeric header field: octal or GNU's base-256 encoding
+**/
+static bool tar_number(eix::OffsetType *ret, const char *field, string::size_type len) {
+	*ret = 0;
+	if(unlikely((static_cast<eix::UChar>(*field) & 0x80U) != 0)) {
+		// The remaining bits of the first byte belong to the number
+		*ret = static_cast<eix::UChar>(*field) & 0x7FU;
+		for(string::size_type i(1); likely(i != len); ++i) {
+			*ret = ((*ret) << 8) | static_cast<eix::UChar>(field[i]);
+		}
+		return true;
+	}
+	string::size_type i(0);
+	for(; (i != len) && (field[i] == ' '); ++i) {
+	}
+	bool have_digit(false);
+	for(; (i != len) && (field[i] >= '0') && (field[i] <= '7'); ++i) {
+		*ret = ((*ret) << 3) | static_cast<eix::OffsetType>(field[i] - '0');
+		have_digit = true;
+	}
+	return (have_digit && ((i == len) || (field[i] == ' ') || (field[i] == '\0')));
+}
+
+static bool tar_checksum(const char *header) {
+	eix::OffsetType sum;
+	if(unlikely(!tar_number(&sum, header + 148, 8))) {
+		return false;
+	}
+	eix::OffsetType calc(8 * static_cast<eix::OffsetType>(' '));
+	for(string::size_type i(0); likely(i != TAR_BLOCK); ++i) {
+		if((i < 148) || (i >= 156)) {
+			calc += static_cast<eix::UChar>(header[i]);
+		}
+	}
+	return (calc == sum);
+}
+
+/**
+Assign a possibly not 0-terminated header field
+**/
+static void tar_string(string *s, const char *field, string::size_type len) {
+	string::size_type i(0);
+	for(; (i != len) && (field[i] != '\0'); ++i) {
+	}
+	s->assign(field, i);
+}
+
+/**
+@return the size of an entry including the padding to the next block
+**/
+static eix::OffsetType tar_padded(eix::OffsetType len) {
+	return ((len + TAR_BLOCK - 1) / TAR_BLOCK) * TAR_BLOCK;
+}
+
+/**
+Read the content of an entry and skip the padding to the next block
+**/
+static bool tar_read(FILE *fp, string *s, eix::OffsetType len) {
+	string::size_type padded(static_cast<string::size_type>(tar_padded(len)));
+	s->resize(padded);
+	if(unlikely(padded == 0)) {
+		return true;
+	}
+	if(unlikely(fread(&((*s)[0]), 1, padded, fp) != padded)) {
+		return false;
+	}
+	s->resize(static_cast<string::size_type>(len));
+	return true;
+}
+
+static bool tar_seek(FILE *fp, eix::OffsetType offset) {
+#ifdef HAVE_FSEEKO
+	return (fseeko(fp, offset, SEEK_SET) == 0);
+#else
+	return (fseek(fp, offset, SEEK_SET) == 0);
+#endif
+}
+
+/**
+Extract the "path" record of a pax extended header
+**/
+static void tar_pax_path(string *path, const string& records) {
+	string::size_type i(0);
+	while(i < records.size()) {
+		string::size_type sp(records.find(' ', i));
+		if(unlikely(sp == string::npos)) {
+			return;
+		}
+		string::size_type len(my_atois(records.substr(i, sp - i).c_str()));
+		if(unlikely((len <= sp - i) || (i + len > records.size()))) {
+			return;
+		}
+		string::size_type end(i + len - 1);  // skip trailing newline
+		++sp;
+		if(records.compare(sp, 5, "path=") == 0) {
+			path->assign(records, sp + 5, end - sp - 5);
+		}
+		i += len;
+	}
+}
+
+TarCache::~TarCache() {
+	delete reader;
+}
+
+bool TarCache::initialize(const string& name) {
+	string pure_name(name);
+	string::size_type i(pure_name.find(':'));
+	if(i != string::npos) {
+		pure_name.erase(i);
+		have_override_path = true;
+		override_path.assign(name, i + 1, string::npos);
+	} else {
+		have_override_path = false;
+	}
+	if(caseequal(pure_name, "tar")) {
+		m_type = "tar";
+		never_add_categories = true;
+	} else if(caseequal(pure_name, "tar*")) {
+		m_type = "tar*";
+		never_add_categories = false;
+	} else {
+		return false;
+	}
+	if(have_override_path) {
+		m_type.append(1, ':');
+		m_type.append(override_path);
+	}
+	return true;
+}
+
+void TarCache::setSchemeFinish() {
+	if(have_override_path) {
+		m_file = override_path;
+		return;
+	}
+	m_file = m_prefix;
+	// m_scheme is actually the portdir
+	m_file.append(m_scheme);
+	optional_append(&m_file, '/');
+	m_file.append(TAR_PATH);
+}
+
+bool TarCache::get_destcat(PackageTree *packagetree, const char *cat_name, Category *category, const string& cat) {
+	if(likely((dest_cat != NULLPTR) && (dest_name == cat))) {
+		return true;
+	}
+	dest_name = cat;
+	dest_pkg = NULLPTR;
+	if(unlikely(packagetree == NULLPTR)) {
+		dest_cat = ((cat == cat_name) ? category : NULLPTR);
+	} else if(never_add_categories) {
+		dest_cat = packagetree->find(cat);
+	} else {
+		dest_cat = &((*packagetree)[cat]);
+	}
+	return (dest_cat != NULLPTR);
+}
+
+void TarCache::add_entry(PackageTree *packagetree, const char *cat_name, Category *category, const string& name, const string& content) {
+	string::size_type slash(name.rfind('/'));
+	if(unlikely((slash == string::npos) || (slash == 0))) {
+		return;
+	}
+	const char *pkgver(name.c_str() + slash + 1);
+	if(unlikely((*pkgver == '.') || (strchr(pkgver, '-') == NULLPTR))) {
+		return;
+	}
+	string::size_type catstart(name.rfind('/', slash - 1));
+	catstart = ((catstart == string::npos) ? 0 : (catstart + 1));
+	if(!get_destcat(packagetree, cat_name, category, name.substr(catstart, slash - catstart))) {
+		return;
+	}
+
+	char **aux(ExplodeAtom::split(pkgver));
+	if(unlikely(aux == NULLPTR)) {
+		m_error_callback(eix::format(_("cannot split \"%s\" into package and version")) % pkgver);
+		return;
+	}
+	if((dest_pkg == NULLPTR) || (dest_pkg->name != aux[0])) {
+		dest_pkg = dest_cat->findPackage(aux[0]);
+		if(dest_pkg == NULLPTR) {
+			dest_pkg = dest_cat->addPackage(dest_name, aux[0]);
+		}
+	}
+	Version *version(new Version);
+	string errtext;
+	BasicVersion::ParseResult r(version->parseVersion(aux[1], &errtext));
+	free(aux[0]);
+	free(aux[1]);
+	if(unlikely(r != BasicVersion::parsedOK)) {
+		m_error_callback(errtext);
+		if(r == BasicVersion::parsedError) {
+			delete version;
+			return;
+		}
+	}
+	if(reader == NULLPTR) {
+		reader = new AssignReader(this);
+	}
+	reader->set_content(name.c_str(), content);
+	string eapi, keywords, iuse, required_use, restr, props, slot;
+	reader->get_keywords_slot_iuse_restrict(name, &eapi, &keywords, &slot, &iuse, &required_use, &restr, &props, &(version->depend));
+	version->eapi.assign(eapi);
+	version->set_slotname(slot);
+	version->set_full_keywords(keywords);
+	version->set_iuse(iuse);
+	version->set_required_use(required_use);
+	version->set_restrict(restr);
+	version->set_properties(props);
+	version->overlay_key = m_overlay_key;
+	dest_pkg->addVersion(version);
+	// The archive need not be sorted: take common data from the newest
+	if(*(dest_pkg->latest()) == *version) {
+		reader->read_file(name.c_str(), dest_pkg);
+	}
+}
+
+bool TarCache::read_archive(FILE *fp, PackageTree *packagetree, const char *cat_name, Category *category, bool make_index) {
+	bool have_longname(false);
+	string longname, name, content;
+	char header[TAR_BLOCK];
+	for(eix::OffsetType offset(0); ; ) {
+		size_t got(fread(header, 1, TAR_BLOCK, fp));
+		if(unlikely(got != TAR_BLOCK)) {
+			// Tolerate archives without the terminating zero blocks
+			return ((got == 0) && (feof(fp) != 0));
+		}
+		offset += TAR_BLOCK;
+		if(header[0] == '\0') {  // end of archive
+			return true;
+		}
+		eix::OffsetType size;
+		if(unlikely((!tar_checksum(header)) ||
+			(!tar_number(&size, header + 124, 12)) ||
+			(!tar_read(fp, &content, size)))) {
+			return false;
+		}
+		eix::OffsetType content_offset(offset);
+		offset += tar_padded(size);
+		char type(header[156]);
+		if(type == 'L') {  // GNU long name
+			longname.assign(content.c_str());
+			have_longname = true;
+			continue;
+		}
+		if(type == 'x') {  // pax extended header
+			longname.clear();
+			tar_pax_path(&longname, content);
+			have_longname = !longname.empty();
+			continue;
+		}
+		if((type != '0') && (type != '\0') && (type != '7')) {
+			have_longname = false;
+			continue;
+		}
+		if(have_longname) {
+			name.swap(longname);
+			have_longname = false;
+		} else {
+			tar_string(&name, header, 100);
+			if((strncmp(header + 257, "ustar", 5) == 0) && (header[345] != '\0')) {
+				string prefix;
+				tar_string(&prefix, header + 345, 155);
+				prefix.append(1, '/');
+				name.insert(0, prefix);
+			}
+		}
+		if(make_index) {
+			string::size_type slash(name.rfind('/'));
+			if(likely((slash != string::npos) && (slash != 0))) {
+				string::size_type catstart(name.rfind('/', slash - 1));
+				catstart = ((catstart == string::npos) ? 0 : (catstart + 1));
+				cat_index[name.substr(catstart, slash - catstart)].push_back(
+					Entry(name, content_offset, size));
+			}
+		}
+		add_entry(packagetree, cat_name, category, name, content);
+	}
+}
+
+bool TarCache::read_index(FILE *fp, const char *cat_name, Category *category) {
+	Index::const_iterator found(cat_index.find(cat_name));
+	if(found == cat_index.end()) {
+		return true;
+	}
+	string content;
+	for(Entries::const_iterator it(found->second.begin());
+		likely(it != found->second.end()); ++it) {
+		if(unlikely((!tar_seek(fp, it->offset)) ||
+			(!tar_read(fp, &content, it->size)))) {
+			return false;
+		}
+		add_entry(NULLPTR, cat_name, category, it->name, content);
+	}
+	return true;
+}
+
+bool TarCache::readCategories(PackageTree *packagetree, const char *cat_name, Category *category) {
+	FILE *fp(fopen(m_file.c_str(), "rb"));
+	if(unlikely(fp == NULLPTR)) {
+		m_error_callback(eix::format(_("cannot read cache file %s: %s"))
+			% m_file % strerror(errno));
+		return false;
+	}
+	dest_cat = NULLPTR;
+	dest_pkg = NULLPTR;
+	bool success;
+	if(packagetree != NULLPTR) {
+		success = read_archive(fp, packagetree, NULLPTR, NULLPTR, false);
+	} else {
+		// Use the index only if the archive has not changed
+		struct stat st;
+		bool same(stat(m_file.c_str(), &st) == 0);
+		if(same && have_index &&
+			(st.st_size == index_size) && (st.st_mtime == index_mtime)) {
+			success = read_index(fp, cat_name, category);
+		} else {
+			cat_index.clear();
+			success = read_archive(fp, NULLPTR, cat_name, category, same);
+			have_index = (success && same);
+			index_size = st.st_size;
+			index_mtime = st.st_mtime;
+		}
+	}
+	fclose(fp);
+	dest_cat = NULLPTR;
+	dest_pkg = NULLPTR;
+	if(unlikely(!success)) {
+		have_index = false;
+		cat_index.clear();
+		m_error_callback(eix::format(_("cache file %s is not a valid tar archive")) % m_file);
+	}
+	return success;
+}
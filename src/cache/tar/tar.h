@@ -0,0 +1,114 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_CACHE_TAR_TAR_H_
+#define SRC_CACHE_TAR_TAR_H_ 1
+
+#include <cstdio>
+#include <ctime>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cache/base.h"
+#include "eixTk/eixint.h"
+#include "eixTk/null.h"
+
+class AssignReader;
+class Category;
+class Package;
+class PackageTree;
+
+/**
+Read the metadata of a repository from an uncompressed tar archive of
+the md5-cache (e.g. created with "tar --sort=name -cf md5-cache.tar
+-C metadata/md5-cache ."). The archive is read in one sequential pass.
+**/
+class TarCache : public BasicCache {
+	private:
+		/**
+		The position of the content of an entry in the archive
+		**/
+		class Entry {
+			public:
+				std::string name;
+				eix::OffsetType offset, size;
+
+				Entry(const std::string& n, eix::OffsetType o, eix::OffsetType s) :
+					name(n), offset(o), size(s) {
+				}
+		};
+		typedef std::vector<Entry> Entries;
+		typedef std::map<std::string, Entries> Index;
+
+		bool never_add_categories;
+		bool have_override_path;
+		std::string override_path;
+		std::string m_type;
+		std::string m_file;
+		AssignReader *reader;
+
+		/**
+		The entries by category, collected when a single category is read
+		(eix-update --watch), so that further categories need not scan the
+		archive again as long as its size and modification time remain
+		**/
+		Index cat_index;
+		bool have_index;
+		eix::OffsetType index_size;
+		time_t index_mtime;
+
+		/**
+		The destination of the current archive entry
+		**/
+		std::string dest_name;
+		Category *dest_cat;
+		Package *dest_pkg;
+
+		void setSchemeFinish();
+		bool get_destcat(PackageTree *packagetree, const char *cat_name, Category *category, const std::string& cat);
+		void add_entry(PackageTree *packagetree, const char *cat_name, Category *category, const std::string& name, const std::string& content);
+
+		/**
+		Read all entries of the archive in one pass, collecting the index
+		if make_index is true
+		@return false if the archive is invalid
+		**/
+		bool read_archive(FILE *fp, PackageTree *packagetree, const char *cat_name, Category *category, bool make_index) ATTRIBUTE_NONNULL((2));
+
+		/**
+		Read the entries of category cat_name which are in the index
+		@return false if the archive is invalid
+		**/
+		bool read_index(FILE *fp, const char *cat_name, Category *category) ATTRIBUTE_NONNULL_;
+
+	public:
+		TarCache() : reader(NULLPTR), have_index(false), dest_cat(NULLPTR), dest_pkg(NULLPTR) {
+		}
+
+		~TarCache();
+
+		// @return true if successful
+		bool initialize(const std::string& name);
+
+		bool use_prefixport() const ATTRIBUTE_CONST_VIRTUAL {
+			return true;
+		}
+
+		bool can_read_multiple_categories() const ATTRIBUTE_CONST_VIRTUAL {
+			return true;
+		}
+
+		bool readCategories(PackageTree *packagetree, const char *cat_name, Category *category);
+
+		const char *getType() const {
+			return m_type.c_str();
+		}
+};
+
+#endif  // SRC_CACHE_TAR_TAR_H_
@@ -25,7 +25,9 @@ using std::string;
 const DBHeader::SaveBitmask
 	DBHeader::SAVE_BITMASK_NONE,
 	DBHeader::SAVE_BITMASK_DEP,
-	DBHeader::SAVE_BITMASK_REQUIRED_USE;
+	DBHeader::SAVE_BITMASK_REQUIRED_USE,
+	DBHeader::SAVE_BITMASK_SPLIT,
+	DBHeader::SAVE_BITMASK_INDEX;
 
 const DBHeader::OverlayTest
 	DBHeader::OVTEST_NONE,
@@ -43,7 +45,7 @@ const DBHeader::DBVersion DBHeader::current;
 Which version we do accept. The list must end with 0
 **/
 const DBHeader::DBVersion DBHeader::accept[] = {
-	DBHeader::current, 35, 34, 33, 32, 31,
+	DBHeader::current, 36, 35, 34, 33, 32, 31,
 	0
 };
 
@@ -47,10 +47,22 @@ class DBHeader {
 		static CONSTEXPR SaveBitmask
 			SAVE_BITMASK_NONE         = 0x00U,
 			SAVE_BITMASK_DEP          = 0x01U,
-			SAVE_BITMASK_REQUIRED_USE = 0x02U;
+			SAVE_BITMASK_REQUIRED_USE = 0x02U,
+			SAVE_BITMASK_SPLIT        = 0x04U,
+			SAVE_BITMASK_INDEX        = 0x08U;
 
 		bool use_depend, use_required_use;
 
+		/**
+		Are the names of each category stored before the other data?
+		**/
+		bool names_first;
+
+		/**
+		Is a NamesIndex appended to the categories?
+		**/
+		bool names_index;
+
 		WordVec world_sets;
 
 		typedef  eix::UNumber DBVersion;
@@ -71,7 +83,7 @@ class DBHeader {
 		/**
 		Current version of database-format and what we accept
 		**/
-		static CONSTEXPR DBVersion current = 36;
+		static CONSTEXPR DBVersion current = 37;
 		static const DBVersion accept[];
 
 		/**
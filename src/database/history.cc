@@ -0,0 +1,621 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "database/header.h"
+#include "database/history.h"
+#include "database/io.h"
+#include "eixTk/auto_list.h"
+#include "eixTk/eixint.h"
+#include "eixTk/formated.h"
+#include "eixTk/i18n.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/stringutils.h"
+#include "portage/depend.h"
+#include "portage/extendedversion.h"
+#include "portage/overlay.h"
+#include "portage/package.h"
+#include "portage/packagetree.h"
+#include "portage/version.h"
+
+/**
+The number of hash tables of a database header
+**/
+#define HISTORY_HASHES 6
+
+using std::map;
+using std::string;
+using std::vector;
+
+const char *DBHistory::magic = "eix-history\n";
+
+typedef vector<StringHash::size_type> HashSizes;
+typedef vector<ExtendedVersion::Overlay> OverlayMap;
+
+static const StringHash *get_hash(const DBHeader& header, unsigned int i);
+static StringHash *get_hash(DBHeader *header, unsigned int i) ATTRIBUTE_NONNULL_;
+static void append_words(StringHash *hash, const WordVec& words) ATTRIBUTE_NONNULL_;
+static void append_words(StringHash *hash, const string& words) ATTRIBUTE_NONNULL_;
+static void corrupt_error(string *errtext) ATTRIBUTE_NONNULL_;
+
+/**
+@return the i-th hash table in the order in which they are stored
+**/
+static const StringHash *get_hash(const DBHeader& header, unsigned int i) {
+	switch(i) {
+		case 0: return &(header.eapi_hash);
+		case 1: return &(header.license_hash);
+		case 2: return &(header.keywords_hash);
+		case 3: return &(header.iuse_hash);
+		case 4: return &(header.slot_hash);
+		default: break;
+	}
+	return &(header.depend_hash);
+}
+
+static StringHash *get_hash(DBHeader *header, unsigned int i) {
+	return const_cast<StringHash *>(get_hash(*header, i));
+}
+
+static void append_words(StringHash *hash, const WordVec& words) {
+	for(WordVec::const_iterator it(words.begin()); likely(it != words.end()); ++it) {
+		hash->append_string(*it);
+	}
+}
+
+static void append_words(StringHash *hash, const string& words) {
+	append_words(hash, split_string(words));
+}
+
+static void corrupt_error(string *errtext) {
+	*errtext = _("history file is corrupt");
+}
+
+bool DBHistory::open_error(const char *name, const char *mode, string *errtext) {
+	*errtext = eix::format(_("cannot open history file %s (mode = '%s')"))
+		% name % mode;
+	return false;
+}
+
+bool DBHistory::read_all(string *data, string *errtext) {
+	eix::OffsetType size(tell());
+	if(unlikely(!seekabs(0, errtext))) {
+		return false;
+	}
+	string::size_type len(size);
+	data->resize(len);
+	return ((len == 0) || read_string_plain(&((*data)[0]), len, errtext));
+}
+
+bool DBHistory::read_history(const char *name, Generations::size_type last, Generations *generations, State *state, string *errtext) {
+	if(unlikely(!openread(name))) {
+		if(errno == ENOENT) {
+			return true;
+		}
+		return open_error(name, "rb", errtext);
+	}
+	if(unlikely(!seekend(errtext))) {
+		return false;
+	}
+	eix::OffsetType size(tell());
+	if(size == 0) {
+		return true;
+	}
+	if(unlikely(!seekabs(0, errtext))) {
+		return false;
+	}
+	string::size_type magic_len(strlen(magic));
+	eix::auto_list<char> buf(new char[magic_len]);
+	if(unlikely(!read_string_plain(buf.get(), magic_len, errtext))) {
+		return false;
+	}
+	if(unlikely(memcmp(magic, buf.get(), magic_len) != 0)) {
+		*errtext = eix::format(_("%s is not an eix history file")) % name;
+		return false;
+	}
+	DBHeader::DBVersion version;
+	if(unlikely(!read_num(&version, errtext))) {
+		return false;
+	}
+	// Database format 37 changed only the layout of the package tree
+	if(unlikely((version != DBHeader::current) && (version != 36))) {
+		*errtext = eix::format(_("history file %s uses database format %s (current is %s)"))
+			% name % version % DBHeader::current;
+		return false;
+	}
+	while(tell() != size) {
+		bool apply((state != NULLPTR) && (generations->size() <= last));
+		generations->push_back(Generation());
+		if(unlikely(!read_generation(&(generations->back()),
+			(apply ? state : NULLPTR), errtext))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DBHistory::read_generation(Generation *generation, State *state, string *errtext) {
+	eix::OffsetType len;
+	if(unlikely(!read_num(&len, errtext))) {
+		return false;
+	}
+	eix::OffsetType end(tell() + len);
+	eix::OffsetType date;
+	eix::UChar full;
+	if(unlikely(!read_num(&date, errtext) ||
+		!readUChar(&full, errtext) ||
+		!read_num(&(generation->packages), errtext) ||
+		!read_num(&(generation->changed), errtext) ||
+		!read_num(&(generation->removed), errtext))) {
+		return false;
+	}
+	generation->date = std::time_t(date);
+	generation->full = (full != 0);
+	if(state == NULLPTR) {
+		return seekabs(end, errtext);
+	}
+
+	DBHeader *header(&(state->header));
+	if(generation->full) {
+		*header = DBHeader();
+		state->tree.clear();
+	}
+	DBHeader::SaveBitmask save_bitmask;
+	if(unlikely(!read_num(&save_bitmask, errtext))) {
+		return false;
+	}
+	header->use_depend = ((save_bitmask & DBHeader::SAVE_BITMASK_DEP) != 0);
+	header->use_required_use = ((save_bitmask & DBHeader::SAVE_BITMASK_REQUIRED_USE) != 0);
+	header->names_first = false;
+	header->names_index = false;
+	for(unsigned int i(0); likely(i != HISTORY_HASHES); ++i) {
+		StringHash *hash(get_hash(header, i));
+		StringHash::size_type count;
+		if(unlikely(!read_num(&count, errtext))) {
+			return false;
+		}
+		for(; count != 0; --count) {
+			string s;
+			if(unlikely(!read_string(&s, errtext))) {
+				return false;
+			}
+			hash->store_string(s);
+		}
+	}
+	ExtendedVersion::Overlay overlays;
+	if(unlikely(!read_num(&overlays, errtext))) {
+		return false;
+	}
+	for(; overlays != 0; --overlays) {
+		string path, label;
+		if(unlikely(!read_string(&path, errtext) || !read_string(&label, errtext))) {
+			return false;
+		}
+		header->addOverlay(OverlayIdent(path.c_str(), label.c_str()));
+	}
+	WordVec::size_type sets;
+	if(unlikely(!read_num(&sets, errtext))) {
+		return false;
+	}
+	header->world_sets.resize(sets);
+	for(WordVec::iterator it(header->world_sets.begin());
+		likely(it != header->world_sets.end()); ++it) {
+		if(unlikely(!read_string(&(*it), errtext))) {
+			return false;
+		}
+	}
+
+	BlobTree::size_type categories;
+	if(unlikely(!read_num(&categories, errtext))) {
+		return false;
+	}
+	for(; categories != 0; --categories) {
+		string name;
+		eix::UChar present;
+		if(unlikely(!read_string(&name, errtext) || !readUChar(&present, errtext))) {
+			return false;
+		}
+		if(present == 0) {
+			state->tree.erase(name);
+			continue;
+		}
+		BlobCategory& category(state->tree[name]);
+		typedef map<string, string *> BlobIndex;
+		BlobIndex index;
+		for(BlobCategory::iterator it(category.begin()); likely(it != category.end()); ++it) {
+			index[it->name] = &(it->data);
+		}
+		BlobCategory::size_type count;
+		if(unlikely(!read_num(&count, errtext))) {
+			return false;
+		}
+		BlobCategory updated(count);
+		for(BlobCategory::iterator it(updated.begin()); likely(it != updated.end()); ++it) {
+			eix::UChar changed;
+			if(unlikely(!read_string(&(it->name), errtext) || !readUChar(&changed, errtext))) {
+				return false;
+			}
+			if(changed != 0) {
+				if(unlikely(!read_string(&(it->data), errtext))) {
+					return false;
+				}
+				continue;
+			}
+			BlobIndex::iterator old(index.find(it->name));
+			if(unlikely(old == index.end())) {
+				corrupt_error(errtext);
+				return false;
+			}
+			it->data.swap(*(old->second));
+		}
+		category.swap(updated);
+	}
+	if(unlikely(tell() != end)) {
+		corrupt_error(errtext);
+		return false;
+	}
+	return true;
+}
+
+bool DBHistory::encode_tree(BlobTree *encoded, State *state, const PackageTree& tree, const OverlayMap& overlay_map, string *errtext) {
+	if(unlikely(!opentemp())) {
+		*errtext = _("cannot create temporary file");
+		return false;
+	}
+	DBHeader *header(&(state->header));
+	vector<eix::OffsetType> ends;
+	vector<ExtendedVersion::Overlay> keys;
+	for(PackageTree::const_iterator c(tree.begin()); likely(c != tree.end()); ++c) {
+		Category *ci(c->second);
+		for(Category::iterator p(ci->begin()); likely(p != ci->end()); ++p) {
+			header->license_hash.append_string(p->licenses);
+			keys.clear();
+			for(Package::iterator v(p->begin()); likely(v != p->end()); ++v) {
+				header->eapi_hash.append_string(v->eapi.get());
+				append_words(&(header->keywords_hash), v->get_full_keywords());
+				append_words(&(header->iuse_hash), v->iuse.asVector());
+				if(header->use_required_use) {
+					append_words(&(header->iuse_hash), v->required_use);
+				}
+				header->slot_hash.append_string(v->get_shortfullslot());
+				if(header->use_depend) {
+					const Depend& dep(v->depend);
+					append_words(&(header->depend_hash), dep.m_depend);
+					append_words(&(header->depend_hash), dep.m_rdepend);
+					append_words(&(header->depend_hash), dep.m_pdepend);
+					append_words(&(header->depend_hash), dep.m_hdepend);
+				}
+				keys.push_back(v->overlay_key);
+				v->overlay_key = overlay_map[v->overlay_key];
+			}
+			bool success(write_package_pure(**p, *header, errtext));
+			vector<ExtendedVersion::Overlay>::const_iterator key(keys.begin());
+			for(Package::iterator v(p->begin()); likely(v != p->end()); ++v) {
+				v->overlay_key = *(key++);
+			}
+			if(unlikely(!success)) {
+				return false;
+			}
+			ends.push_back(tell());
+		}
+	}
+	string data;
+	if(unlikely(!read_all(&data, errtext))) {
+		return false;
+	}
+	vector<eix::OffsetType>::const_iterator end(ends.begin());
+	eix::OffsetType start(0);
+	for(PackageTree::const_iterator c(tree.begin()); likely(c != tree.end()); ++c) {
+		BlobCategory& category((*encoded)[c->first]);
+		Category *ci(c->second);
+		category.resize(ci->size());
+		BlobCategory::iterator blob(category.begin());
+		for(Category::iterator p(ci->begin()); likely(p != ci->end()); ++p, ++blob) {
+			blob->name = p->name;
+			blob->data.assign(data, start, *end - start);
+			start = *(end++);
+		}
+	}
+	return true;
+}
+
+bool DBHistory::write_generation(const Generation& generation, State *state, const BlobTree& changes, const WordVec& removed_categories, const HashSizes& old_sizes, ExtendedVersion::Overlay old_overlays, string *errtext) {
+	DBHeader *header(&(state->header));
+	if(unlikely(!write_num(eix::OffsetType(generation.date), errtext) ||
+		!writeUChar(eix::UChar(generation.full ? 1 : 0), errtext) ||
+		!write_num(generation.packages, errtext) ||
+		!write_num(generation.changed, errtext) ||
+		!write_num(generation.removed, errtext))) {
+		return false;
+	}
+	DBHeader::SaveBitmask save_bitmask(DBHeader::SAVE_BITMASK_NONE);
+	if(header->use_depend) {
+		save_bitmask |= DBHeader::SAVE_BITMASK_DEP;
+	}
+	if(header->use_required_use) {
+		save_bitmask |= DBHeader::SAVE_BITMASK_REQUIRED_USE;
+	}
+	if(unlikely(!write_num(save_bitmask, errtext))) {
+		return false;
+	}
+	for(unsigned int i(0); likely(i != HISTORY_HASHES); ++i) {
+		const StringHash *hash(get_hash(header, i));
+		if(unlikely(!write_num(hash->size() - old_sizes[i], errtext))) {
+			return false;
+		}
+		for(StringHash::size_type j(old_sizes[i]); likely(j != hash->size()); ++j) {
+			if(unlikely(!write_string((*hash)[j], errtext))) {
+				return false;
+			}
+		}
+	}
+	if(unlikely(!write_num(header->countOverlays() - old_overlays, errtext))) {
+		return false;
+	}
+	for(ExtendedVersion::Overlay i(old_overlays); likely(i != header->countOverlays()); ++i) {
+		const OverlayIdent& overlay(header->getOverlay(i));
+		if(unlikely(!write_string(overlay.path, errtext) ||
+			!write_string(overlay.label, errtext))) {
+			return false;
+		}
+	}
+	if(unlikely(!write_num(header->world_sets.size(), errtext))) {
+		return false;
+	}
+	for(WordVec::const_iterator it(header->world_sets.begin());
+		likely(it != header->world_sets.end()); ++it) {
+		if(unlikely(!write_string(*it, errtext))) {
+			return false;
+		}
+	}
+
+	if(unlikely(!write_num(changes.size() + removed_categories.size(), errtext))) {
+		return false;
+	}
+	for(BlobTree::const_iterator c(changes.begin()); likely(c != changes.end()); ++c) {
+		const BlobCategory& category(c->second);
+		if(unlikely(!write_string(c->first, errtext) ||
+			!writeUChar(1, errtext) ||
+			!write_num(category.size(), errtext))) {
+			return false;
+		}
+		for(BlobCategory::const_iterator it(category.begin()); likely(it != category.end()); ++it) {
+			if(unlikely(!write_string(it->name, errtext))) {
+				return false;
+			}
+			if(it->data.empty()) {
+				if(unlikely(!writeUChar(0, errtext))) {
+					return false;
+				}
+			} else if(unlikely(!writeUChar(1, errtext) ||
+				!write_string(it->data, errtext))) {
+				return false;
+			}
+		}
+	}
+	for(WordVec::const_iterator it(removed_categories.begin());
+		likely(it != removed_categories.end()); ++it) {
+		if(unlikely(!write_string(*it, errtext) || !writeUChar(0, errtext))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DBHistory::append(const char *name, const DBHeader& header, const PackageTree& tree, string *errtext) {
+	Generations generations;
+	State state;
+	{
+		DBHistory history;
+		if(unlikely(!history.read_history(name, Generations::size_type(-1),
+			&generations, &state, errtext))) {
+			return false;
+		}
+	}
+
+	// Start from scratch when the accumulated data do no longer fit
+	DBHeader *accumulated(&(state.header));
+	bool full(generations.empty() ||
+		(accumulated->use_depend != header.use_depend) ||
+		(accumulated->use_required_use != header.use_required_use) ||
+		(accumulated->countOverlays() == 0) ||
+		(header.countOverlays() == 0) ||
+		(accumulated->getOverlay(0).path != header.getOverlay(0).path) ||
+		(accumulated->getOverlay(0).label != header.getOverlay(0).label));
+	if(!full) {
+		StringHash::size_type words(0), current(0);
+		for(unsigned int i(0); likely(i != HISTORY_HASHES); ++i) {
+			words += get_hash(accumulated, i)->size();
+			current += get_hash(header, i)->size();
+		}
+		full = (words / 2 > current);
+	}
+	HashSizes old_sizes(HISTORY_HASHES, 0);
+	ExtendedVersion::Overlay old_overlays(0);
+	if(full) {
+		state.header = header;
+		state.tree.clear();
+		if(!header.use_depend) {
+			accumulated->depend_hash.init(false);
+		}
+	} else {
+		for(unsigned int i(0); likely(i != HISTORY_HASHES); ++i) {
+			StringHash *hash(get_hash(accumulated, i));
+			hash->finalize_index();
+			old_sizes[i] = hash->size();
+		}
+		old_overlays = accumulated->countOverlays();
+	}
+	for(unsigned int i(0); likely(i != HISTORY_HASHES); ++i) {
+		get_hash(accumulated, i)->finalize_index();
+	}
+	accumulated->world_sets = header.world_sets;
+
+	OverlayMap overlay_map;
+	for(ExtendedVersion::Overlay i(0); likely(i != header.countOverlays()); ++i) {
+		const OverlayIdent& overlay(header.getOverlay(i));
+		ExtendedVersion::Overlay j(0);
+		for(; likely(j != accumulated->countOverlays()); ++j) {
+			const OverlayIdent& known(accumulated->getOverlay(j));
+			if((known.path == overlay.path) && (known.label == overlay.label)) {
+				break;
+			}
+		}
+		if(j == accumulated->countOverlays()) {
+			j = accumulated->addOverlay(OverlayIdent(overlay.path.c_str(), overlay.label.c_str()));
+		}
+		overlay_map.push_back(j);
+	}
+
+	BlobTree encoded;
+	{
+		DBHistory temp;
+		if(unlikely(!temp.encode_tree(&encoded, &state, tree, overlay_map, errtext))) {
+			return false;
+		}
+	}
+
+	// Compare with the previous generation; unchanged blobs are cleared
+	Generation generation;
+	generation.date = std::time(NULLPTR);
+	generation.full = full;
+	generation.packages = generation.changed = generation.removed = 0;
+	BlobTree changes;
+	WordVec removed_categories;
+	BlobTree::const_iterator old(state.tree.begin());
+	for(BlobTree::iterator c(encoded.begin()); likely(c != encoded.end()); ++c) {
+		BlobCategory& category(c->second);
+		generation.packages += category.size();
+		for(; (old != state.tree.end()) && (old->first < c->first); ++old) {
+			removed_categories.push_back(old->first);
+			generation.removed += old->second.size();
+		}
+		if((old == state.tree.end()) || (old->first != c->first)) {
+			generation.changed += category.size();
+			changes[c->first].swap(category);
+			continue;
+		}
+		const BlobCategory& previous(old->second);
+		++old;
+		typedef map<string, const string *> BlobIndex;
+		BlobIndex index;
+		for(BlobCategory::const_iterator it(previous.begin()); likely(it != previous.end()); ++it) {
+			index[it->name] = &(it->data);
+		}
+		bool same(category.size() == previous.size());
+		BlobCategory::size_type kept(0);
+		BlobCategory::const_iterator prev(previous.begin());
+		for(BlobCategory::iterator it(category.begin()); likely(it != category.end()); ++it) {
+			if(same && (prev++)->name != it->name) {
+				same = false;
+			}
+			BlobIndex::const_iterator found(index.find(it->name));
+			if(found == index.end()) {
+				same = false;
+				++(generation.changed);
+				continue;
+			}
+			++kept;
+			if(*(found->second) == it->data) {
+				it->data.clear();
+				continue;
+			}
+			same = false;
+			++(generation.changed);
+		}
+		generation.removed += previous.size() - kept;
+		if(!same) {
+			changes[c->first].swap(category);
+		}
+	}
+	for(; old != state.tree.end(); ++old) {
+		removed_categories.push_back(old->first);
+		generation.removed += old->second.size();
+	}
+
+	string body;
+	{
+		DBHistory temp;
+		if(unlikely(!temp.opentemp())) {
+			*errtext = _("cannot create temporary file");
+			return false;
+		}
+		if(unlikely(!temp.write_generation(generation, &state, changes,
+			removed_categories, old_sizes, old_overlays, errtext) ||
+			!temp.read_all(&body, errtext))) {
+			return false;
+		}
+	}
+
+	DBHistory history;
+	if(unlikely(!history.openappend(name))) {
+		return open_error(name, "ab", errtext);
+	}
+	if(unlikely(!history.seekend(errtext))) {
+		return false;
+	}
+	if(history.tell() == 0) {
+		if(unlikely(!history.File::write_string_plain(magic, errtext) ||
+			!history.write_num(DBHeader::current, errtext))) {
+			return false;
+		}
+	}
+	return history.write_string(body, errtext);
+}
+
+bool DBHistory::list(const char *name, Generations *generations, string *errtext) {
+	DBHistory history;
+	return history.read_history(name, 0, generations, NULLPTR, errtext);
+}
+
+bool DBHistory::extract(const char *name, Generations::size_type gen, const char *dbname, string *errtext) {
+	Generations generations;
+	State state;
+	{
+		DBHistory history;
+		if(unlikely(!history.read_history(name, gen, &generations, &state, errtext))) {
+			return false;
+		}
+	}
+	if(unlikely(gen >= generations.size())) {
+		*errtext = eix::format(_("history file %s has no generation %s"))
+			% name % (gen + 1);
+		return false;
+	}
+	DBHistory db;
+	if(unlikely(!db.openwrite(dbname))) {
+		return open_error(dbname, "wb", errtext);
+	}
+	DBHeader *header(&(state.header));
+	header->size = eix::Catsize(state.tree.size());
+	if(unlikely(!db.write_header(*header, errtext))) {
+		return false;
+	}
+	for(BlobTree::const_iterator c(state.tree.begin()); likely(c != state.tree.end()); ++c) {
+		const BlobCategory& category(c->second);
+		if(unlikely(!db.write_category_header(c->first, eix::Treesize(category.size()), errtext))) {
+			return false;
+		}
+		for(BlobCategory::const_iterator it(category.begin()); likely(it != category.end()); ++it) {
+			if(unlikely(!db.write_string(it->data, errtext))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,109 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_DATABASE_HISTORY_H_
+#define SRC_DATABASE_HISTORY_H_ 1
+
+#include <ctime>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "database/header.h"
+#include "database/io.h"
+#include "eixTk/eixint.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/stringutils.h"
+
+class PackageTree;
+
+/**
+An append-only history of the database: Each generation (i.e. each run of
+eix-update) stores only the packages which changed since the previous
+generation. The packages are encoded against hash tables and an overlay
+table which only grow, so the encoding of a package does not change as long
+as the package does not change, and every generation can be reconstructed.
+From time to time a full generation is stored which starts from scratch.
+**/
+class DBHistory : public Database {
+	public:
+		class Generation {
+			public:
+				std::time_t date;
+				bool full;
+				eix::Treesize packages, changed, removed;
+		};
+		typedef std::vector<Generation> Generations;
+
+		/**
+		Append the generation of a database just written
+		**/
+		static bool append(const char *name, const DBHeader& header, const PackageTree& tree, std::string *errtext) ATTRIBUTE_NONNULL((1, 4));
+
+		/**
+		Read the list of all generations of history file name
+		**/
+		static bool list(const char *name, Generations *generations, std::string *errtext) ATTRIBUTE_NONNULL_;
+
+		/**
+		Write generation gen (counted from 0) as a database file dbname
+		**/
+		static bool extract(const char *name, Generations::size_type gen, const char *dbname, std::string *errtext) ATTRIBUTE_NONNULL_;
+
+	private:
+		/**
+		A package encoded as in the database
+		**/
+		class Blob {
+			public:
+				std::string name, data;
+		};
+		typedef std::vector<Blob> BlobCategory;
+		typedef std::map<std::string, BlobCategory> BlobTree;
+
+		/**
+		The content of a generation: The header contains the accumulated
+		hash tables and overlays
+		**/
+		class State {
+			public:
+				DBHeader header;
+				BlobTree tree;
+		};
+
+		static const char *magic;
+
+		/**
+		Open history file name and read the list of all generations.
+		If state is nonnull, generations up to number last are applied.
+		A missing or empty file has no generations.
+		**/
+		bool read_history(const char *name, Generations::size_type last, Generations *generations, State *state, std::string *errtext) ATTRIBUTE_NONNULL((2, 4, 6));
+
+		bool read_generation(Generation *generation, State *state, std::string *errtext) ATTRIBUTE_NONNULL((2, 4));
+
+		/**
+		Encode all packages of tree against the (growing) hashes of state,
+		mapping the overlay keys of tree with overlay_map
+		**/
+		bool encode_tree(BlobTree *encoded, State *state, const PackageTree& tree, const std::vector<ExtendedVersion::Overlay>& overlay_map, std::string *errtext) ATTRIBUTE_NONNULL((2, 3, 6));
+
+		/**
+		Write a generation: Blobs with empty data are unchanged
+		**/
+		bool write_generation(const Generation& generation, State *state, const BlobTree& changes, const WordVec& removed_categories, const std::vector<StringHash::size_type>& old_sizes, ExtendedVersion::Overlay old_overlays, std::string *errtext) ATTRIBUTE_NONNULL((3, 8));
+
+		/**
+		Read the whole (temporary) file
+		**/
+		bool read_all(std::string *data, std::string *errtext) ATTRIBUTE_NONNULL((2, 3));
+
+		static bool open_error(const char *name, const char *mode, std::string *errtext) ATTRIBUTE_NONNULL_;
+};
+
+#endif  // SRC_DATABASE_HISTORY_H_
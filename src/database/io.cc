@@ -52,6 +52,22 @@ bool File::openwrite(const char *name) {
 	return true;
 }
 
+bool File::openappend(const char *name) {
+	if((fp = fopen(name, "ab")) == NULLPTR) {
+		return false;
+	}
+#ifdef HAVE_FILENO
+#ifdef HAVE_FLOCK
+	flock(fileno(fp), LOCK_EX);
+#endif
+#endif
+	return true;
+}
+
+bool File::opentemp() {
+	return ((fp = tmpfile()) != NULLPTR);
+}
+
 File::~File() {
 	if(unlikely(fp == NULLPTR)) {
 		return;
@@ -155,9 +171,8 @@ bool Database::read_string(string *s, string *errtext) {
 		return false;
 	}
 	eix::auto_list<char> buf(new char[len + 1]);
-	buf.get()[len] = 0;
 	if(likely(read_string_plain(buf.get(), len, errtext))) {
-		*s = buf.get();
+		s->assign(buf.get(), len);
 		return true;
 	}
 	return false;
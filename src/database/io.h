@@ -22,6 +22,7 @@
 // include "portage/basicversion.h" This comment satisfies check_include script
 
 class BasicPart;
+class Category;
 class DBHeader;
 class IUseSet;
 class Package;
@@ -46,6 +47,12 @@ class File {
 
 		bool openread(const char *name) ATTRIBUTE_NONNULL_;
 		bool openwrite(const char *name) ATTRIBUTE_NONNULL_;
+		bool openappend(const char *name) ATTRIBUTE_NONNULL_;
+
+		/**
+		Open an anonymous temporary file for reading and writing
+		**/
+		bool opentemp();
 
 		int getch() {
 			return fgetc(fp);
@@ -74,6 +81,10 @@ class File {
 			return seek(offset, SEEK_SET, errtext);
 		}
 
+		bool seekend(std::string *errtext) {
+			return seek(0, SEEK_END, errtext);
+		}
+
 		eix::OffsetType tell();
 
 		void readError(std::string *errtext);
@@ -81,6 +92,7 @@ class File {
 };
 
 class Database : public File {
+		friend class NamesIndex;
 		friend class PackageReader;
 
 	private:
@@ -133,8 +145,43 @@ class Database : public File {
 
 		bool read_iuse(const StringHash& hash, IUseSet *iuse, std::string *errtext) ATTRIBUTE_NONNULL((3));
 
-		bool read_version(Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
-		bool write_version(const Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
+		/**
+		Read EAPI, masks, properties, restrictions and keywords of a version
+		**/
+		bool read_version_masks(Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
+
+		/**
+		Read version string, slot and overlay key of a version
+		**/
+		bool read_version_ident(Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
+
+		/**
+		Read the data of a version up to the overlay key; this suffices
+		to calculate masks and stability
+		**/
+		bool read_version_basic(Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2)) {
+			return (likely(read_version_masks(v, hdr, errtext)) &&
+				likely(read_version_ident(v, hdr, errtext)));
+		}
+
+		/**
+		Read the remaining data (IUSE, REQUIRED_USE, dependencies)
+		**/
+		bool read_version_details(Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
+		bool skip_version_details(const DBHeader& hdr, std::string *errtext);
+
+		bool read_version(Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2)) {
+			return (likely(read_version_basic(v, hdr, errtext)) &&
+				likely(read_version_details(v, hdr, errtext)));
+		}
+		bool write_version_masks(const Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
+		bool write_version_ident(const Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
+		bool write_version_details(const Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
+		bool write_version(const Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2)) {
+			return (likely(write_version_masks(v, hdr, errtext)) &&
+				likely(write_version_ident(v, hdr, errtext)) &&
+				likely(write_version_details(v, hdr, errtext)));
+		}
 
 		bool read_depend(Depend *dep, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
 		bool write_depend(const Depend& dep, const DBHeader& hdr, std::string *errtext);
@@ -145,6 +192,23 @@ class Database : public File {
 		bool write_package(const Package& pkg, const DBHeader& hdr, std::string *errtext);
 		bool write_package_pure(const Package& pkg, const DBHeader& hdr, std::string *errtext);
 
+		/**
+		Write all data of a package but its name
+		**/
+		bool write_package_data(const Package& pkg, const DBHeader& hdr, std::string *errtext);
+
+		/**
+		For the split layout: Write the versions, slots and overlay keys
+		of a package (the hot data) ...
+		**/
+		bool write_package_hot(const Package& pkg, const DBHeader& hdr, std::string *errtext);
+
+		/**
+		... and all other data of a package but its name (the cold data)
+		**/
+		bool write_package_cold(const Package& pkg, const DBHeader& hdr, std::string *errtext);
+		bool write_category_cold(const Category& cat, const DBHeader& hdr, std::string *errtext);
+
 		bool write_hash(const StringHash& hash, std::string *errtext);
 		bool read_hash(StringHash *hash, std::string *errtext) ATTRIBUTE_NONNULL((2));
 
@@ -154,6 +218,12 @@ class Database : public File {
 
 		static void prep_header_hashs(DBHeader *hdr, const PackageTree& tree) ATTRIBUTE_NONNULL_;
 
+		/**
+		Read only the magic and the version of the header
+		@return true if the version is accepted
+		**/
+		bool read_version(DBHeader *hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
+
 		bool write_header(const DBHeader& hdr, std::string *errtext);
 		bool read_header(DBHeader *hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
 
@@ -30,7 +30,7 @@
 using std::string;
 using std::vector;
 
-bool Database::read_header(DBHeader *hdr, string *errtext) {
+bool Database::read_version(DBHeader *hdr, string *errtext) {
 	size_t magic_len(strlen(DBHeader::magic));
 	eix::auto_list<char> buf(new char[magic_len + 1]);
 	buf.get()[magic_len] = 0;
@@ -55,6 +55,13 @@ GCC_DIAG_ON(sign-conversion)
 		}
 		return false;
 	}
+	return true;
+}
+
+bool Database::read_header(DBHeader *hdr, string *errtext) {
+	if(unlikely(!read_version(hdr, errtext))) {
+		return false;
+	}
 
 	if(unlikely(!read_num(&(hdr->size), errtext))) {
 		return false;
@@ -111,6 +118,8 @@ GCC_DIAG_ON(sign-conversion)
 		return false;
 	}
 	hdr->use_required_use = ((save_bitmask & DBHeader::SAVE_BITMASK_REQUIRED_USE) != 0);
+	hdr->names_first = ((save_bitmask & DBHeader::SAVE_BITMASK_SPLIT) != 0);
+	hdr->names_index = ((save_bitmask & DBHeader::SAVE_BITMASK_INDEX) != 0);
 	if((hdr->use_depend = ((save_bitmask & DBHeader::SAVE_BITMASK_DEP) != 0))) {
 		eix::OffsetType len;
 		if(unlikely(!read_num(&len, errtext))) {
@@ -8,9 +8,11 @@
 #include <config.h>
 
 #include <string>
+#include <vector>
 
 #include "database/header.h"
 #include "database/io.h"
+#include "database/names_index.h"
 #include "database/package_reader.h"
 #include "eixTk/auto_list.h"
 #include "eixTk/diagnostics.h"
@@ -80,7 +82,7 @@ bool Database::read_iuse(const StringHash& hash, IUseSet *iuse, string *errtext)
 	return true;
 }
 
-bool Database::read_version(Version *v, const DBHeader& hdr, string *errtext) {
+bool Database::read_version_masks(Version *v, const DBHeader& hdr, string *errtext) {
 	// read EAPI
 	if(likely(hdr.version >= 36)) {
 		string eapi;
@@ -103,10 +105,10 @@ bool Database::read_version(Version *v, const DBHeader& hdr, string *errtext) {
 	if(unlikely(!read_num(&(v->restrictFlags), errtext))) {
 		return false;
 	}
-	if(unlikely(!read_hash_words(hdr.keywords_hash, &(v->full_keywords), errtext))) {
-		return false;
-	}
+	return read_hash_words(hdr.keywords_hash, &(v->full_keywords), errtext);
+}
 
+bool Database::read_version_ident(Version *v, const DBHeader& hdr, string *errtext) {
 	// read primary version part
 	BasicVersion::PartsType::size_type i;
 	if(unlikely(!read_num(&i, errtext))) {
@@ -131,7 +133,10 @@ bool Database::read_version(Version *v, const DBHeader& hdr, string *errtext) {
 	const OverlayIdent& overlay(hdr.getOverlay(v->overlay_key));
 	v->reponame = overlay.label;
 	v->priority = overlay.priority;
+	return true;
+}
 
+bool Database::read_version_details(Version *v, const DBHeader& hdr, string *errtext) {
 	if(unlikely(!read_iuse(hdr.iuse_hash, &(v->iuse), errtext))) {
 		return false;
 	}
@@ -156,6 +161,29 @@ bool Database::read_version(Version *v, const DBHeader& hdr, string *errtext) {
 	return true;
 }
 
+bool Database::skip_version_details(const DBHeader& hdr, string *errtext) {
+	if(unlikely(!read_hash_words(errtext))) {  // IUSE
+		return false;
+	}
+	if(hdr.use_required_use) {
+		if(unlikely(!read_hash_words(errtext))) {
+			return false;
+		}
+	}
+	if(hdr.use_depend) {
+		string::size_type len;
+		if(unlikely(!read_num(&len, errtext))) {
+			return false;
+		}
+GCC_DIAG_OFF(sign-conversion)
+		if(unlikely(!seekrel(len, errtext))) {
+			return false;
+		}
+GCC_DIAG_ON(sign-conversion)
+	}
+	return true;
+}
+
 bool Database::write_Part(const BasicPart& n, string *errtext) {
 	const string& content(n.partcontent);
 	if(unlikely(!write_num(content.size()*BasicPart::max_type + string::size_type(n.parttype), errtext))) {
@@ -169,7 +197,7 @@ bool Database::write_Part(const BasicPart& n, string *errtext) {
 	return true;
 }
 
-bool Database::write_version(const Version *v, const DBHeader& hdr, string *errtext) {
+bool Database::write_version_masks(const Version *v, const DBHeader& hdr, string *errtext) {
 	// write EAPI
 	if(unlikely(!write_hash_string(hdr.eapi_hash, v->eapi.get(), errtext))) {
 		return false;
@@ -187,10 +215,10 @@ bool Database::write_version(const Version *v, const DBHeader& hdr, string *errt
 	}
 
 	// write full keywords
-	if(unlikely(!write_hash_words(hdr.keywords_hash, v->get_full_keywords(), errtext))) {
-		return false;
-	}
+	return write_hash_words(hdr.keywords_hash, v->get_full_keywords(), errtext);
+}
 
+bool Database::write_version_ident(const Version *v, const DBHeader& hdr, string *errtext) {
 	// write m_primsplit
 	if(unlikely(!write_num(v->m_parts.size(), errtext))) {
 		return false;
@@ -206,9 +234,10 @@ bool Database::write_version(const Version *v, const DBHeader& hdr, string *errt
 	if(unlikely(!write_hash_string(hdr.slot_hash, v->get_shortfullslot(), errtext))) {
 		return false;
 	}
-	if(unlikely(!write_num(v->overlay_key, errtext))) {
-		return false;
-	}
+	return write_num(v->overlay_key, errtext);
+}
+
+bool Database::write_version_details(const Version *v, const DBHeader& hdr, string *errtext) {
 	if(unlikely(!write_hash_words(hdr.iuse_hash, v->iuse.asVector(), errtext))) {
 		return false;
 	}
@@ -276,9 +305,11 @@ bool Database::write_category_header(const string& name, eix::Treesize size, str
 }
 
 bool Database::write_package_pure(const Package& pkg, const DBHeader& hdr, string *errtext) {
-	if(unlikely(!write_string(pkg.name, errtext))) {
-		return false;
-	}
+	return (likely(write_string(pkg.name, errtext)) &&
+		likely(write_package_data(pkg, hdr, errtext)));
+}
+
+bool Database::write_package_data(const Package& pkg, const DBHeader& hdr, string *errtext) {
 	if(unlikely(!write_string(pkg.desc, errtext))) {
 		return false;
 	}
@@ -302,6 +333,46 @@ bool Database::write_package_pure(const Package& pkg, const DBHeader& hdr, strin
 	return true;
 }
 
+bool Database::write_package_hot(const Package& pkg, const DBHeader& hdr, string *errtext) {
+	if(unlikely(!write_num(pkg.size(), errtext))) {
+		return false;
+	}
+	for(Package::const_iterator i(pkg.begin()); likely(i != pkg.end()); ++i) {
+		if(unlikely(!write_version_ident(*i, hdr, errtext))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Database::write_package_cold(const Package& pkg, const DBHeader& hdr, string *errtext) {
+	if(unlikely(!write_string(pkg.desc, errtext))) {
+		return false;
+	}
+	if(unlikely(!write_string(pkg.homepage, errtext))) {
+		return false;
+	}
+	if(unlikely(!write_hash_string(hdr.license_hash, pkg.licenses, errtext))) {
+		return false;
+	}
+	for(Package::const_iterator i(pkg.begin()); likely(i != pkg.end()); ++i) {
+		if(unlikely(!write_version_masks(*i, hdr, errtext)) ||
+			unlikely(!write_version_details(*i, hdr, errtext))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Database::write_category_cold(const Category& cat, const DBHeader& hdr, string *errtext) {
+	for(Category::const_iterator p(cat.begin()); likely(p != cat.end()); ++p) {
+		if(unlikely(!write_package_cold(**p, hdr, errtext))) {
+			return false;
+		}
+	}
+	return true;
+}
+
 bool Database::write_package(const Package& pkg, const DBHeader& hdr, string *errtext) {
 	WRITE_COUNTER(write_package_pure(pkg, hdr, NULLPTR));
 	return write_package_pure(pkg, hdr, errtext);
@@ -421,6 +492,12 @@ bool Database::write_header(const DBHeader& hdr, string *errtext) {
 	if(hdr.use_required_use) {
 		save_bitmask |= DBHeader::SAVE_BITMASK_REQUIRED_USE;
 	}
+	if(hdr.names_first) {
+		save_bitmask |= DBHeader::SAVE_BITMASK_SPLIT;
+	}
+	if(hdr.names_index) {
+		save_bitmask |= DBHeader::SAVE_BITMASK_INDEX;
+	}
 	if(unlikely(!write_num(save_bitmask, errtext))) {
 		return false;
 	}
@@ -432,21 +509,80 @@ bool Database::write_header(const DBHeader& hdr, string *errtext) {
 }
 
 bool Database::write_packagetree(const PackageTree& tree, const DBHeader& hdr, string *errtext) {
+	NamesIndex index;
 	for(PackageTree::const_iterator c(tree.begin()); likely(c != tree.end()); ++c) {
 		Category *ci(c->second);
+		if(hdr.names_index) {
+			index.add_category(c->first, tell());
+		}
 		// Write category-header followed by a list of the packages.
 		if(unlikely(!write_category_header(c->first, eix::Treesize(ci->size()), errtext))) {
 			return false;
 		}
 
+		if(!hdr.names_first) {
+			for(Category::iterator p(ci->begin()); likely(p != ci->end()); ++p) {
+				if(!hdr.names_index) {
+					// write package to fp
+					if(unlikely(!write_package(**p, hdr, errtext))) {
+						return false;
+					}
+					continue;
+				}
+				// As write_package(), but the index needs the offset of the data
+				WRITE_COUNTER(write_package_pure(**p, hdr, NULLPTR));
+				if(unlikely(!write_string(p->name, errtext))) {
+					return false;
+				}
+				index.add_package(c->first, p->name, tell());
+				if(hdr.use_depend) {
+					index.add_depends(**p, tell());
+				}
+				if(unlikely(!write_package_data(**p, hdr, errtext))) {
+					return false;
+				}
+			}
+			continue;
+		}
+
+		// Split layout: First the cold data of all packages (with their
+		// total length, so that readers can skip them), then for each
+		// package its name, the distance back to its cold data, and the
+		// hot data (with their length)
+		WRITE_COUNTER(write_category_cold(*ci, hdr, NULLPTR));
+		std::vector<eix::OffsetType> cold;
+		cold.reserve(ci->size());
 		for(Category::iterator p(ci->begin()); likely(p != ci->end()); ++p) {
-			// write package to fp
-			if(unlikely(!write_package(**p, hdr, errtext))) {
+			cold.push_back(tell());
+			if(unlikely(!write_package_cold(**p, hdr, errtext))) {
+				return false;
+			}
+		}
+		std::vector<eix::OffsetType>::const_iterator it(cold.begin());
+		for(Category::iterator p(ci->begin()); likely(p != ci->end()); ++p, ++it) {
+			if(unlikely(!write_string(p->name, errtext))) {
+				return false;
+			}
+			eix::OffsetType hot(tell());
+			if(hdr.names_index) {
+				index.add_package(c->first, p->name, hot);
+				if(hdr.use_depend) {
+					index.add_depends(**p, hot);
+				}
+			}
+			if(unlikely(!write_num(hot - *it, errtext))) {
+				return false;
+			}
+			WRITE_COUNTER(write_package_hot(**p, hdr, NULLPTR));
+			if(unlikely(!write_package_hot(**p, hdr, errtext))) {
 				return false;
 			}
 		}
 	}
-	return true;
+	if(!hdr.names_index) {
+		return true;
+	}
+	return index.write(this, errtext);
 }
 
 bool Database::read_packagetree(PackageTree *tree, const DBHeader& hdr, PortageSettings *ps, string *errtext) {
@@ -0,0 +1,364 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <cstring>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "database/header.h"
+#include "database/io.h"
+#include "database/names_index.h"
+#include "eixTk/eixint.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/stringtypes.h"
+#include "portage/depend.h"
+#include "portage/package.h"
+#include "portage/version.h"
+
+using std::string;
+using std::vector;
+
+/**
+Number of keys per block; only the first key of a block is stored fully
+**/
+static const eix::OffsetType block_size = 16;
+
+/**
+The table has fixed-width offsets of the blocks relative to the table;
+the trailer has the fixed-width offset and the number of blocks of the
+table of each dictionary and the number of dictionaries, followed by the magic
+**/
+static const unsigned int table_width = 4;
+static const unsigned int trailer_width = 8;
+static const char trailer_magic[] = "eixnames";
+static const eix::OffsetType trailer_size =
+	(((2 * NamesIndex::DICTIONARIES) + 1) * trailer_width) + (sizeof(trailer_magic) - 1);
+
+static void append_fixed(string *s, eix::OffsetType value, unsigned int width) ATTRIBUTE_NONNULL_;
+static void append_fixed(string *s, eix::OffsetType value, unsigned int width) {
+	while(width != 0) {
+		--width;
+		s->append(1, static_cast<char>((value >> (8 * width)) & 0xFF));
+	}
+}
+
+static eix::OffsetType get_fixed(const char *s, unsigned int width) ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+static eix::OffsetType get_fixed(const char *s, unsigned int width) {
+	eix::OffsetType value(0);
+	for(; width != 0; --width) {
+		value = (value << 8) | static_cast<eix::OffsetType>(static_cast<eix::UChar>(*(s++)));
+	}
+	return value;
+}
+
+void NamesIndex::add_category(const string& category, eix::OffsetType offset) {
+	m_entries[SHORT].push_back(Entry(category + "/", offset));
+}
+
+void NamesIndex::add_package(const string& category, const string& name, eix::OffsetType offset) {
+	m_entries[FULL].push_back(Entry(category + "/" + name, offset));
+	m_entries[SHORT].push_back(Entry(name, offset));
+}
+
+void NamesIndex::add_depends(const Package& package, eix::OffsetType offset) {
+	WordSet names[DICTIONARIES];
+	for(Package::const_iterator it(package.begin()); likely(it != package.end()); ++it) {
+		const Depend& dep(it->depend);
+		Depend::insert_names(&names[DEPEND], dep.get_depend());
+		Depend::insert_names(&names[RDEPEND], dep.get_rdepend());
+		Depend::insert_names(&names[PDEPEND], dep.get_pdepend());
+		Depend::insert_names(&names[HDEPEND], dep.get_hdepend());
+	}
+	string suffix(" " + package.category + "/" + package.name);
+	for(unsigned int i(DEPEND); likely(i != DICTIONARIES); ++i) {
+		for(WordSet::const_iterator it(names[i].begin()); likely(it != names[i].end()); ++it) {
+			m_entries[i].push_back(Entry(*it + suffix, offset));
+		}
+	}
+}
+
+bool NamesIndex::write(Database *db, string *errtext) {
+	string trailer;
+	for(unsigned int i(0); likely(i != DICTIONARIES); ++i) {
+		Dictionary dict(static_cast<Dictionary>(i));
+		if(unlikely(!write_dictionary(db, dict, errtext))) {
+			return false;
+		}
+		append_fixed(&trailer, m_table[dict], trailer_width);
+		append_fixed(&trailer, m_blocks[dict], trailer_width);
+	}
+	append_fixed(&trailer, DICTIONARIES, trailer_width);
+	trailer.append(trailer_magic);
+	if(unlikely(!db->write(trailer))) {
+		File::writeError(errtext);
+		return false;
+	}
+	return true;
+}
+
+bool NamesIndex::write_dictionary(Database *db, Dictionary dict, string *errtext) {
+	Entries& entries(m_entries[dict]);
+	std::sort(entries.begin(), entries.end());
+	vector<eix::OffsetType> blocks;
+	for(Entries::size_type i(0); likely(i != entries.size()); ++i) {
+		const string& key(entries[i].first);
+		string::size_type common(0);
+		if((i % block_size) == 0) {
+			blocks.push_back(db->tell());
+			if(unlikely(!db->write_num(std::min(Entries::size_type(block_size), entries.size() - i), errtext))) {
+				return false;
+			}
+		} else {
+			const string& previous(entries[i - 1].first);
+			for(; (common != key.size()) && (common != previous.size()) &&
+				(key[common] == previous[common]); ++common) {
+			}
+		}
+		if(unlikely(!db->write_num(common, errtext)) ||
+			unlikely(!db->write_string(key.substr(common), errtext)) ||
+			unlikely(!db->write_num(entries[i].second, errtext))) {
+			return false;
+		}
+	}
+	m_table[dict] = db->tell();
+	m_blocks[dict] = eix::OffsetType(blocks.size());
+	string table;
+	for(vector<eix::OffsetType>::const_iterator it(blocks.begin());
+		likely(it != blocks.end()); ++it) {
+		append_fixed(&table, m_table[dict] - *it, table_width);
+	}
+	Entries().swap(entries);
+	if(unlikely(!db->write(table))) {
+		File::writeError(errtext);
+		return false;
+	}
+	return true;
+}
+
+bool NamesIndex::read_trailer(Database *db) {
+	DBHeader header;
+	if(unlikely(!db->seekabs(0, NULLPTR)) || !db->read_version(&header, NULLPTR) ||
+		unlikely(!db->seekend(NULLPTR))) {
+		return false;
+	}
+	eix::OffsetType size(db->tell());
+	if((size < trailer_size) || unlikely(!db->seekabs(size - trailer_size, NULLPTR))) {
+		return false;
+	}
+	char trailer[trailer_size];
+	if(unlikely(!db->read(trailer, trailer_size)) ||
+		(std::strncmp(trailer + (trailer_size - (sizeof(trailer_magic) - 1)),
+			trailer_magic, sizeof(trailer_magic) - 1) != 0)) {
+		return false;
+	}
+	const char *p(trailer + (2 * trailer_width * DICTIONARIES));
+	if(get_fixed(p, trailer_width) != DICTIONARIES) {
+		return false;
+	}
+	// The tables must end before the trailer; compare unsigned numbers
+	// so that no overflow can occur
+	eix::UNumber limit(static_cast<eix::UNumber>(size - trailer_size));
+	p = trailer;
+	for(unsigned int i(0); likely(i != DICTIONARIES); ++i) {
+		m_table[i] = get_fixed(p, trailer_width);
+		p += trailer_width;
+		m_blocks[i] = get_fixed(p, trailer_width);
+		p += trailer_width;
+		eix::UNumber table(static_cast<eix::UNumber>(m_table[i]));
+		eix::UNumber blocks(static_cast<eix::UNumber>(m_blocks[i]));
+		if(unlikely(blocks > limit / table_width) ||
+			unlikely(table > limit - (blocks * table_width))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool NamesIndex::seek_block(Database *db, Dictionary dict, eix::OffsetType i, string *errtext) {
+	char offset[table_width];
+	if(unlikely(!db->seekabs(m_table[dict] + (i * table_width), errtext))) {
+		return false;
+	}
+	if(unlikely(!db->read(offset, table_width))) {
+		db->readError(errtext);
+		return false;
+	}
+	return db->seekabs(m_table[dict] - get_fixed(offset, table_width), errtext);
+}
+
+bool NamesIndex::read_first_key(Database *db, Dictionary dict, eix::OffsetType i, string *key, string *errtext) {
+	Entries::size_type count;
+	string::size_type common;
+	return (likely(seek_block(db, dict, i, errtext)) &&
+		likely(db->read_num(&count, errtext)) &&
+		likely(db->read_num(&common, errtext)) &&
+		likely(db->read_string(key, errtext)));
+}
+
+bool NamesIndex::search_blocks(Database *db, Dictionary dict, const string& prefix, eix::OffsetType high, eix::OffsetType *block, string *errtext) {
+	// Find the last block before high whose first key is smaller than prefix
+	eix::OffsetType low(*block);
+	string key;
+	while(high - low > 1) {
+		eix::OffsetType middle(low + (high - low) / 2);
+		if(unlikely(!read_first_key(db, dict, middle, &key, errtext))) {
+			return false;
+		}
+		if(key < prefix) {
+			low = middle;
+		} else {
+			high = middle;
+		}
+	}
+	*block = low;
+	return seek_block(db, dict, low, errtext);
+}
+
+bool NamesIndex::seek_first(Database *db, Dictionary dict, const string& prefix, eix::OffsetType *block, string *errtext) {
+	*block = 0;
+	return search_blocks(db, dict, prefix, m_blocks[dict], block, errtext);
+}
+
+bool NamesIndex::seek_next(Database *db, Dictionary dict, const string& prefix, eix::OffsetType *block, string *errtext) {
+	// Double the step until a block is too far, then search in between
+	string key;
+	for(eix::OffsetType step(1); ; step *= 2) {
+		eix::OffsetType next(*block + step);
+		if(next >= m_blocks[dict]) {
+			return search_blocks(db, dict, prefix, m_blocks[dict], block, errtext);
+		}
+		if(unlikely(!read_first_key(db, dict, next, &key, errtext))) {
+			return false;
+		}
+		if(!(key < prefix)) {
+			return search_blocks(db, dict, prefix, next, block, errtext);
+		}
+		*block = next;
+	}
+}
+
+bool NamesIndex::read_key(Database *db, string *key, eix::OffsetType *offset, string *errtext) {
+	string::size_type common;
+	string rest;
+	if(unlikely(!db->read_num(&common, errtext)) ||
+		unlikely(!db->read_string(&rest, errtext)) ||
+		unlikely(!db->read_num(offset, errtext))) {
+		return false;
+	}
+	if(unlikely(common > key->size())) {
+		db->readError(errtext);
+		return false;
+	}
+	key->erase(common);
+	key->append(rest);
+	return true;
+}
+
+bool NamesIndex::find(Database *db, Dictionary dict, const string& prefix, Entries *entries, string *errtext) {
+	eix::OffsetType block;
+	if(unlikely(m_blocks[dict] == 0)) {
+		return true;
+	}
+	if(unlikely(!seek_first(db, dict, prefix, &block, errtext))) {
+		return false;
+	}
+
+	// The blocks are contiguous, so read on until a key is too large
+	string key;
+	for(; likely(block != m_blocks[dict]); ++block) {
+		Entries::size_type count;
+		if(unlikely(!db->read_num(&count, errtext))) {
+			return false;
+		}
+		for(; likely(count != 0); --count) {
+			eix::OffsetType offset;
+			if(unlikely(!read_key(db, &key, &offset, errtext))) {
+				return false;
+			}
+			int c(key.compare(0, prefix.size(), prefix));
+			if(c > 0) {
+				return true;
+			}
+			if(c == 0) {
+				entries->push_back(Entry(key, offset));
+			}
+		}
+	}
+	return true;
+}
+
+bool NamesIndex::find_categories(Database *db, const string& name, WordVec *keys, string *errtext) {
+	Entries entries;
+	if(unlikely(!find(db, SHORT, "", &entries, errtext))) {
+		return false;
+	}
+	// The data of a package follow the header of its category
+	typedef std::map<eix::OffsetType, string> Categories;
+	Categories categories;
+	vector<eix::OffsetType> packages;
+	for(Entries::const_iterator it(entries.begin()); likely(it != entries.end()); ++it) {
+		const string& key(it->first);
+		if(key == name) {
+			packages.push_back(it->second);
+		} else if(!key.empty() && (key[key.size() - 1] == '/')) {
+			categories[it->second] = key;
+		}
+	}
+	for(vector<eix::OffsetType>::const_iterator it(packages.begin());
+		likely(it != packages.end()); ++it) {
+		Categories::const_iterator c(categories.upper_bound(*it));
+		if(likely(c != categories.begin())) {
+			keys->push_back((--c)->second + name);
+		}
+	}
+	return true;
+}
+
+bool NamesIndex::find_keys(Database *db, Dictionary dict, const WordVec& keys, Entries *entries, string *errtext) {
+	if(unlikely(keys.empty()) || unlikely(m_blocks[dict] == 0)) {
+		return true;
+	}
+
+	// Merge the sorted keys with the blocks, skipping to the block
+	// of the next key after each block
+	WordVec::const_iterator it(keys.begin());
+	eix::OffsetType block(0);
+	string key;
+	for(;;) {
+		Entries::size_type count;
+		if(unlikely(!seek_next(db, dict, *it, &block, errtext)) ||
+			unlikely(!db->read_num(&count, errtext))) {
+			return false;
+		}
+		for(; likely(count != 0); --count) {
+			eix::OffsetType offset;
+			if(unlikely(!read_key(db, &key, &offset, errtext))) {
+				return false;
+			}
+			for(; *it < key; ++it) {
+				if(it + 1 == keys.end()) {
+					return true;
+				}
+			}
+			if(*it == key) {
+				entries->push_back(Entry(key, offset));
+				if(++it == keys.end()) {
+					return true;
+				}
+			}
+		}
+		if(++block == m_blocks[dict]) {
+			return true;
+		}
+	}
+}
@@ -0,0 +1,139 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_DATABASE_NAMES_INDEX_H_
+#define SRC_DATABASE_NAMES_INDEX_H_ 1
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "eixTk/eixint.h"
+#include "eixTk/stringtypes.h"
+
+class Database;
+class Package;
+
+/**
+Sorted dictionaries of the package names (and of the packages referenced
+by dependencies) which eix-update appends to the database after the
+categories. Each dictionary consists of blocks of
+front-coded keys with a table of fixed-width block offsets, so that the keys
+with a given prefix are found by a binary search which reads only a few
+blocks, independent of the size of the tree.
+**/
+class NamesIndex {
+	public:
+		/**
+		FULL contains category/name; SHORT contains the bare names and
+		the categories with a trailing slash.
+		DEPEND, ..., HDEPEND contain "dependency package" for each
+		category/name of a dependency and each package which has a
+		version with this dependency.
+		**/
+		enum Dictionary {
+			FULL = 0,
+			SHORT,
+			DEPEND,
+			RDEPEND,
+			PDEPEND,
+			HDEPEND,
+			DICTIONARIES
+		};
+
+		/**
+		A key and the file offset of the data of its package (for
+		categories, of the category header)
+		**/
+		typedef std::pair<std::string, eix::OffsetType> Entry;
+		typedef std::vector<Entry> Entries;
+
+		NamesIndex() {
+			for(unsigned int i(0); i != DICTIONARIES; ++i) {
+				m_table[i] = m_blocks[i] = 0;
+			}
+		}
+
+		void add_category(const std::string& category, eix::OffsetType offset);
+
+		void add_package(const std::string& category, const std::string& name, eix::OffsetType offset);
+
+		/**
+		Add the dependencies of all versions of package
+		**/
+		void add_depends(const Package& package, eix::OffsetType offset);
+
+		/**
+		Sort what was added and append the dictionaries and the trailer
+		**/
+		bool write(Database *db, std::string *errtext) ATTRIBUTE_NONNULL((2));
+
+		/**
+		Read the trailer of a database of the current format
+		@return false if the database has no index
+		**/
+		bool read_trailer(Database *db) ATTRIBUTE_NONNULL_;
+
+		/**
+		Append all entries of dict whose key starts with prefix, sorted
+		**/
+		bool find(Database *db, Dictionary dict, const std::string& prefix, Entries *entries, std::string *errtext) ATTRIBUTE_NONNULL((2, 5));
+
+		/**
+		Append category/name of all packages with the bare name,
+		using the offsets of packages and categories in SHORT
+		**/
+		bool find_categories(Database *db, const std::string& name, WordVec *keys, std::string *errtext) ATTRIBUTE_NONNULL((2, 4, 5));
+
+		/**
+		Append the entries of dict whose key is one of the sorted keys;
+		only the blocks which can contain a key are read
+		**/
+		bool find_keys(Database *db, Dictionary dict, const WordVec& keys, Entries *entries, std::string *errtext) ATTRIBUTE_NONNULL((2, 5));
+
+	private:
+		Entries m_entries[DICTIONARIES];
+		eix::OffsetType m_table[DICTIONARIES], m_blocks[DICTIONARIES];
+
+		bool write_dictionary(Database *db, Dictionary dict, std::string *errtext) ATTRIBUTE_NONNULL((2));
+
+		/**
+		Seek to block i of dict
+		**/
+		bool seek_block(Database *db, Dictionary dict, eix::OffsetType i, std::string *errtext) ATTRIBUTE_NONNULL((2));
+
+		/**
+		Read the first key of block i of dict
+		**/
+		bool read_first_key(Database *db, Dictionary dict, eix::OffsetType i, std::string *key, std::string *errtext) ATTRIBUTE_NONNULL((2, 5));
+
+		/**
+		Binary search for the last block of dict from block on and before
+		high whose first key is smaller than prefix (or block itself);
+		seek to it and store its number in block
+		**/
+		bool search_blocks(Database *db, Dictionary dict, const std::string& prefix, eix::OffsetType high, eix::OffsetType *block, std::string *errtext) ATTRIBUTE_NONNULL((2, 6));
+
+		/**
+		Seek to the last block of dict whose first key is smaller than
+		prefix (or to the first block) and store its number in block
+		**/
+		bool seek_first(Database *db, Dictionary dict, const std::string& prefix, eix::OffsetType *block, std::string *errtext) ATTRIBUTE_NONNULL((2, 5));
+
+		/**
+		As seek_first(), but search only from block on, with steps of
+		doubling size: Nearby blocks are found with few reads
+		**/
+		bool seek_next(Database *db, Dictionary dict, const std::string& prefix, eix::OffsetType *block, std::string *errtext) ATTRIBUTE_NONNULL((2, 5));
+
+		/**
+		Read the next front-coded key of a block into key
+		**/
+		static bool read_key(Database *db, std::string *key, eix::OffsetType *offset, std::string *errtext) ATTRIBUTE_NONNULL((1, 2, 3));
+};
+
+#endif  // SRC_DATABASE_NAMES_INDEX_H_
@@ -9,23 +9,38 @@
 
 #include <config.h>
 
+#include <string>
+#include <vector>
+
 #include "database/io.h"
 #include "database/package_reader.h"
 #include "eixTk/eixint.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/stats.h"
+#include "eixTk/stringtypes.h"
 #include "portage/conf/portagesettings.h"
 #include "portage/package.h"
 #include "portage/version.h"
 
+using std::string;
+
 PackageReader::~PackageReader() {
 	delete m_pkg;
 }
 
 bool PackageReader::read(Attributes need) {
+	if(!m_names_first && (need == SLOTS)) {
+		// Versions are stored as a whole after the license
+		need = VERSIONS;
+	}
 	if(likely(m_have >= need)) {  // Already got this one
 		return true;
 	}
+	Stats::Timer timer("decode");
+	if(unlikely(Stats::enabled())) {
+		m_start = m_db->tell();
+	}
 
 	switch(m_have) {
 		case NONE:
@@ -36,6 +51,17 @@ bool PackageReader::read(Attributes need) {
 			if(unlikely(need == NAME))
 				break;
 		case NAME:
+			if(m_names_first) {
+				if(unlikely(!seekData(m_hot)) || unlikely(!readSlots())) {
+					return false;
+				}
+				if(need == SLOTS)
+					break;
+			}
+		case SLOTS:
+			if(m_names_first && unlikely(!seekData(m_cold))) {
+				return false;
+			}
 			if(unlikely(!m_db->read_string(&(m_pkg->desc), &m_errtext))) {
 				m_error = true;
 				return false;
@@ -57,39 +83,131 @@ bool PackageReader::read(Attributes need) {
 			if(unlikely(need == LICENSE))
 				break;
 		case LICENSE: {
-				eix::Versize i;
-				if(unlikely(!m_db->read_num(&i, &m_errtext))) {
-					m_error = true;
-					return false;
-				}
-				for(; likely(i != 0); --i) {
-					Version *v(new Version());
-					if(unlikely(!m_db->read_version(v, *header, &m_errtext))) {
+				bool details(need >= DETAILS);
+				m_details.clear();
+				if(m_names_first) {
+					// The versions are known from the hot data
+					for(std::vector<Version *>::const_iterator it(m_versions.begin());
+						likely(it != m_versions.end()); ++it) {
+						Version *v(*it);
+						if(unlikely(!m_db->read_version_masks(v, *header, &m_errtext))) {
+							m_error = true;
+							return false;
+						}
+						if(unlikely(!readDetails(v, details))) {
+							return false;
+						}
+						m_pkg->collect_iuse(v);
+					}
+					m_pkg->finalize_masks();
+				} else {
+					eix::Versize i;
+					if(unlikely(!m_db->read_num(&i, &m_errtext))) {
 						m_error = true;
 						return false;
 					}
-					m_pkg->addVersion(v);
+					for(; likely(i != 0); --i) {
+						Version *v(new Version());
+						if(unlikely(!m_db->read_version_basic(v, *header, &m_errtext))) {
+							m_error = true;
+							return false;
+						}
+						if(unlikely(!readDetails(v, details))) {
+							return false;
+						}
+						m_pkg->addVersion(v);
+					}
 				}
 			}
-			if(likely(m_portagesettings != NULLPTR)) {
-				m_portagesettings->calc_local_sets(m_pkg);
-				m_portagesettings->finalize(m_pkg);
-			} else {
-				m_pkg->finalize_masks();
+			Stats::count(Stats::PACKAGES_DECODED);
+			if(likely(m_masks)) {
+				if(likely(m_portagesettings != NULLPTR)) {
+					m_portagesettings->calc_local_sets(m_pkg);
+					m_portagesettings->finalize(m_pkg);
+				} else {
+					m_pkg->finalize_masks();
+				}
+				m_pkg->save_maskflags(Version::SAVEMASK_FILE);
 			}
-			m_pkg->save_maskflags(Version::SAVEMASK_FILE);
+			break;
+		case VERSIONS:
+			// Go back for the details; the last ones end with the package
+			for(DetailsOffsets::const_iterator it(m_details.begin());
+				likely(it != m_details.end()); ++it) {
+				if(unlikely(!seekData(it->second)) ||
+					unlikely(!m_db->read_version_details(it->first, *header, &m_errtext))) {
+					m_error = true;
+					return false;
+				}
+				m_pkg->collect_iuse(it->first);
+			}
+			m_details.clear();
 		default:
 		// case ALL:
 			break;
 	}
+	countBytes();
 	m_have = need;
 	return true;
 }
 
+bool PackageReader::readDetails(Version *v, bool details) {
+	if(details) {
+		if(unlikely(!m_db->read_version_details(v, *header, &m_errtext))) {
+			m_error = true;
+			return false;
+		}
+		return true;
+	}
+	m_details.push_back(DetailsOffsets::value_type(v, m_db->tell()));
+	if(unlikely(!m_db->skip_version_details(*header, &m_errtext))) {
+		m_error = true;
+		return false;
+	}
+	return true;
+}
+
+bool PackageReader::readSlots() {
+	eix::Versize i;
+	if(unlikely(!m_db->read_num(&i, &m_errtext))) {
+		m_error = true;
+		return false;
+	}
+	m_versions.clear();
+	for(; likely(i != 0); --i) {
+		Version *v(new Version());
+		if(unlikely(!m_db->read_version_ident(v, *header, &m_errtext))) {
+			m_error = true;
+			return false;
+		}
+		m_versions.push_back(v);
+		m_pkg->addVersion(v);
+	}
+	return true;
+}
+
+bool PackageReader::seekData(eix::OffsetType offset) {
+	countBytes();
+	if(unlikely(!m_db->seekabs(offset, &m_errtext))) {
+		m_error = true;
+		return false;
+	}
+	m_start = offset;
+	return true;
+}
+
+void PackageReader::countBytes() {
+	if(unlikely(Stats::enabled())) {
+		Stats::count(Stats::BYTES_READ, static_cast<eix::UNumber>(m_db->tell() - m_start));
+	}
+}
+
 bool PackageReader::skip() {
 	// only seek if needed
 	if(m_have != ALL) {
-		if(unlikely(!m_db->seekabs(m_next, &m_errtext))) {
+		Stats::count(Stats::PACKAGES_SKIPPED);
+		// In the split layout, read() seeks to the data of the package
+		if(!m_names_first && unlikely(!m_db->seekabs(m_next, &m_errtext))) {
 			m_error = true;
 			return false;
 		}
@@ -115,13 +233,25 @@ bool PackageReader::next() {
 		if(unlikely(m_frames-- == 0)) {
 			return false;
 		}
-		if(unlikely(!m_db->read_category_header(&m_cat_name, &m_cat_size, &m_errtext))) {
-			m_error = true;
+		if(unlikely(!readCategoryHeader())) {
 			return false;
 		}
 		return next();
 	}
+	return readPackageHeader();
+}
 
+bool PackageReader::readPackageHeader() {
+	delete m_pkg;
+	m_pkg = new Package;
+	m_pkg->category = m_cat_name;
+	if(m_names_first) {
+		m_pkg->name.swap(m_names[m_index]);
+		m_hot = m_hot_offsets[m_index];
+		m_cold = m_cold_offsets[m_index++];
+		m_have = NAME;
+		return true;
+	}
 	eix::OffsetType len;
 	if(unlikely(!m_db->read_num(&len, &m_errtext))) {
 		m_error = true;
@@ -129,23 +259,83 @@ bool PackageReader::next() {
 	}
 	m_next = m_db->tell() + len;
 	m_have = NONE;
+	return true;
+}
+
+bool PackageReader::seekPackage(const string& category, const string& name, eix::OffsetType offset) {
 	delete m_pkg;
-	m_pkg = new Package;
-	m_pkg->category = m_cat_name;
+	m_pkg = new Package(category, name);
+	m_have = NAME;
+	if(unlikely(!m_db->seekabs(offset, &m_errtext))) {
+		m_error = true;
+		return false;
+	}
+	if(!m_names_first) {
+		return true;
+	}
+	eix::OffsetType len;
+	return readPackageOffsets(&len);
+}
 
+bool PackageReader::readPackageOffsets(eix::OffsetType *len) {
+	eix::OffsetType pos(m_db->tell()), distance;
+	if(unlikely(!m_db->read_num(&distance, &m_errtext)) ||
+		unlikely(!m_db->read_num(len, &m_errtext))) {
+		m_error = true;
+		return false;
+	}
+	m_cold = pos - distance;
+	m_hot = m_db->tell();
 	return true;
 }
 
-bool PackageReader::nextCategory() {
-	if(unlikely(m_frames-- == 0)) {
+bool PackageReader::readCategoryHeader() {
+	if(m_names_first && (m_cat_end != 0) &&
+		unlikely(!m_db->seekabs(m_cat_end, &m_errtext))) {
+		m_error = true;
 		return false;
 	}
-
-	if(likely(m_db->read_category_header(&m_cat_name, &m_cat_size, &m_errtext))) {
+	if(unlikely(!m_db->read_category_header(&m_cat_name, &m_cat_size, &m_errtext))) {
+		m_error = true;
+		return false;
+	}
+	if(!m_names_first) {
 		return true;
 	}
-	m_error = true;
-	return false;
+	eix::OffsetType len;
+	if(unlikely(!m_db->read_num(&len, &m_errtext)) ||
+		unlikely(!m_db->seekrel(len, &m_errtext))) {
+		m_error = true;
+		return false;
+	}
+	m_names.resize(m_cat_size);
+	m_hot_offsets.resize(m_cat_size);
+	m_cold_offsets.resize(m_cat_size);
+	for(WordVec::size_type i(0); likely(i != m_cat_size); ++i) {
+		if(unlikely(!m_db->read_string(&(m_names[i]), &m_errtext))) {
+			m_error = true;
+			return false;
+		}
+		if(unlikely(!readPackageOffsets(&len))) {
+			return false;
+		}
+		m_hot_offsets[i] = m_hot;
+		m_cold_offsets[i] = m_cold;
+		if(unlikely(!m_db->seekrel(len, &m_errtext))) {
+			m_error = true;
+			return false;
+		}
+	}
+	m_cat_end = m_db->tell();
+	m_index = 0;
+	return true;
+}
+
+bool PackageReader::nextCategory() {
+	if(unlikely(m_frames-- == 0)) {
+		return false;
+	}
+	return readCategoryHeader();
 }
 
 bool PackageReader::nextPackage() {
@@ -156,14 +346,24 @@ bool PackageReader::nextPackage() {
 	/* Ignore the offset and read the whole package at once.
 	 */
 
-	eix::OffsetType dummy;
-	if(unlikely(!m_db->read_num(&dummy, &m_errtext))) {
-		m_error = true;
-		return false;
+	return (likely(readPackageHeader()) && likely(read(ALL)));
+}
+
+bool PackageReader::skipCategory() {
+	if(m_names_first) {
+		// readCategoryHeader() seeks to the end of the category
+		Stats::count(Stats::PACKAGES_SKIPPED, m_cat_size);
+		m_cat_size = 0;
+		return true;
 	}
-	m_have = NONE;
-	delete m_pkg;
-	m_pkg = new Package;
-	m_pkg->category = m_cat_name;
-	return read(ALL);
+	for(; likely(m_cat_size != 0); --m_cat_size) {
+		Stats::count(Stats::PACKAGES_SKIPPED);
+		eix::OffsetType len;
+		if(unlikely(!m_db->read_num(&len, &m_errtext)) ||
+			unlikely(!m_db->seekrel(len, &m_errtext))) {
+			m_error = true;
+			return false;
+		}
+	}
+	return true;
 }
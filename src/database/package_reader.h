@@ -14,25 +14,36 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "database/header.h"
 #include "eixTk/eixint.h"
 #include "eixTk/null.h"
+#include "eixTk/stringtypes.h"
 
 class Database;
 class DBHeader;
 class Package;
 class PortageSettings;
+class Version;
 
 /**
 Forward-iterate for packages stored in the cachefile
 **/
 class PackageReader {
 	public:
+		/**
+		SLOTS are the versions with only their slots and overlay keys;
+		only the split layout has them before DESCRIPTION (otherwise,
+		reading SLOTS means reading VERSIONS);
+		VERSIONS are all data needed for masks and stability;
+		DETAILS are additionally IUSE, REQUIRED_USE and dependencies
+		**/
 		enum Attributes {
 			NONE = 0,
-			NAME, DESCRIPTION, HOMEPAGE, LICENSE, VERSIONS,
-			ALL = 7
+			NAME, SLOTS, DESCRIPTION, HOMEPAGE, LICENSE, VERSIONS, DETAILS,
+			ALL = 8
 		};
 
 		/**
@@ -40,11 +51,19 @@ class PackageReader {
 		@arg ps is used to define the local package sets while version reading
 		**/
 		PackageReader(Database *db, const DBHeader& hdr, PortageSettings *ps)
-			: m_db(db), m_frames(hdr.size), m_cat_size(0), m_pkg(NULLPTR), header(&hdr), m_portagesettings(ps), m_error(false) {
+			: m_db(db), m_frames(hdr.size), m_cat_size(0), m_pkg(NULLPTR), header(&hdr), m_portagesettings(ps), m_masks(true), m_names_first(hdr.names_first), m_cat_end(0), m_error(false) {
 		}
 
 		PackageReader(Database *db, const DBHeader& hdr)
-			: m_db(db), m_frames(hdr.size), m_cat_size(0), m_pkg(NULLPTR), header(&hdr), m_portagesettings(NULLPTR), m_error(false) {
+			: m_db(db), m_frames(hdr.size), m_cat_size(0), m_pkg(NULLPTR), header(&hdr), m_portagesettings(NULLPTR), m_masks(true), m_names_first(hdr.names_first), m_cat_end(0), m_error(false) {
+		}
+
+		/**
+		Pass versions on as stored in the database:
+		No masks are calculated or saved when reading versions.
+		**/
+		void skip_masks() {
+			m_masks = false;
 		}
 
 		~PackageReader();
@@ -96,6 +115,20 @@ class PackageReader {
 		**/
 		bool nextPackage();
 
+		/**
+		Skip the remaining packages of the current category without
+		decoding them.
+		@return false on error
+		**/
+		bool skipCategory();
+
+		/**
+		Make the package category/name whose data start at offset
+		(as stored in the names index) the current package.
+		Afterwards, only read() or release() may be used.
+		**/
+		bool seekPackage(const std::string& category, const std::string& name, eix::OffsetType offset);
+
 		/**
 		@return name of current category
 		**/
@@ -120,9 +153,63 @@ class PackageReader {
 
 		const DBHeader   *header;
 		PortageSettings  *m_portagesettings;
+		bool              m_masks;
+
+		/**
+		The versions whose details were skipped, with the file offset
+		of their details
+		**/
+		typedef std::vector<std::pair<Version *, eix::OffsetType> > DetailsOffsets;
+		DetailsOffsets    m_details;
+
+		/**
+		For the split layout: The names of the current category and the
+		file offsets of their hot and cold data; the versions in the
+		order of the file while only their hot data are read
+		**/
+		bool              m_names_first;
+		WordVec           m_names;
+		std::vector<eix::OffsetType> m_hot_offsets, m_cold_offsets;
+		WordVec::size_type m_index;
+		eix::OffsetType   m_hot, m_cold, m_cat_end;
+		std::vector<Version *> m_versions;
 
 		std::string m_errtext;
 		bool m_error;
+
+		/**
+		Read the category header and, for the split layout, all names
+		**/
+		bool readCategoryHeader();
+
+		/**
+		Start reading the next package of the current category
+		**/
+		bool readPackageHeader();
+
+		/**
+		For the split layout: Set m_hot and m_cold for the package whose
+		hot record (after the name) starts at the current position.
+		@arg len is set to the length of the hot data
+		**/
+		bool readPackageOffsets(eix::OffsetType *len) ATTRIBUTE_NONNULL_;
+
+		/**
+		Read the details of v or remember their offset and skip them
+		**/
+		bool readDetails(Version *v, bool details) ATTRIBUTE_NONNULL_;
+
+		/**
+		For the split layout: Read the hot data of the versions
+		**/
+		bool readSlots();
+
+		/**
+		Seek to offset, counting the bytes read since m_start
+		**/
+		bool seekData(eix::OffsetType offset);
+		void countBytes();
+		eix::OffsetType   m_start;
 };
 
 #endif  // SRC_DATABASE_PACKAGE_READER_H_
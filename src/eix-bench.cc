@@ -0,0 +1,795 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <sys/time.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "database/header.h"
+#include "database/io.h"
+#include "eixTk/argsreader.h"
+#include "eixTk/eixint.h"
+#include "eixTk/formated.h"
+#include "eixTk/i18n.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/outputstring.h"
+#include "eixTk/parseerror.h"
+#include "eixTk/regexp.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/stringutils.h"
+#include "eixTk/unused.h"
+#include "eixTk/varsreader.h"
+#include "eixrc/eixrc.h"
+#include "eixrc/global.h"
+#include "main/main.h"
+#include "output/formatstring-print.h"
+#include "output/formatstring.h"
+#include "portage/basicversion.h"
+#include "portage/conf/portagesettings.h"
+#include "portage/depend.h"
+#include "portage/eapi.h"
+#include "portage/extendedversion.h"
+#include "portage/keywords.h"
+#include "portage/mask.h"
+#include "portage/mask_list.h"
+#include "portage/overlay.h"
+#include "portage/package.h"
+#include "portage/set_stability.h"
+#include "portage/vardbpkg.h"
+#include "portage/version.h"
+#include "search/algorithms.h"
+#include "search/levenshtein.h"
+
+using std::list;
+using std::string;
+using std::vector;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+#define VAR_DB_PKG "/var/db/pkg/"
+
+/**
+Results of the kernels are accumulated here so that no work is optimized away
+**/
+static volatile eix::UNumber bench_sink;
+
+/**
+A deterministic pseudo random generator, so that all runs see the same input
+**/
+class BenchRandom {
+	private:
+		eix::UNumber m_state;
+
+	public:
+		BenchRandom() : m_state(12345) {
+		}
+
+		/**
+		@return a number in [0, range)
+		**/
+		eix::UNumber next(eix::UNumber range) {
+			m_state = m_state * 1103515245U + 12345U;
+			return ((m_state >> 8) & 0xFFFFFFU) % range;
+		}
+
+		bool chance(eix::UNumber percent) {
+			return (next(100) < percent);
+		}
+
+		const char *pick(const char **list, eix::UNumber size) {
+			return list[next(size)];
+		}
+};
+
+static const char *bench_categories[] = {
+	"app-misc", "app-text", "dev-libs", "dev-python", "dev-util", "games-action",
+	"media-libs", "media-sound", "net-misc", "sys-apps", "sys-libs", "x11-libs"
+};
+
+static const char *bench_syllables[] = {
+	"lib", "gtk", "py", "qt", "font", "media", "util", "net", "x", "open",
+	"kde", "gnome", "tools", "core", "base", "perl", "ruby", "data", "mk", "z"
+};
+
+static const char *bench_arches[] = {
+	"alpha", "amd64", "arm", "arm64", "hppa", "ia64", "m68k", "mips",
+	"ppc", "ppc64", "riscv", "s390", "sparc", "x86", "amd64-linux", "x64-macos"
+};
+
+static const char *bench_suffixes[] = {
+	"_alpha", "_beta", "_pre", "_rc", "_p"
+};
+
+static const char *bench_useflags[] = {
+	"X", "+doc", "examples", "-gtk", "ipv6", "nls", "+ssl", "static-libs", "test",
+	"python_targets_python3_11", "python_targets_python3_12", "abi_x86_32"
+};
+
+#define BENCH_SIZE(a) (sizeof(a) / sizeof(*(a)))
+
+static string bench_name(BenchRandom *rnd) {
+	string r(rnd->pick(bench_syllables, BENCH_SIZE(bench_syllables)));
+	for(eix::UNumber i(rnd->next(3)); likely(i != 0); --i) {
+		if(rnd->chance(50)) {
+			r.append(1, '-');
+		}
+		r.append(rnd->pick(bench_syllables, BENCH_SIZE(bench_syllables)));
+	}
+	return r;
+}
+
+static string bench_version(BenchRandom *rnd) {
+	if(unlikely(rnd->chance(3))) {
+		return "9999";
+	}
+	string r(eix::format("%s") % rnd->next(30));
+	for(eix::UNumber i(rnd->next(4)); likely(i != 0); --i) {
+		r.append(eix::format(".%s") % rnd->next(rnd->chance(10) ? 20240000 : 20));
+	}
+	if(rnd->chance(10)) {
+		r.append(1, static_cast<char>('a' + rnd->next(6)));
+	}
+	if(rnd->chance(20)) {
+		r.append(rnd->pick(bench_suffixes, BENCH_SIZE(bench_suffixes)));
+		r.append(eix::format("%s") % rnd->next(10));
+	}
+	if(rnd->chance(30)) {
+		r.append(eix::format("-r%s") % (rnd->next(5) + 1));
+	}
+	return r;
+}
+
+static string bench_keywords(BenchRandom *rnd) {
+	string r;
+	if(unlikely(rnd->chance(5))) {
+		r = "-*";
+	}
+	for(eix::UNumber i(0); likely(i != BENCH_SIZE(bench_arches)); ++i) {
+		eix::UNumber c(rnd->next(10));
+		if(c < 4) {
+			continue;
+		}
+		if(!r.empty()) {
+			r.append(1, ' ');
+		}
+		if(c < 7) {
+			r.append(1, '~');
+		} else if(unlikely(c == 9)) {
+			r.append(1, '-');
+		}
+		r.append(bench_arches[i]);
+	}
+	return r;
+}
+
+static string bench_iuse(BenchRandom *rnd) {
+	string r;
+	for(eix::UNumber i(0); likely(i != BENCH_SIZE(bench_useflags)); ++i) {
+		if(rnd->chance(40)) {
+			if(!r.empty()) {
+				r.append(1, ' ');
+			}
+			r.append(bench_useflags[i]);
+		}
+	}
+	return r;
+}
+
+/**
+A kernel to be timed: prepare() generates the input, run() does ops
+operations (processing bytes bytes, if this is meaningful)
+**/
+class BenchKernel {
+	public:
+		const char *name;
+		eix::UNumber ops, bytes;
+
+		explicit BenchKernel(const char *n) : name(n), ops(0), bytes(0) {
+		}
+
+		virtual ~BenchKernel() {
+		}
+
+		virtual bool prepare(string *errtext) ATTRIBUTE_NONNULL_ = 0;
+
+		virtual eix::UNumber run() = 0;
+};
+
+class BenchVersionCompare : public BenchKernel {
+	private:
+		vector<BasicVersion> versions;
+
+	public:
+		BenchVersionCompare() : BenchKernel("BasicVersion::compare") {
+		}
+
+		bool prepare(string *errtext) ATTRIBUTE_NONNULL_ {
+			BenchRandom rnd;
+			versions.resize(4096);
+			for(vector<BasicVersion>::iterator it(versions.begin());
+				likely(it != versions.end()); ++it) {
+				if(unlikely(it->parseVersion(bench_version(&rnd), errtext) != BasicVersion::parsedOK)) {
+					return false;
+				}
+			}
+			ops = versions.size();
+			return true;
+		}
+
+		eix::UNumber run() {
+			eix::UNumber r(0);
+			vector<BasicVersion>::size_type n(versions.size());
+			for(vector<BasicVersion>::size_type i(0); likely(i != n); ++i) {
+				r += BasicVersion::compare(versions[i], versions[(7 * i + 1) % n]) + 1;
+			}
+			return r;
+		}
+};
+
+/**
+Gives access to the protected number coding of the database
+**/
+class BenchDatabase : public Database {
+	public:
+		using Database::read_num;
+		using Database::write_num;
+};
+
+class BenchReadNum : public BenchKernel {
+	private:
+		BenchDatabase db;
+		eix::UNumber count;
+
+	public:
+		BenchReadNum() : BenchKernel("Database::read_num") {
+		}
+
+		bool prepare(string *errtext) ATTRIBUTE_NONNULL_ {
+			if(unlikely(!db.opentemp())) {
+				*errtext = _("cannot open temporary file");
+				return false;
+			}
+			BenchRandom rnd;
+			count = 65536;
+			for(eix::UNumber i(0); likely(i != count); ++i) {
+				// Mostly hash indices, sometimes lengths and offsets
+				eix::UNumber c(rnd.next(100));
+				eix::UNumber num((c < 70) ? rnd.next(256) :
+					((c < 95) ? rnd.next(65536) : rnd.next(0xFFFFFFU)));
+				if(unlikely(!db.write_num(num, errtext))) {
+					return false;
+				}
+			}
+			bytes = static_cast<eix::UNumber>(db.tell());
+			ops = count;
+			return true;
+		}
+
+		eix::UNumber run() {
+			eix::UNumber r(0);
+			string errtext;
+			db.seekabs(0, &errtext);
+			for(eix::UNumber i(count); likely(i != 0); --i) {
+				eix::UNumber num;
+				db.read_num(&num, &errtext);
+				r += num;
+			}
+			return r;
+		}
+};
+
+class BenchKeyflags : public BenchKernel {
+	private:
+		WordSet accepted;
+		WordVec keywords;
+
+	public:
+		BenchKeyflags() : BenchKernel("KeywordsFlags::get_keyflags") {
+		}
+
+		bool prepare(string *errtext ATTRIBUTE_UNUSED) ATTRIBUTE_NONNULL_ {
+			UNUSED(errtext);
+			accepted.insert("amd64");
+			accepted.insert("~amd64");
+			BenchRandom rnd;
+			keywords.resize(4096);
+			for(WordVec::iterator it(keywords.begin());
+				likely(it != keywords.end()); ++it) {
+				*it = bench_keywords(&rnd);
+				bytes += it->size();
+			}
+			ops = keywords.size();
+			return true;
+		}
+
+		eix::UNumber run() {
+			eix::UNumber r(0);
+			for(WordVec::const_iterator it(keywords.begin());
+				likely(it != keywords.end()); ++it) {
+				r += KeywordsFlags::get_keyflags(accepted, *it);
+			}
+			return r;
+		}
+};
+
+class BenchMaskList : public BenchKernel {
+	private:
+		MaskList<Mask> masks;
+		WordVec names;
+
+	public:
+		BenchMaskList() : BenchKernel("MaskList::get_full") {
+		}
+
+		bool prepare(string *errtext) ATTRIBUTE_NONNULL_ {
+			BenchRandom rnd;
+			WordVec all;
+			for(eix::UNumber i(0); likely(i != 8192); ++i) {
+				all.push_back(string(rnd.pick(bench_categories, BENCH_SIZE(bench_categories))) +
+					"/" + bench_name(&rnd));
+			}
+			// Exact masks for half of the names, as in package.mask
+			for(eix::UNumber i(0); likely(i != 4096); ++i) {
+				const string& full(all[rnd.next(all.size())]);
+				string mask;
+				switch(rnd.next(4)) {
+					case 0:
+						mask = full;
+						break;
+					case 1:
+						mask = ">=" + full + "-" + bench_version(&rnd);
+						break;
+					case 2:
+						mask = "<" + full + "-" + bench_version(&rnd);
+						break;
+					default:
+						mask = "=" + full + "-" + bench_version(&rnd);
+						break;
+				}
+				Mask m(Mask::maskMask);
+				if(unlikely(m.parseMask(mask.c_str(), errtext) == BasicVersion::parsedError)) {
+					return false;
+				}
+				masks.add(m);
+			}
+			// Some wildcard masks which must be matched against every name
+			for(eix::UNumber i(0); likely(i != 32); ++i) {
+				string mask;
+				if(rnd.chance(50)) {
+					mask = string(rnd.pick(bench_categories, BENCH_SIZE(bench_categories))) + "/" +
+						rnd.pick(bench_syllables, BENCH_SIZE(bench_syllables)) + "*";
+				} else {
+					mask = string("*/") + rnd.pick(bench_syllables, BENCH_SIZE(bench_syllables)) + "-*";
+				}
+				Mask m(Mask::maskMask);
+				if(unlikely(m.parseMask(mask.c_str(), errtext) == BasicVersion::parsedError)) {
+					return false;
+				}
+				masks.add(m);
+			}
+			names.resize(4096);
+			for(WordVec::iterator it(names.begin()); likely(it != names.end()); ++it) {
+				*it = all[rnd.next(all.size())];
+			}
+			ops = names.size();
+			return true;
+		}
+
+		eix::UNumber run() {
+			eix::UNumber r(0);
+			for(WordVec::const_iterator it(names.begin());
+				likely(it != names.end()); ++it) {
+				MaskList<Mask>::Get *l(masks.get_full(*it));
+				if(l != NULLPTR) {
+					r += l->size();
+					delete l;
+				}
+			}
+			return r;
+		}
+};
+
+class BenchLevenshtein : public BenchKernel {
+	private:
+		WordVec left, right;
+
+	public:
+		BenchLevenshtein() : BenchKernel("get_levenshtein_distance") {
+		}
+
+		bool prepare(string *errtext ATTRIBUTE_UNUSED) ATTRIBUTE_NONNULL_ {
+			UNUSED(errtext);
+			BenchRandom rnd;
+			for(eix::UNumber i(0); likely(i != 2048); ++i) {
+				left.push_back(bench_name(&rnd));
+				right.push_back(bench_name(&rnd));
+				bytes += left.back().size() + right.back().size();
+			}
+			ops = left.size();
+			return true;
+		}
+
+		eix::UNumber run() {
+			eix::UNumber r(0);
+			for(WordVec::size_type i(0); likely(i != left.size()); ++i) {
+				r += get_levenshtein_distance(left[i].c_str(), right[i].c_str());
+			}
+			return r;
+		}
+};
+
+/**
+Case-insensitive search in names and descriptions; either of literal
+patterns as done by default or of patterns like py.*lib with Regex
+**/
+class BenchSearch : public BenchKernel {
+	private:
+		bool use_regex;
+		WordVec patterns, texts;
+
+	public:
+		explicit BenchSearch(bool regex) : BenchKernel(regex ? "Regex::match" : "RegexAlgorithm::operator()"), use_regex(regex) {
+		}
+
+		bool prepare(string *errtext ATTRIBUTE_UNUSED) ATTRIBUTE_NONNULL_ {
+			UNUSED(errtext);
+			BenchRandom rnd;
+			for(eix::UNumber i(0); likely(i != 8); ++i) {
+				string pattern(rnd.pick(bench_syllables, BENCH_SIZE(bench_syllables)));
+				pattern[0] = my_toupper(pattern[0]);
+				if(use_regex) {
+					pattern.append(".*");
+					pattern.append(rnd.pick(bench_syllables, BENCH_SIZE(bench_syllables)));
+				}
+				patterns.push_back(pattern);
+			}
+			for(eix::UNumber i(0); likely(i != 2048); ++i) {
+				string pkg_name(bench_name(&rnd));
+				texts.push_back(pkg_name);
+				texts.push_back("A synthetic package for benchmarking " + pkg_name);
+				bytes += texts[texts.size() - 2].size() + texts.back().size();
+			}
+			bytes *= patterns.size();
+			ops = texts.size() * patterns.size();
+			return true;
+		}
+
+		eix::UNumber run() {
+			eix::UNumber r(0);
+			for(WordVec::const_iterator p(patterns.begin()); likely(p != patterns.end()); ++p) {
+				RegexAlgorithm algorithm;
+				Regex re;
+				if(use_regex) {
+					re.compile(p->c_str(), REG_ICASE);
+				} else {
+					algorithm.setString(*p);
+				}
+				for(WordVec::const_iterator it(texts.begin()); likely(it != texts.end()); ++it) {
+					if(use_regex ? re.match(it->c_str()) : algorithm(it->c_str(), NULLPTR)) {
+						++r;
+					}
+				}
+			}
+			return r;
+		}
+};
+
+class BenchVarsReader : public BenchKernel {
+	private:
+		string content;
+
+	public:
+		BenchVarsReader() : BenchKernel("VarsReader::readmem") {
+		}
+
+		bool prepare(string *errtext ATTRIBUTE_UNUSED) ATTRIBUTE_NONNULL_ {
+			UNUSED(errtext);
+			// Something like a make.conf with a lot of comments
+			BenchRandom rnd;
+			for(eix::UNumber i(0); likely(i != 256); ++i) {
+				string var(bench_name(&rnd));
+				for(string::iterator it(var.begin()); likely(it != var.end()); ++it) {
+					*it = (*it == '-') ? '_' : my_toupper(*it);
+				}
+				switch(rnd.next(4)) {
+					case 0:
+						content.append("# ");
+						content.append(bench_iuse(&rnd));
+						content.append("\n# ");
+						content.append(bench_keywords(&rnd));
+						content.append(1, '\n');
+						break;
+					case 1:
+						content.append(var + "=\"${" + var + "} " + bench_iuse(&rnd) + "\"\n");
+						break;
+					case 2:
+						content.append(var + "='" + bench_keywords(&rnd) + "\n\t" +
+							bench_iuse(&rnd) + "'\n");
+						break;
+					default:
+						content.append("export " + var + "=" + bench_version(&rnd) + "\n");
+						break;
+				}
+			}
+			bytes = content.size();
+			ops = 1;
+			return true;
+		}
+
+		eix::UNumber run() {
+			VarsReader reader(VarsReader::SUBST_VARS|VarsReader::PORTAGE_ESCAPES);
+			string errtext;
+			reader.readmem(content.c_str(), content.c_str() + content.size(), &errtext);
+			return reader.end() != reader.begin();
+		}
+};
+
+class BenchPrintFormat : public BenchKernel {
+	private:
+		EixRc *eixrc;
+		ParseError *parse_error;
+		PortageSettings *portagesettings;
+		SetStability *stability;
+		VarDbPkg *vardb;
+		PrintFormat *format;
+		DBHeader header;
+		vector<Package *> packages;
+
+	public:
+		explicit BenchPrintFormat(EixRc *rc) : BenchKernel("PrintFormat::print"),
+			eixrc(rc), parse_error(NULLPTR), portagesettings(NULLPTR),
+			stability(NULLPTR), vardb(NULLPTR), format(NULLPTR) {
+		}
+
+		~BenchPrintFormat() {
+			for(vector<Package *>::iterator it(packages.begin());
+				likely(it != packages.end()); ++it) {
+				delete *it;
+			}
+			delete format;
+			delete vardb;
+			delete stability;
+			delete portagesettings;
+			delete parse_error;
+		}
+
+		bool prepare(string *errtext) ATTRIBUTE_NONNULL_ {
+			// Use the real configuration, as eix would do
+			parse_error = new ParseError(true);
+			portagesettings = new PortageSettings(eixrc, parse_error, true, false);
+			stability = new SetStability(portagesettings, true, false,
+				eixrc->getBool("ALWAYS_ACCEPT_KEYWORDS"));
+			vardb = new VarDbPkg((*eixrc)["EPREFIX_INSTALLED"] + VAR_DB_PKG,
+				false, false, false, false, false, false);
+			format = new PrintFormat(get_package_property);
+			format->setupResources(eixrc);
+			format->no_color = true;
+			format->setupColors();
+			if(unlikely(!format->parseFormat((*eixrc)["FORMAT"].c_str(), errtext))) {
+				return false;
+			}
+			header.addOverlay(OverlayIdent((*portagesettings)["PORTDIR"].c_str(), "gentoo"));
+			BenchRandom rnd;
+			for(eix::UNumber i(0); likely(i != 512); ++i) {
+				Package *p(new Package(rnd.pick(bench_categories, BENCH_SIZE(bench_categories)),
+					bench_name(&rnd)));
+				p->desc = "A synthetic package for benchmarking " + p->name;
+				p->homepage = "https://example.org/" + p->name;
+				p->licenses = rnd.chance(50) ? "GPL-2" : "|| ( MIT BSD )";
+				for(eix::UNumber j(rnd.next(6) + 1); likely(j != 0); --j) {
+					Version *v(new Version);
+					if(unlikely(v->parseVersion(bench_version(&rnd), errtext) != BasicVersion::parsedOK)) {
+						delete v;
+						return false;
+					}
+					v->eapi.assign("8");
+					v->set_slotname(rnd.chance(80) ? "0" : "2/2.1");
+					v->set_full_keywords(bench_keywords(&rnd));
+					v->set_iuse(bench_iuse(&rnd));
+					v->overlay_key = 0;
+					p->addVersion(v);
+				}
+				portagesettings->setMasks(p);
+				p->save_maskflags(Version::SAVEMASK_FILE);
+				portagesettings->calc_local_sets(p);
+				portagesettings->finalize(p);
+				packages.push_back(p);
+			}
+			ops = packages.size();
+			return true;
+		}
+
+		eix::UNumber run() {
+			eix::UNumber r(0);
+			OutputString s;
+			for(vector<Package *>::const_iterator it(packages.begin());
+				likely(it != packages.end()); ++it) {
+				s.clear();
+				format->render(&s, *it, &header, vardb, portagesettings, stability);
+				r += s.as_string().size();
+			}
+			bytes = r;
+			return r;
+		}
+};
+
+static double bench_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULLPTR);
+	return (static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1000000.0);
+}
+
+/**
+Run the kernel once for warmup and to calibrate the number of iterations
+such that each repetition takes at least min_time seconds.
+@return the times per operation in ns, one for each repetition
+**/
+static vector<double> bench_measure(BenchKernel *kernel, unsigned int repetitions, double min_time, eix::UNumber *iterations) ATTRIBUTE_NONNULL_;
+static vector<double> bench_measure(BenchKernel *kernel, unsigned int repetitions, double min_time, eix::UNumber *iterations) {
+	eix::UNumber sink(0);
+	eix::UNumber n(1);
+	for(;;) {
+		double start(bench_time());
+		for(eix::UNumber i(n); likely(i != 0); --i) {
+			sink += kernel->run();
+		}
+		double elapsed(bench_time() - start);
+		if(elapsed >= min_time) {
+			break;
+		}
+		n = ((elapsed > min_time / 100) ?
+			static_cast<eix::UNumber>(n * (1.2 * min_time / elapsed)) + 1 :
+			(n * 10));
+	}
+	*iterations = n;
+	vector<double> result;
+	for(unsigned int rep(0); likely(rep != repetitions); ++rep) {
+		double start(bench_time());
+		for(eix::UNumber i(n); likely(i != 0); --i) {
+			sink += kernel->run();
+		}
+		double elapsed(bench_time() - start);
+		result.push_back(elapsed * 1000000000.0 / (static_cast<double>(n) * static_cast<double>(kernel->ops)));
+	}
+	bench_sink = sink;
+	return result;
+}
+
+static void print_help() {
+	cout << eix::format(_("Usage: %s [options] [kernel ...]\n"
+"Time some kernels of eix over synthetic input and print for each kernel\n"
+"a tab-separated line with the name, the number of repetitions and of\n"
+"iterations per repetition, the median and minimum of ns per operation,\n"
+"the operations per second, and MB per second (if meaningful).\n"
+"The kernel PrintFormat::print uses the configuration of eix and portage.\n"
+"\n"
+" -r, --repetitions N    number of timed repetitions (default 5)\n"
+" -m, --min-time MS      minimal time of a repetition in ms (default 200)\n"
+" -l, --list             list the available kernels\n"
+" -h, --help             show a short help screen\n")) % program_name;
+}
+
+/**
+Local options for argument reading
+**/
+static struct LocalOptions {
+	bool
+		list,
+		help;
+} rc_options;
+
+static const char *repetitions_arg, *min_time_arg;
+
+/**
+Arguments and options
+**/
+class BenchOptionList : public OptionList {
+	public:
+		BenchOptionList();
+};
+
+BenchOptionList::BenchOptionList() {
+	push_back(Option("help",        'h', Option::BOOLEAN_T, &rc_options.help));
+	push_back(Option("list",        'l', Option::BOOLEAN_T, &rc_options.list));
+	push_back(Option("repetitions", 'r', Option::STRING,    &repetitions_arg));
+	push_back(Option("min-time",    'm', Option::STRING,    &min_time_arg));
+}
+
+int run_eix_bench(int argc, char *argv[]) {
+	Eapi::init_static();
+	ExtendedVersion::init_static();
+	PortageSettings::init_static();
+	PrintFormat::init_static();
+
+	rc_options.list = rc_options.help = false;
+	repetitions_arg = min_time_arg = NULLPTR;
+	ArgumentReader argreader(argc, argv, BenchOptionList());
+	if(unlikely(rc_options.help)) {
+		print_help();
+		return EXIT_SUCCESS;
+	}
+	unsigned int repetitions((repetitions_arg == NULLPTR) ? 5 : my_atoi(repetitions_arg));
+	if(unlikely(repetitions == 0)) {
+		repetitions = 1;
+	}
+	double min_time((min_time_arg == NULLPTR) ? 0.2 : (my_atoi(min_time_arg) / 1000.0));
+
+	EixRc& eixrc(get_eixrc(EIX_VARS_PREFIX));
+	Depend::use_depend = eixrc.getBool("DEP");
+	Version::use_required_use = eixrc.getBool("REQUIRED_USE");
+
+	list<BenchKernel *> kernels;
+	kernels.push_back(new BenchVersionCompare);
+	kernels.push_back(new BenchReadNum);
+	kernels.push_back(new BenchKeyflags);
+	kernels.push_back(new BenchMaskList);
+	kernels.push_back(new BenchLevenshtein);
+	kernels.push_back(new BenchSearch(true));
+	kernels.push_back(new BenchSearch(false));
+	kernels.push_back(new BenchVarsReader);
+	kernels.push_back(new BenchPrintFormat(&eixrc));
+
+	if(unlikely(rc_options.list)) {
+		for(list<BenchKernel *>::const_iterator it(kernels.begin());
+			likely(it != kernels.end()); ++it) {
+			cout << (*it)->name << "\n";
+		}
+		return EXIT_SUCCESS;
+	}
+
+	WordSet selected;
+	for(ArgumentReader::const_iterator it(argreader.begin());
+		likely(it != argreader.end()); ++it) {
+		if(it->type == Parameter::ARGUMENT) {
+			selected.insert(it->m_argument);
+		}
+	}
+
+	int ret(EXIT_SUCCESS);
+	printf("# kernel\trepetitions\titerations\tns/op (median)\tns/op (min)\top/s\tMB/s\n");
+	for(list<BenchKernel *>::iterator it(kernels.begin());
+		likely(it != kernels.end()); ++it) {
+		BenchKernel *kernel(*it);
+		if(!selected.empty() && (selected.find(kernel->name) == selected.end())) {
+			continue;
+		}
+		string errtext;
+		if(unlikely(!kernel->prepare(&errtext))) {
+			cerr << eix::format(_("%s: %s")) % kernel->name % errtext << endl;
+			ret = EXIT_FAILURE;
+			continue;
+		}
+		eix::UNumber iterations;
+		vector<double> times(bench_measure(kernel, repetitions, min_time, &iterations));
+		sort(times.begin(), times.end());
+		double median(times[times.size() / 2]);
+		double ns_per_byte((kernel->bytes == 0) ? 0 :
+			(median * static_cast<double>(kernel->ops) / static_cast<double>(kernel->bytes)));
+		printf("%s\t%u\t%lu\t%.1f\t%.1f\t%.0f\t%.2f\n", kernel->name, repetitions,
+			static_cast<unsigned long>(iterations),  // NOLINT(runtime/int)
+			median, times[0], 1000000000.0 / median,
+			!(ns_per_byte > 0) ? 0.0 : (1000.0 / ns_per_byte));
+		fflush(stdout);
+	}
+	for(list<BenchKernel *>::iterator it(kernels.begin());
+		likely(it != kernels.end()); ++it) {
+		delete *it;
+	}
+	return ret;
+}
@@ -11,25 +11,39 @@
 
 // Everyone wanted something like esync from esearch .. so here it is!
 
+#include <fcntl.h>
 #include <unistd.h>
 
 #include <cstdlib>
+#include <cstring>
 
 #include <algorithm>
 #include <iostream>
+#include <list>
+#include <map>
 #include <string>
 
 #include "database/header.h"
+#include "database/history.h"
 #include "database/io.h"
+#include "database/package_reader.h"
 #include "eixTk/ansicolor.h"
 #include "eixTk/argsreader.h"
+#include "eixTk/eixint.h"
 #include "eixTk/filenames.h"
 #include "eixTk/formated.h"
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/outputsink.h"
+#include "eixTk/outputstring.h"
 #include "eixTk/parseerror.h"
+#include "eixTk/stats.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/stringutils.h"
+#include "eixTk/sysutils.h"
 #include "eixTk/utils.h"
+#include "eixTk/workers.h"
 #include "eixrc/eixrc.h"
 #include "eixrc/global.h"
 #include "main/main.h"
@@ -46,6 +60,17 @@
 
 #define VAR_DB_PKG "/var/db/pkg/"
 
+/**
+The messages of the workers consist of a type and of rendered packages,
+each preceded by a tag
+**/
+#define MSG_STEP 's'
+#define MSG_END 'e'
+#define TAG_INLINE 'i'
+#define TAG_LOST 'l'
+#define TAG_FOUND 'f'
+
+using std::list;
 using std::string;
 
 using std::cerr;
@@ -53,12 +78,23 @@ using std::cout;
 using std::endl;
 
 static void print_help();
-static void load_db(const char *file, DBHeader *header, PackageTree *body, PortageSettings *ps) ATTRIBUTE_NONNULL_;
+static void open_db(const char *file, Database *db, DBHeader *header, PortageSettings *ps, eix::Treesize *count) ATTRIBUTE_NONNULL((1, 2, 3, 4));
+static void db_error(const string& file, const char *errtext) ATTRIBUTE_NONNULL_ ATTRIBUTE_NORETURN;
+static bool reopen_db(const string& file, Database *db, eix::OffsetType offset) ATTRIBUTE_NONNULL_;
 static void set_virtual(PrintFormat *fmt, const DBHeader& header, const string& eprefix_virtual) ATTRIBUTE_NONNULL_;
 static void print_changed_package(Package *op, Package *np) ATTRIBUTE_NONNULL_;
 static void print_found_package(Package *p) ATTRIBUTE_NONNULL_;
 static void print_lost_package(Package *p) ATTRIBUTE_NONNULL_;
+static void add_rendered(char tag, const OutputString& rendered);
+static void render_changed_package(Package *op, Package *np) ATTRIBUTE_NONNULL_;
+static void render_found_package(Package *p) ATTRIBUTE_NONNULL_;
+static void render_lost_package(Package *p) ATTRIBUTE_NONNULL_;
+static bool send_step();
+static void print_packed(const string& packed);
 static void parseFormat(Node **format, const char *varname, EixRc *rc) ATTRIBUTE_NONNULL_;
+static int list_generations(const string& history);
+static void remove_temp_files();
+static void extract_generation(string *file, const string& history, const char *arg) ATTRIBUTE_NONNULL_;
 
 static PortageSettings *portagesettings;
 static SetStability   *set_stability_old, *set_stability_new;
@@ -67,6 +103,14 @@ static VarDbPkg       *varpkg_db;
 static DBHeader       *old_header, *new_header;
 static Node           *format_new, *format_delete, *format_changed;
 
+// Databases extracted from the history
+static WordVec *temp_files = NULLPTR;
+
+// The state of a worker process
+static string *worker_msg;
+static int     worker_fd;
+static char    worker_lost_tag;
+
 static void print_help() {
 	cout << eix::format(_("Usage: %s [options] old-cache [new-cache]\n"
 "\n"
@@ -74,7 +118,13 @@ static void print_help() {
 "     --care              always read slots of installed packages\n"
 "     --deps-installed    always read deps of installed packages\n"
 " -q, --quiet (toggle)    (no) output\n"
+" -j, --jobs N            compare in N processes (0 = number of processors)\n"
+" -G, --generation N      use generation N of EIX_HISTORY as old-cache; if\n"
+"                         given twice, also as new-cache. Numbers <= 0 count\n"
+"                         from the last generation (0)\n"
+"     --list-generations  list the generations of EIX_HISTORY\n"
 "     --ansi              reset the ansi 256 color palette\n"
+"     --stats (toggle)    print timing statistics to stderr at exit\n"
 " -n, --nocolor           don't use colors in output\n"
 " -F, --force-color       force colors on things that are not a terminal\n"
 "     --dump              dump variables to stdout\n"
@@ -95,12 +145,16 @@ bool cli_show_help(false),
 	cli_dump_defaults(false),
 	cli_known_vars(false),
 	cli_ansi(false),
+	cli_list_generations(false),
 	cli_quick,
 	cli_care,
 	cli_deps_installed,
-	cli_quiet;
+	cli_quiet,
+	cli_stats;
 
 const char *var_to_print(NULLPTR);
+const char *cli_jobs(NULLPTR);
+list<const char *> cli_generations;
 
 enum cli_options {
 	O_DUMP = 300,
@@ -110,7 +164,9 @@ enum cli_options {
 	O_CARE,
 	O_DEPS_INSTALLED,
 	O_ANSI,
-	O_FORCE_COLOR
+	O_FORCE_COLOR,
+	O_LIST_GENERATIONS,
+	O_STATS
 };
 
 
@@ -135,27 +191,70 @@ EixDiffOptionList::EixDiffOptionList() {
 	push_back(Option("care",         O_CARE, Option::BOOLEAN_T, &cli_care));
 	push_back(Option("deps_installed", O_DEPS_INSTALLED, Option::BOOLEAN_T, &cli_deps_installed));
 	push_back(Option("quiet",        'q',    Option::BOOLEAN,   &cli_quiet));
+	push_back(Option("jobs",         'j',    Option::STRING,    &cli_jobs));
+	push_back(Option("generation",   'G',    Option::STRINGLIST, &cli_generations));
+	push_back(Option("list-generations", O_LIST_GENERATIONS, Option::BOOLEAN_T, &cli_list_generations));
 	push_back(Option("ansi",         O_ANSI, Option::BOOLEAN_T, &cli_ansi));
+	push_back(Option("stats",        O_STATS, Option::BOOLEAN,  &cli_stats));
 }
 
-static void load_db(const char *file, DBHeader *header, PackageTree *body, PortageSettings *ps) {
-	Database db;
-	if(likely(db.openread(file))) {
+/**
+Open the database and read its header.
+If count is not NULLPTR, the packages are counted.
+**/
+static void open_db(const char *file, Database *db, DBHeader *header, PortageSettings *ps, eix::Treesize *count) {
+	if(likely(db->openread(file))) {
 		string errtext;
-		if(likely(db.read_header(header, &errtext))) {
+		if(likely(db->read_header(header, &errtext))) {
 			header->set_priorities(ps);
 			ps->store_world_sets(&(header->world_sets));
-			if(likely(db.read_packagetree(body, *header, ps, &errtext))) {
+			if(count == NULLPTR) {
 				return;
 			}
+			// Count the packages by skipping over them
+			eix::OffsetType start(db->tell());
+			PackageReader reader(db, *header);
+			for(*count = 0; reader.next(); ++(*count)) {
+				if(unlikely(!reader.skip())) {
+					break;
+				}
+			}
+			const char *err(reader.get_errtext());
+			if(likely(err == NULLPTR)) {
+				if(likely(db->seekabs(start, &errtext))) {
+					return;
+				}
+			} else {
+				errtext = err;
+			}
 		}
-		cerr << eix::format(_("error in database file %s: %s")) % file % errtext << endl;
-	} else {
-		cerr << eix::format(_("cannot open database file %s for reading (mode = 'rb')")) % file << endl;
+		db_error(file, errtext.c_str());
 	}
+	cerr << eix::format(_("cannot open database file %s for reading (mode = 'rb')")) % file << endl;
+	exit(EXIT_FAILURE);
+}
+
+static void db_error(const string& file, const char *errtext) {
+	cerr << eix::format(_("error in database file %s: %s")) % file % errtext << endl;
 	exit(EXIT_FAILURE);
 }
 
+/**
+Open the database again at offset (in a worker)
+**/
+static bool reopen_db(const string& file, Database *db, eix::OffsetType offset) {
+	if(unlikely(!db->openread(file.c_str()))) {
+		cerr << eix::format(_("cannot open database file %s for reading (mode = 'rb')")) % file << endl;
+		return false;
+	}
+	string errtext;
+	if(unlikely(!db->seekabs(offset, &errtext))) {
+		cerr << eix::format(_("error in database file %s: %s")) % file % errtext << endl;
+		return false;
+	}
+	return true;
+}
+
 static void set_virtual(PrintFormat *fmt, const DBHeader& header, const string& eprefix_virtual) {
 	if(header.countOverlays() == 0) {
 		return;
@@ -165,86 +264,169 @@ static void set_virtual(PrintFormat *fmt, const DBHeader& header, const string&
 		fmt->set_as_virtual(i, is_virtual((eprefix_virtual + header.getOverlay(i).path).c_str()));
 }
 
+/**
+Diff two databases which are read simultaneously category by category:
+Only one category of the new database is kept in memory, and each
+package is freed as soon as it has been compared.
+**/
 class DiffTrees {
 	public:
 		typedef void (*lost_func) (Package *p) ATTRIBUTE_NONNULL_;
 		typedef void (*found_func) (Package *p) ATTRIBUTE_NONNULL_;
 		typedef void (*changed_func) (Package *p1, Package *p2) ATTRIBUTE_NONNULL_;
 
+		typedef bool (*step_func) ();
+		typedef unsigned int Step;
+
 		lost_func lost_package;
 		found_func found_package;
 		changed_func changed_package;
 
-		DiffTrees(VarDbPkg *vardbpkg, PortageSettings *portage_settings, bool only_installed, bool compare_slots, bool separate_deleted) ATTRIBUTE_NONNULL_ :
-			m_vardbpkg(vardbpkg), m_portage_settings(portage_settings), m_only_installed(only_installed),
-			m_slots(compare_slots), m_separate_deleted(separate_deleted) {
+		/**
+		If set, only every m_steps-th category is diffed (starting with
+		m_first_step), and the deferred packages are passed on at the end
+		of each step, followed by a call to end_of_step
+		**/
+		step_func end_of_step;
+
+		DiffTrees(VarDbPkg *vardbpkg, PortageSettings *portage_settings, const SetStability *stability_old, const SetStability *stability_new, bool only_installed, bool compare_slots, bool separate_deleted) ATTRIBUTE_NONNULL_ :
+			end_of_step(NULLPTR),
+			m_vardbpkg(vardbpkg), m_portage_settings(portage_settings),
+			m_stability_old(stability_old), m_stability_new(stability_new),
+			m_only_installed(only_installed),
+			m_slots(compare_slots), m_separate_deleted(separate_deleted),
+			m_first_step(0), m_steps(1) {
+		}
+
+		bool separate_deleted() const {
+			return m_separate_deleted;
 		}
 
 		/**
-		Diff the trees and run callbacks
+		Diff only the share of worker number first of steps
 		**/
-		void diff(PackageTree *old_tree, PackageTree *new_tree) ATTRIBUTE_NONNULL_ {
-			// Diff every category from the old tree with the category from the new tree
-			for(PackageTree::iterator old_cat(old_tree->begin());
-				likely(old_cat != old_tree->end()); ++old_cat) {
-				diff_category(old_cat->second, &(*new_tree)[old_cat->first]);
-			}
-
-			// Now we've only new package in the new_tree
-			// and lost packages in the old_tree
+		void set_share(Step first, Step steps, step_func func) ATTRIBUTE_NONNULL((4)) {
+			m_first_step = first;
+			m_steps = steps;
+			end_of_step = func;
+		}
 
-			if(m_separate_deleted) {
-				for(PackageTree::iterator old_cat(old_tree->begin());
-					likely(old_cat != old_tree->end()); ++old_cat) {
-					for_each(old_cat->second->begin(), old_cat->second->end(), lost_package);
+		/**
+		Diff the databases and run callbacks
+		@return false if reading failed
+		**/
+		bool diff(PackageReader *old_reader, PackageReader *new_reader) ATTRIBUTE_NONNULL_ {
+			// Lost packages (if separated) and new packages are output
+			// at the end; we must keep them until then
+			Category lost, found;
+			bool have_old(old_reader->nextCategory());
+			bool have_new(new_reader->nextCategory());
+			for(Step step(0); have_old || have_new; ++step) {
+				int cmp(have_old ? (have_new ?
+					old_reader->category().compare(new_reader->category()) : -1) : 1);
+				if(step % m_steps != m_first_step) {
+					// Another worker diffs this category
+					if(cmp >= 0) {
+						if(unlikely(!new_reader->skipCategory())) {
+							return false;
+						}
+						have_new = new_reader->nextCategory();
+					}
+					if(cmp <= 0) {
+						if(unlikely(!old_reader->skipCategory())) {
+							return false;
+						}
+						have_old = old_reader->nextCategory();
+					}
+					continue;
+				}
+				Category new_cat;
+				NameIndex new_index;
+				if(cmp >= 0) {
+					while(new_reader->nextPackage()) {
+						Package *p(new_reader->release());
+						m_stability_new->set_stability(p);
+						new_index[p->name] = new_cat.insert(new_cat.end(), p);
+					}
+					if(unlikely(new_reader->get_errtext() != NULLPTR)) {
+						return false;
+					}
+					have_new = new_reader->nextCategory();
+				}
+				if(cmp <= 0) {
+					while(old_reader->nextPackage()) {
+						Package *p(old_reader->release());
+						m_stability_old->set_stability(p);
+						diff_package(p, &new_cat, &new_index, &lost);
+					}
+					if(unlikely(old_reader->get_errtext() != NULLPTR)) {
+						return false;
+					}
+					have_old = old_reader->nextCategory();
+				}
+				// Now we have only new packages in new_cat
+				found.splice(found.end(), new_cat);
+				if(end_of_step != NULLPTR) {
+					pass_deferred(&lost, &found);
+					if(unlikely(!(*end_of_step)())) {
+						return false;
+					}
 				}
 			}
-			for(PackageTree::iterator new_cat(new_tree->begin());
-				likely(new_cat != new_tree->end()); ++new_cat) {
-				for_each(new_cat->second->begin(), new_cat->second->end(), found_package);
+			if(unlikely((old_reader->get_errtext() != NULLPTR) ||
+				(new_reader->get_errtext() != NULLPTR))) {
+				return false;
 			}
+			pass_deferred(&lost, &found);
+			return true;
 		}
 
 	private:
+		typedef std::map<std::string, Category::iterator> NameIndex;
+
 		VarDbPkg *m_vardbpkg;
 		PortageSettings *m_portage_settings;
+		const SetStability *m_stability_old, *m_stability_new;
 		bool m_only_installed, m_slots, m_separate_deleted;
+		Step m_first_step, m_steps;
+
+		void pass_deferred(Category *lost, Category *found) ATTRIBUTE_NONNULL_ {
+			for_each(lost->begin(), lost->end(), lost_package);
+			for_each(found->begin(), found->end(), found_package);
+			lost->delete_and_clear();
+			found->delete_and_clear();
+		}
 
 		bool best_differs(const Package *new_pkg, const Package *old_pkg) ATTRIBUTE_NONNULL_ {
 			return new_pkg->differ(*old_pkg, m_vardbpkg, m_portage_settings, true, m_only_installed, m_slots);
 		}
 
 		/**
-		Diff two categories and run callbacks.
-		Remove already diffed packages from both categories.
+		Diff an old package with the corresponding one of new_cat and run
+		callbacks. Remove the package from new_cat and free old_pkg
+		(unless it is collected in lost).
 		**/
-		void diff_category(Category *old_cat, Category *new_cat) ATTRIBUTE_NONNULL_ {
-			Category::iterator old_pkg(old_cat->begin());
-
-			while(likely(old_pkg != old_cat->end())) {
-				Category::iterator new_pkg(new_cat->find(old_pkg->name));
-
-				if(unlikely(new_pkg == new_cat->end())) {
-					// Lost a package
-					if(m_separate_deleted) {
-						++old_pkg;
-						continue;
-					}
-					lost_package(*old_pkg);
-				} else {
-					// Best version differs
-					if(unlikely(best_differs(*new_pkg, *old_pkg)))
-						changed_package(*old_pkg, *new_pkg);
-
-					// Remove the new package
-					delete *new_pkg;
-					new_cat->erase(new_pkg);
+		void diff_package(Package *old_pkg, Category *new_cat, NameIndex *new_index, Category *lost) ATTRIBUTE_NONNULL_ {
+			NameIndex::iterator it(new_index->find(old_pkg->name));
+			if(unlikely(it == new_index->end())) {
+				// Lost a package
+				if(m_separate_deleted) {
+					lost->push_back(old_pkg);
+					return;
 				}
-
-				// Remove the old packages
-				delete *old_pkg;
-				old_pkg = old_cat->erase(old_pkg);
+				lost_package(old_pkg);
+			} else {
+				Package *new_pkg(*(it->second));
+				// Best version differs
+				if(unlikely(best_differs(new_pkg, old_pkg)))
+					changed_package(old_pkg, new_pkg);
+
+				// Remove the new package
+				delete new_pkg;
+				new_cat->erase(it->second);
+				new_index->erase(it);
 			}
+			delete old_pkg;
 		}
 };
 
@@ -267,6 +449,163 @@ static void print_lost_package(Package *p) {
 	format_for_old->print(p, format_delete, old_header, varpkg_db, portagesettings, set_stability_old);
 }
 
+static void add_rendered(char tag, const OutputString& rendered) {
+	worker_msg->append(1, tag);
+	rendered.pack(worker_msg);
+}
+
+static void render_changed_package(Package *op, Package *np) {
+	Package *p[2] = { op, np };
+	OutputString rendered;
+	format_for_new->render(&rendered, p, get_diff_package_property, format_changed, new_header, varpkg_db, portagesettings, set_stability_new);
+	add_rendered(TAG_INLINE, rendered);
+}
+
+static void render_found_package(Package *p) {
+	OutputString rendered;
+	format_for_new->render(&rendered, p, get_package_property, format_new, new_header, varpkg_db, portagesettings, set_stability_new);
+	add_rendered(TAG_FOUND, rendered);
+}
+
+static void render_lost_package(Package *p) {
+	OutputString rendered;
+	format_for_old->render(&rendered, p, get_package_property, format_delete, old_header, varpkg_db, portagesettings, set_stability_old);
+	add_rendered(worker_lost_tag, rendered);
+}
+
+static bool send_step() {
+	bool success(ForkWorkers::send_message(worker_fd, worker_msg));
+	ForkWorkers::init_message(worker_msg);
+	worker_msg->append(1, MSG_STEP);
+	return success;
+}
+
+static void print_packed(const string& packed) {
+	const char *pos(packed.data());
+	const char *end(pos + packed.size());
+	OutputString rendered;
+	while(likely(pos != end)) {
+		if(unlikely(!rendered.unpack(&pos, end))) {
+			return;
+		}
+		format_for_new->print_rendered(rendered);
+	}
+}
+
+/**
+Diff in forked workers, each taking every n-th category, and print the
+results in the original order
+**/
+class ParallelDiff : public ForkWorkers {
+	public:
+		ParallelDiff(const DiffTrees& differ, const string& old_file, eix::OffsetType old_offset, const string& new_file, eix::OffsetType new_offset) :
+			m_differ(differ), m_old_file(old_file), m_new_file(new_file), m_old_offset(old_offset), m_new_offset(new_offset) {
+		}
+
+		/**
+		Collect and print the output of the started workers
+		@return false if a worker failed
+		**/
+		bool print();
+
+	protected:
+		bool run_worker(int fd, Index i);
+
+	private:
+		const DiffTrees& m_differ;
+		const string& m_old_file;
+		const string& m_new_file;
+		eix::OffsetType m_old_offset, m_new_offset;
+};
+
+bool ParallelDiff::run_worker(int fd, Index i) {
+	Database old_db, new_db;
+	if(unlikely(!reopen_db(m_old_file, &old_db, m_old_offset) ||
+		!reopen_db(m_new_file, &new_db, m_new_offset))) {
+		return false;
+	}
+	PackageReader old_reader(&old_db, *old_header, portagesettings);
+	PackageReader new_reader(&new_db, *new_header, portagesettings);
+	DiffTrees differ(m_differ);
+	differ.lost_package    = render_lost_package;
+	differ.found_package   = render_found_package;
+	differ.changed_package = render_changed_package;
+	differ.set_share(static_cast<DiffTrees::Step>(i), static_cast<DiffTrees::Step>(jobs()), send_step);
+	worker_lost_tag = (differ.separate_deleted() ? TAG_LOST : TAG_INLINE);
+	string msg;
+	worker_msg = &msg;
+	worker_fd = fd;
+	init_message(&msg);
+	msg.append(1, MSG_STEP);
+	if(unlikely(!differ.diff(&old_reader, &new_reader))) {
+		const char *errtext(old_reader.get_errtext());
+		if(errtext != NULLPTR) {
+			cerr << eix::format(_("error in database file %s: %s")) % m_old_file % errtext << endl;
+		}
+		errtext = new_reader.get_errtext();
+		if(errtext != NULLPTR) {
+			cerr << eix::format(_("error in database file %s: %s")) % m_new_file % errtext << endl;
+		}
+		return false;
+	}
+	init_message(&msg);
+	msg.append(1, MSG_END);
+	return send_message(fd, &msg);
+}
+
+bool ParallelDiff::print() {
+	// Deleted (if separated) and new packages are printed at the end
+	string lost, found, msg;
+	OutputString rendered;
+	for(Index step(0); ; ++step) {
+		if(unlikely(!read_message(step % jobs(), &msg) || msg.empty())) {
+			stop();
+			return false;
+		}
+		if(msg[0] == MSG_END) {
+			// Worker step % jobs() diffs category number step and sends
+			// its end after its last category. Thus the first end comes
+			// after the last category, and the next message of each other
+			// worker must be its end; receive them before closing the pipes
+			for(Index i(1); i != jobs(); ++i) {
+				if(unlikely(!read_message((step + i) % jobs(), &msg) ||
+					msg.empty() || (msg[0] != MSG_END))) {
+					stop();
+					return false;
+				}
+			}
+			break;
+		}
+		const char *pos(msg.data() + 1);
+		const char *end(msg.data() + msg.size());
+		while(pos != end) {
+			char tag(*(pos++));
+			const char *packed(pos);
+			if(unlikely(!rendered.unpack(&pos, end))) {
+				stop();
+				return false;
+			}
+			switch(tag) {
+				case TAG_INLINE:
+					format_for_new->print_rendered(rendered);
+					break;
+				case TAG_LOST:
+					lost.append(packed, pos - packed);
+					break;
+				default:
+					found.append(packed, pos - packed);
+					break;
+			}
+		}
+	}
+	if(unlikely(!finish())) {
+		return false;
+	}
+	print_packed(lost);
+	print_packed(found);
+	return true;
+}
+
 static void parseFormat(Node **format, const char *varname, EixRc *rc) {
 	string errtext;
 	if(likely((format_for_new->parseFormat(format, (*rc)[varname].c_str(), &errtext)))) {
@@ -277,6 +616,81 @@ static void parseFormat(Node **format, const char *varname, EixRc *rc) {
 	exit(EXIT_FAILURE);
 }
 
+static int list_generations(const string& history) {
+	if(unlikely(history.empty())) {
+		cerr << _("EIX_HISTORY is not set") << endl;
+		return EXIT_FAILURE;
+	}
+	DBHistory::Generations generations;
+	string errtext;
+	if(unlikely(!DBHistory::list(history.c_str(), &generations, &errtext))) {
+		cerr << errtext << endl;
+		return EXIT_FAILURE;
+	}
+	for(DBHistory::Generations::size_type i(0); likely(i != generations.size()); ++i) {
+		const DBHistory::Generation& generation(generations[i]);
+		cout << eix::format(generation.full ?
+			_("%s: %s  %s packages (full)\n") :
+			_("%s: %s  %s packages, %s changed, %s removed\n"))
+			% (i + 1)
+			% date_conv("%Y-%m-%d %H:%M:%S", generation.date)
+			% generation.packages % generation.changed % generation.removed;
+	}
+	return EXIT_SUCCESS;
+}
+
+static void remove_temp_files() {
+	for(WordVec::const_iterator it(temp_files->begin());
+		likely(it != temp_files->end()); ++it) {
+		unlink(it->c_str());
+	}
+}
+
+/**
+Reconstruct the generation specified by arg into a temporary database file
+**/
+static void extract_generation(string *file, const string& history, const char *arg) {
+	if(unlikely(history.empty())) {
+		cerr << _("EIX_HISTORY is not set") << endl;
+		exit(EXIT_FAILURE);
+	}
+	DBHistory::Generations generations;
+	string errtext;
+	if(unlikely(!DBHistory::list(history.c_str(), &generations, &errtext))) {
+		cerr << errtext << endl;
+		exit(EXIT_FAILURE);
+	}
+	long number(my_atois(arg));
+	DBHistory::Generations::size_type count(generations.size()), gen;
+	if(number > 0) {
+		gen = DBHistory::Generations::size_type(number - 1);
+	} else {
+		gen = count - 1 - DBHistory::Generations::size_type(-number);
+	}
+	if(unlikely(gen >= count)) {
+		cerr << eix::format(_("history file %s has no generation %s")) % history % arg << endl;
+		exit(EXIT_FAILURE);
+	}
+	char temp[256];
+	strcpy(temp, "/tmp/eix-diff.XXXXXXXX");  // NOLINT(runtime/printf)
+	int fd(mkstemp(temp));
+	if(unlikely(fd == -1)) {
+		cerr << _("cannot create temporary file") << endl;
+		exit(EXIT_FAILURE);
+	}
+	close(fd);
+	file->assign(temp);
+	if(temp_files == NULLPTR) {
+		temp_files = new WordVec;
+		atexit(remove_temp_files);
+	}
+	temp_files->push_back(*file);
+	if(unlikely(!DBHistory::extract(history.c_str(), gen, temp, &errtext))) {
+		cerr << errtext << endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
 int run_eix_diff(int argc, char *argv[]) {
 	// Initialize static classes
 	Eapi::init_static();
@@ -287,6 +701,7 @@ int run_eix_diff(int argc, char *argv[]) {
 
 	string old_file, new_file;
 
+	Stats::start("eixrc");
 	EixRc& rc(get_eixrc(DIFF_VARS_PREFIX)); {
 		string errtext;
 		bool success(drop_permissions(&rc, &errtext));
@@ -305,6 +720,7 @@ int run_eix_diff(int argc, char *argv[]) {
 	cli_care  = rc.getBool("CAREMODE");
 	cli_deps_installed = rc.getBool("DEPS_INSTALLED");
 	cli_quiet = rc.getBool("QUIETMODE");
+	cli_stats = rc.getBool("EIX_STATS");
 
 	format_for_new->no_color = (rc.getBool("NOCOLORS") ? true :
 		(rc.getBool("FORCE_COLORS") ? false : (isatty(1) == 0)));
@@ -312,6 +728,7 @@ int run_eix_diff(int argc, char *argv[]) {
 	/* Setup ArgumentReader. */
 	ArgumentReader argreader(argc, argv, EixDiffOptionList());
 	ArgumentReader::iterator current_param(argreader.begin());
+	Stats::enable(cli_stats);
 
 	if(unlikely(cli_ansi)) {
 		AnsiColor::AnsiPalette();
@@ -343,15 +760,31 @@ int run_eix_diff(int argc, char *argv[]) {
 		return EXIT_SUCCESS;
 	}
 
+	if(unlikely(cli_list_generations)) {
+		return list_generations(rc["EIX_HISTORY"]);
+	}
+
 	if(unlikely(cli_quiet)) {
 		if(!freopen(DEV_NULL, "w", stdout)) {
 			cerr << eix::format(_("cannot redirect to \"%s\"")) % DEV_NULL << endl;
 			exit(EXIT_FAILURE);
 		}
 	}
+	OutputSink::init();
 
 	bool have_new(false);
-	if(unlikely((current_param != argreader.end()) && (current_param->type == Parameter::ARGUMENT))) {
+	if(unlikely(!cli_generations.empty())) {
+		const string& history(rc["EIX_HISTORY"]);
+		list<const char *>::const_iterator it(cli_generations.begin());
+		extract_generation(&old_file, history, *it);
+		if(++it != cli_generations.end()) {
+			extract_generation(&new_file, history, *it);
+			have_new = true;
+		} else if(unlikely((current_param != argreader.end()) && (current_param->type == Parameter::ARGUMENT))) {
+			new_file = current_param->m_argument;
+			have_new = true;
+		}
+	} else if(unlikely((current_param != argreader.end()) && (current_param->type == Parameter::ARGUMENT))) {
 		old_file = current_param->m_argument;
 		++current_param;
 		if(unlikely((current_param != argreader.end()) && (current_param->type == Parameter::ARGUMENT))) {
@@ -375,6 +808,7 @@ int run_eix_diff(int argc, char *argv[]) {
 	parseFormat(&format_changed, "DIFF_FORMAT_CHANGED", &rc);
 
 	ParseError parse_error;
+	Stats::start("settings");
 	portagesettings = new PortageSettings(&rc, &parse_error, true, false);
 
 	varpkg_db = new VarDbPkg(rc["EPREFIX_INSTALLED"] + VAR_DB_PKG,
@@ -389,15 +823,18 @@ int run_eix_diff(int argc, char *argv[]) {
 	set_stability_new = new SetStability(portagesettings, local_settings, false, always_accept_keywords);
 	format_for_new->recommend_mode = rc.getLocalMode("RECOMMEND_LOCAL_MODE");
 
-	PackageTree new_tree;
+	bool print_header(rc.getBool("DIFF_PRINT_HEADER"));
+	eix::Treesize new_count, old_count;
+	Stats::start("header");
+	Database new_db;
 	new_header = new DBHeader;
-	load_db(new_file.c_str(), new_header, &new_tree, portagesettings);
-	set_stability_new->set_stability(&new_tree);
+	open_db(new_file.c_str(), &new_db, new_header, portagesettings,
+		(print_header ? &new_count : NULLPTR));
 
-	PackageTree old_tree;
+	Database old_db;
 	old_header = new DBHeader;
-	load_db(old_file.c_str(), old_header, &old_tree, portagesettings);
-	set_stability_old->set_stability(&old_tree);
+	open_db(old_file.c_str(), &old_db, old_header, portagesettings,
+		(print_header ? &old_count : NULLPTR));
 
 	format_for_new->set_overlay_translations(NULLPTR);
 
@@ -408,24 +845,45 @@ int run_eix_diff(int argc, char *argv[]) {
 	set_virtual(format_for_new, *new_header, eprefix_virtual);
 
 	DiffTrees differ(varpkg_db, portagesettings,
+		set_stability_old, set_stability_new,
 		rc.getBool("DIFF_ONLY_INSTALLED"),
 		!rc.getBool("DIFF_NO_SLOTS"),
 		rc.getBool("DIFF_SEPARATE_DELETED"));
 
-	if(likely(rc.getBool("DIFF_PRINT_HEADER"))) {
+	if(likely(print_header)) {
 		cout << eix::format(N_(
 			"Diffing databases (%s -> %s package)\n",
 			"Diffing databases (%s -> %s packages)\n",
-			new_tree.countPackages()))
-			% old_tree.countPackages()
-			% new_tree.countPackages();
+			new_count))
+			% old_count
+			% new_count;
 	}
 
 	differ.lost_package    = print_lost_package;
 	differ.found_package   = print_found_package;
 	differ.changed_package = print_changed_package;
 
-	differ.diff(&old_tree, &new_tree);
+	unsigned int jobs((cli_jobs == NULLPTR) ?
+		rc.getInteger("DIFF_JOBS") : my_atoi(cli_jobs));
+	jobs = ForkWorkers::jobs_setting(jobs);
+	Stats::start("diff");
+	ParallelDiff parallel(differ, old_file, old_db.tell(), new_file, new_db.tell());
+	if((jobs > 1) && parallel.start(jobs)) {
+		if(unlikely(!parallel.print())) {
+			cerr << _("a process for diffing in parallel failed") << endl;
+			return EXIT_FAILURE;
+		}
+	} else {
+		PackageReader old_reader(&old_db, *old_header, portagesettings);
+		PackageReader new_reader(&new_db, *new_header, portagesettings);
+		if(unlikely(!differ.diff(&old_reader, &new_reader))) {
+			const char *errtext(old_reader.get_errtext());
+			if(errtext != NULLPTR) {
+				db_error(old_file, errtext);
+			}
+			db_error(new_file, new_reader.get_errtext());
+		}
+	}
 	cout << format_for_new->color_end;
 
 	delete varpkg_db;
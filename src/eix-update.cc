@@ -9,11 +9,14 @@
 
 #include <config.h>
 
+#include <dirent.h>
 #include <fnmatch.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 
 #include <iostream>
 #include <list>
@@ -22,6 +25,7 @@
 
 #include "cache/cachetable.h"
 #include "database/header.h"
+#include "database/history.h"
 #include "database/io.h"
 #include "eixTk/argsreader.h"
 #include "eixTk/filenames.h"
@@ -31,6 +35,7 @@
 #include "eixTk/null.h"
 #include "eixTk/parseerror.h"
 #include "eixTk/percentage.h"
+#include "eixTk/stats.h"
 #include "eixTk/statusline.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/stringutils.h"
@@ -45,6 +50,7 @@
 #include "portage/overlay.h"
 #include "portage/packagetree.h"
 #include "various/drop_permissions.h"
+#include "various/watch.h"
 
 using std::list;
 using std::string;
@@ -65,6 +71,7 @@ class Pathname {
 	public:
 		bool is_a_match(const string& s) const {
 			if(must_resolve) {
+				Stats::count(Stats::FNMATCH_CALLS);
 				return !fnmatch(name.c_str(), s.c_str(), 0);
 			}
 			return s == name;
@@ -107,7 +114,13 @@ typedef vector<Override> Overrides;
 typedef vector<RepoName> RepoNames;
 
 static void print_help();
-static bool update(const char *outputfile, CacheTable *cache_table, PortageSettings *portage_settings, bool override_umask, const RepoNames& repo_names, const WordVec& exclude_labels, Statusline *statusline, string *errtext) ATTRIBUTE_NONNULL_;
+static bool update(const char *outputfile, CacheTable *cache_table, PortageSettings *portage_settings, PackageTree *package_tree, DBHeader *dbheader, bool override_umask, const RepoNames& repo_names, const WordVec& exclude_labels, Statusline *statusline, string *errtext) ATTRIBUTE_NONNULL_;
+static void read_category(CacheTable *cache_table, Category *category, const char *cat_name) ATTRIBUTE_NONNULL_;
+static void apply_masks(Category *category, PortageSettings *portage_settings) ATTRIBUTE_NONNULL_;
+static bool write_database(const char *outputfile, DBHeader *dbheader, const PackageTree& package_tree, bool override_umask, bool atomic, Statusline *statusline, string *errtext) ATTRIBUTE_NONNULL_;
+static void add_watches(Watcher *watcher, const CacheTable& cache_table, const PackageTree& package_tree, EixRc *eixrc) ATTRIBUTE_NONNULL_;
+static int watch_database(char *argv[], const char *outputfile, CacheTable *cache_table, PortageSettings *portage_settings, PackageTree *package_tree, DBHeader *dbheader, bool override_umask, EixRc *eixrc, Statusline *statusline) ATTRIBUTE_NONNULL_;
+static int nodot_selector(SCANDIR_ARG3 dent);
 static void error_callback(const string& str);
 static void add_pathnames(PathVec *add_list, const WordVec& to_add, bool must_resolve) ATTRIBUTE_NONNULL_;
 static void add_override(Overrides *override_list, EixRc *eixrc, const char *s) ATTRIBUTE_NONNULL_;
@@ -130,8 +143,11 @@ static void print_help() {
 "     --force-status      always output status line\n"
 " -F, --force-color       force \"color\" even if output is no terminal\n"
 " -v, --verbose           output used cache method for each ebuild\n"
+"     --stats (toggle)    print timing statistics to stderr at exit\n"
 "\n"
 " -q, --quiet             produce no output\n"
+"     --watch             keep running and update the database when the\n"
+"                         metadata or the configuration changes\n"
 "\n"
 " -o  --output            output to another file than %s\n"
 "                         In addition, all permission checks are omitted.\n"
@@ -154,7 +170,9 @@ enum cli_options {
 	O_DUMP_DEFAULTS,
 	O_KNOWN_VARS,
 	O_PRINT_VAR,
-	O_FORCE_STATUS
+	O_FORCE_STATUS,
+	O_WATCH,
+	O_STATS
 };
 
 static bool
@@ -163,9 +181,10 @@ static bool
 	show_version(false),
 	known_vars(false),
 	dump_eixrc(false),
-	dump_defaults(false);
+	dump_defaults(false),
+	watch_mode(false);
 
-static bool use_percentage, use_status, verbose;
+static bool use_percentage, use_status, verbose, stats, split_names, names_index;
 
 typedef list<const char *> ExcludeArgs;
 typedef ExcludeArgs AddArgs;
@@ -180,6 +199,11 @@ static RepoArgs *repo_args;
 static const char *outputname = NULLPTR;
 static const char *var_to_print = NULLPTR;
 
+/**
+If nonempty, each written database is appended as a generation
+**/
+static string history_file;
+
 /**
 Arguments and options
 **/
@@ -201,6 +225,8 @@ EixUpdateOptionList::EixUpdateOptionList() {
 	push_back(Option("force-color",    'F',     Option::BOOLEAN_T,  &use_percentage));
 	push_back(Option("force-status", O_FORCE_STATUS, Option::BOOLEAN_T, &use_status));
 	push_back(Option("verbose",        'v',     Option::BOOLEAN_T,  &verbose));
+	push_back(Option("watch",          O_WATCH, Option::BOOLEAN_T,  &watch_mode));
+	push_back(Option("stats",          O_STATS, Option::BOOLEAN,    &stats));
 
 	push_back(Option("exclude-overlay", 'x',    Option::STRINGLIST, exclude_args));
 	push_back(Option("add-overlay",    'a',     Option::STRINGLIST, add_args));
@@ -304,6 +330,7 @@ int run_eix_update(int argc, char *argv[]) {
 	repo_args = new RepoArgs;
 
 	/* Setup eixrc. */
+	Stats::start("eixrc");
 	EixRc& eixrc(get_eixrc(UPDATE_VARS_PREFIX)); {
 		string errtext;
 		bool success(drop_permissions(&eixrc, &errtext));
@@ -316,6 +343,8 @@ int run_eix_update(int argc, char *argv[]) {
 	}
 	Depend::use_depend = eixrc.getBool("DEP");
 	Version::use_required_use = eixrc.getBool("REQUIRED_USE");
+	split_names = eixrc.getBool("SPLIT_NAMES");
+	names_index = eixrc.getBool("NAMES_INDEX");
 	string eix_cachefile(eixrc["EIX_CACHEFILE"]); {
 	/* calculate defaults for use_{percentage,status} */
 		bool percentage_tty(false);
@@ -349,9 +378,11 @@ int run_eix_update(int argc, char *argv[]) {
 
 	/* other defaults */
 	verbose = eixrc.getBool("UPDATE_VERBOSE");
+	stats = eixrc.getBool("EIX_STATS");
 
 	/* Setup ArgumentReader. */
 	ArgumentReader argreader(argc, argv, EixUpdateOptionList());
+	Stats::enable(stats);
 
 	/* We do not want any arguments except options */
 	if(unlikely(argreader.begin() != argreader.end())) {
@@ -396,6 +427,8 @@ int run_eix_update(int argc, char *argv[]) {
 	if(unlikely(outputname != NULLPTR)) {
 		outputfile = outputname;
 		override_umask = false;
+	} else {
+		history_file = eixrc["EIX_HISTORY"];
 	}
 
 	Statusline statusline(use_status, (use_status &&
@@ -405,6 +438,7 @@ int run_eix_update(int argc, char *argv[]) {
 
 	ParseError parse_error;
 	INFO(_("Reading Portage settings...\n"));
+	Stats::start("settings");
 	PortageSettings portage_settings(&eixrc, &parse_error, false, true);
 
 	/* Build default (overlay/method/...) lists, using environment vars */
@@ -546,15 +580,24 @@ int run_eix_update(int argc, char *argv[]) {
 	INFO(eix::format(_("Building database (%s)...\n")) % outputfile);
 
 	/* Update the database from scratch */
+	DBHeader dbheader;
+	WordVec categories;
+	portage_settings.pushback_categories(&categories);
+	PackageTree package_tree(categories);
 	string errtext;
-	if(unlikely(!update(outputfile.c_str(), &table, &portage_settings, override_umask,
+	if(unlikely(!update(outputfile.c_str(), &table, &portage_settings,
+			&package_tree, &dbheader, override_umask,
 			repo_names, excluded_overlays, &statusline, &errtext))) {
 		cerr << errtext << endl;
 		statusline.failure();
 		return EXIT_FAILURE;
 	}
 	statusline.success();
-	return EXIT_SUCCESS;
+	if(likely(!watch_mode)) {
+		return EXIT_SUCCESS;
+	}
+	return watch_database(argv, outputfile.c_str(), &table, &portage_settings,
+		&package_tree, &dbheader, override_umask, &eixrc, &statusline);
 }
 
 static void error_callback(const string& str) {
@@ -563,13 +606,8 @@ static void error_callback(const string& str) {
 	reading_percent_status->interprint_end();
 }
 
-static bool update(const char *outputfile, CacheTable *cache_table, PortageSettings *portage_settings, bool override_umask, const RepoNames& repo_names, const WordVec& exclude_labels, Statusline *statusline, string *errtext) {
-	DBHeader dbheader;
-	WordVec categories;
-	portage_settings->pushback_categories(&categories);
-	PackageTree package_tree(categories);
-
-	dbheader.world_sets = *(portage_settings->get_world_sets());
+static bool update(const char *outputfile, CacheTable *cache_table, PortageSettings *portage_settings, PackageTree *package_tree, DBHeader *dbheader, bool override_umask, const RepoNames& repo_names, const WordVec& exclude_labels, Statusline *statusline, string *errtext) {
+	dbheader->world_sets = *(portage_settings->get_world_sets());
 
 	/* We must first initialize all caches and erase unneeded ones,
 	   because some cache methods like eixcache know about each other
@@ -591,7 +629,7 @@ static bool update(const char *outputfile, CacheTable *cache_table, PortageSetti
 			it = cache_table->erase(it);
 			continue;
 		}
-		ExtendedVersion::Overlay key(dbheader.addOverlay(overlay));
+		ExtendedVersion::Overlay key(dbheader->addOverlay(overlay));
 		cache->setKey(key);
 		cache->setOverlayName(overlay.label);
 		// cache->setArch((*portage_settings)["ARCH"]);
@@ -606,6 +644,9 @@ static bool update(const char *outputfile, CacheTable *cache_table, PortageSetti
 	for(CacheTable::iterator it(cache_table->begin());
 		likely(it != cache_table->end()); ++it) {
 		BasicCache *cache(*it);
+		if(unlikely(Stats::recording())) {
+			Stats::start(string("cache ") + cache->getType() + " " + cache->getPathHumanReadable());
+		}
 		INFO(eix::format(_("[%s] \"%s\" %s (cache: %s)\n"))
 			% cache->getKey()
 			% cache->getOverlayName()
@@ -620,27 +661,27 @@ static bool update(const char *outputfile, CacheTable *cache_table, PortageSetti
 				"     Reading Packages..."));
 			cache->setErrorCallback(error_callback);
 			reading_percent_status->finish(
-				likely(cache->readCategories(&package_tree)) ?
+				likely(cache->readCategories(package_tree)) ?
 				P_("Percent", "Finished") :
 				P_("Percent", "ABORTED!"));
 		} else {
 			if(use_percentage) {
 				reading_percent_status->init(P_("Percent",
 					"     Reading category %s|%s (%s%%)"),
-					package_tree.size());
+					package_tree->size());
 			} else {
 				reading_percent_status->init(eix::format(NP_("Percent",
 					"     Reading %s category of packages...",
 					"     Reading up to %s categories of packages...",
-					package_tree.size()))
-					% package_tree.size());
+					package_tree->size()))
+					% package_tree->size());
 			}
 
 			/* iterator through categories */
 			bool aborted(false);
 			bool is_empty(true);
-			for(PackageTree::const_iterator ci(package_tree.begin());
-				unlikely(ci != package_tree.end()); ++ci) {
+			for(PackageTree::const_iterator ci(package_tree->begin());
+				unlikely(ci != package_tree->end()); ++ci) {
 				if(!cache->readCategoryPrepare(ci->first.c_str())) {
 					if(use_percentage) {
 						reading_percent_status->next();
@@ -669,48 +710,203 @@ static bool update(const char *outputfile, CacheTable *cache_table, PortageSetti
 	statusline->print(P_("Statusline eix-update", "Analyzing"));
 
 	/* Now apply all masks... */
+	Stats::start("masks");
 	INFO(_("Applying masks...\n"));
-	for(PackageTree::iterator c(package_tree.begin());
-		likely(c != package_tree.end()); ++c) {
-		Category *ci = c->second;
-		for(Category::iterator p(ci->begin());
-			likely(p != ci->end()); ++p) {
-			portage_settings->setMasks(*p);
-			p->save_maskflags(Version::SAVEMASK_FILE);
+	for(PackageTree::iterator c(package_tree->begin());
+		likely(c != package_tree->end()); ++c) {
+		apply_masks(c->second, portage_settings);
+	}
+	return write_database(outputfile, dbheader, *package_tree, override_umask, false, statusline, errtext);
+}
+
+static void read_category(CacheTable *cache_table, Category *category, const char *cat_name) {
+	for(CacheTable::iterator it(cache_table->begin());
+		likely(it != cache_table->end()); ++it) {
+		BasicCache *cache(*it);
+		Stats::Timer timer;
+		if(unlikely(Stats::enabled())) {
+			timer.start(string("cache ") + cache->getType() + " " + cache->getPathHumanReadable());
+		}
+		if(cache->can_read_multiple_categories()) {
+			cache->readCategories(NULLPTR, cat_name, category);
+			continue;
+		}
+		if(cache->readCategoryPrepare(cat_name)) {
+			cache->readCategory(category);
 		}
+		cache->readCategoryFinalize();
 	}
+}
+
+static void apply_masks(Category *category, PortageSettings *portage_settings) {
+	for(Category::iterator p(category->begin());
+		likely(p != category->end()); ++p) {
+		portage_settings->setMasks(*p);
+		p->save_maskflags(Version::SAVEMASK_FILE);
+	}
+}
 
+/**
+@arg atomic write to a temporary file which is then renamed
+**/
+static bool write_database(const char *outputfile, DBHeader *dbheader, const PackageTree& package_tree, bool override_umask, bool atomic, Statusline *statusline, string *errtext) {
+	Stats::start("hashes");
 	INFO(_("Calculating hash tables...\n"));
-	Database::prep_header_hashs(&dbheader, package_tree);
+	Database::prep_header_hashs(dbheader, package_tree);
+	dbheader->names_first = split_names;
+	dbheader->names_index = names_index;
 
 	/* And write database back to disk... */
+	Stats::start("write");
 	statusline->print(eix::format(P_("Statusline eix-update", "Creating %s")) % outputfile);
 	INFO(eix::format(_("Writing database file %s...\n")) % outputfile);
-	mode_t old_umask;
-	if(override_umask) {
-		old_umask = umask(2);
-	}
-	Database db;
-	bool ok(db.openwrite(outputfile));
-	if(override_umask) {
-		umask(old_umask);
-	}
-	if(unlikely(!ok)) {
-		*errtext = eix::format(_("cannot open database file %s for writing (mode = 'wb')")) % outputfile;
-		return false;
-	}
+	string writefile(outputfile);
+	if(atomic) {
+		writefile.append(".new");
+		unlink(writefile.c_str());
+	}
+	{
+		mode_t old_umask;
+		if(override_umask) {
+			old_umask = umask(2);
+		}
+		Database db;
+		bool ok(db.openwrite(writefile.c_str()));
+		if(override_umask) {
+			umask(old_umask);
+		}
+		if(unlikely(!ok)) {
+			*errtext = eix::format(_("cannot open database file %s for writing (mode = 'wb')")) % writefile;
+			return false;
+		}
 
-	dbheader.size = package_tree.countCategories();
+		dbheader->size = package_tree.countCategories();
 
-	if(!(likely(db.write_header(dbheader, errtext)) &&
-		likely(db.write_packagetree(package_tree, dbheader, errtext)))) {
+		if(!(likely(db.write_header(*dbheader, errtext)) &&
+			likely(db.write_packagetree(package_tree, *dbheader, errtext)))) {
+			return false;
+		}
+	}
+	if(atomic && unlikely(rename(writefile.c_str(), outputfile) != 0)) {
+		*errtext = eix::format(_("cannot rename %s to %s: %s"))
+			% writefile % outputfile % strerror(errno);
 		return false;
 	}
 
 	INFO(eix::format(N_(
 		"Database contains %s packages in %s category.\n",
 		"Database contains %s packages in %s categories.\n",
-		dbheader.size))
-		% package_tree.countPackages() % dbheader.size);
+		dbheader->size))
+		% package_tree.countPackages() % dbheader->size);
+
+	if(!history_file.empty()) {
+		Stats::start("history");
+		INFO(eix::format(_("Appending to history file %s...\n")) % history_file);
+		string history_error;
+		if(unlikely(!DBHistory::append(history_file.c_str(), *dbheader,
+				package_tree, &history_error))) {
+			cerr << history_error << endl;
+		}
+	}
 	return true;
 }
+
+static int nodot_selector(SCANDIR_ARG3 dent) {
+	return (dent->d_name[0] != '.');
+}
+
+/**
+Watch the metadata and the package directories of all repositories:
+changes re-read the category.
+Changes in the configuration or profiles require a restart.
+**/
+static void add_watches(Watcher *watcher, const CacheTable& cache_table, const PackageTree& package_tree, EixRc *eixrc) {
+	bool complete(true);
+	for(CacheTable::const_iterator it(cache_table.begin());
+		likely(it != cache_table.end()); ++it) {
+		string path(it->getPrefixedPath());
+		optional_append(&path, '/');
+		watcher->add_restart(path + "profiles", "");
+		string md5(path + "metadata/md5-cache");
+		watcher->add(md5, "");
+		md5.append(1, '/');
+		for(PackageTree::const_iterator c(package_tree.begin());
+			likely(c != package_tree.end()); ++c) {
+			watcher->add(md5 + c->first, c->first);
+			if(unlikely(!watcher->add_tree(path + c->first, c->first))) {
+				complete = false;
+			}
+		}
+	}
+	if(unlikely(!complete)) {
+		cerr << _("warning: not all package directories can be watched; increase fs.inotify.max_user_watches") << endl;
+	}
+	string conf(eixrc->m_eprefixconf + "/etc");
+	watcher->add_restart(conf, "make.conf");
+	conf.append("/portage");
+	watcher->add_restart(conf, "");
+	WordVec subdirs;
+	if(scandir_cc(conf, &subdirs, nodot_selector, false)) {
+		for(WordVec::const_iterator it(subdirs.begin());
+			likely(it != subdirs.end()); ++it) {
+			watcher->add_restart(conf + "/" + (*it), "");
+		}
+	}
+	const string& world_sets((*eixrc)["EIX_WORLD_SETS"]);
+	string::size_type slash(world_sets.rfind('/'));
+	if(slash != string::npos) {
+		watcher->add_restart(world_sets.substr(0, slash),
+			world_sets.substr(slash + 1));
+	}
+}
+
+static int watch_database(char *argv[], const char *outputfile, CacheTable *cache_table, PortageSettings *portage_settings, PackageTree *package_tree, DBHeader *dbheader, bool override_umask, EixRc *eixrc, Statusline *statusline) {
+	Watcher watcher;
+	string errtext;
+	if(unlikely(!watcher.init(&errtext))) {
+		cerr << errtext << endl;
+		return EXIT_FAILURE;
+	}
+	add_watches(&watcher, *cache_table, *package_tree, eixrc);
+	unsigned int delay(eixrc->getInteger("UPDATE_WATCH_DELAY"));
+	reading_percent_status = new PercentStatus;
+	for(bool changed(true); ; ) {
+		if(changed) {
+			INFO(_("Watching for changes...\n"));
+			cout.flush();
+		}
+		Watcher::Names touched;
+		bool restart;
+		if(unlikely(!watcher.wait(delay, &touched, &restart, &errtext))) {
+			cerr << errtext << endl;
+			return EXIT_FAILURE;
+		}
+		if(restart) {
+			INFO(_("Configuration has changed; restarting...\n"));
+			cout.flush();
+			execvp(argv[0], argv);
+			cerr << eix::format(_("cannot execute %s: %s")) % argv[0] % strerror(errno) << endl;
+			return EXIT_FAILURE;
+		}
+		changed = false;
+		for(Watcher::Names::const_iterator it(touched.begin());
+			likely(it != touched.end()); ++it) {
+			Category *category(package_tree->find(*it));
+			if(category == NULLPTR) {
+				continue;
+			}
+			INFO(eix::format(_("Reading category %s...\n")) % (*it));
+			changed = true;
+			category->delete_and_clear();
+			read_category(cache_table, category, it->c_str());
+			apply_masks(category, portage_settings);
+		}
+		if(!changed) {
+			continue;
+		}
+		if(unlikely(!write_database(outputfile, dbheader, *package_tree,
+				override_umask, true, statusline, &errtext))) {
+			cerr << errtext << endl;
+		}
+	}
+}
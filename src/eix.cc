@@ -14,12 +14,13 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
 #include <iostream>
-#include <map>
 #include <string>
 
 #include "database/header.h"
 #include "database/io.h"
+#include "database/names_index.h"
 #include "database/package_reader.h"
 #include "eixTk/ansicolor.h"
 #include "eixTk/argsreader.h"
@@ -30,17 +31,22 @@
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/outputsink.h"
 #include "eixTk/outputstring.h"
 #include "eixTk/parseerror.h"
 #include "eixTk/ptr_list.h"
+#include "eixTk/stats.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/stringutils.h"
 #include "eixTk/utils.h"
+#include "eixTk/workers.h"
 #include "eixrc/eixrc.h"
 #include "eixrc/global.h"
 #include "main/main.h"
 #include "output/formatstring-print.h"
 #include "output/formatstring.h"
+#include "output/print-json.h"
+#include "output/print-parallel.h"
 #include "output/print-xml.h"
 #include "portage/basicversion.h"
 #include "portage/conf/portagesettings.h"
@@ -52,6 +58,7 @@
 #include "portage/vardbpkg.h"
 #include "search/algorithms.h"
 #include "search/matchtree.h"
+#include "search/package_index.h"
 #include "search/packagetest.h"
 #include "various/cli.h"
 #include "various/drop_permissions.h"
@@ -60,7 +67,6 @@
 
 template<typename m_Type> class MaskList;
 
-using std::map;
 using std::string;
 
 using std::cerr;
@@ -70,16 +76,22 @@ using std::endl;
 static void dump_help();
 static bool opencache(Database *db, const char *filename, const char *tooltext) ATTRIBUTE_NONNULL_;
 static bool print_overlay_table(PrintFormat *fmt, DBHeader *header, PrintFormat::OverlayUsed *overlay_used) ATTRIBUTE_NONNULL((1, 2));
+static void mark_overlays(const Package *p, bool *need_overlay_table, PrintFormat::OverlayUsed *overlay_used) ATTRIBUTE_NONNULL_;
+static unsigned int print_jobs_setting(EixRc *rc) ATTRIBUTE_NONNULL_;
 static void parseFormat(const char *sourcename, const char *content) ATTRIBUTE_NONNULL_;
 static void set_format(EixRc *rc) ATTRIBUTE_NONNULL_;
 static void setup_defaults(EixRc *rc, bool is_tty) ATTRIBUTE_NONNULL_;
 static bool is_current_dbversion(const char *filename, const char *tooltext) ATTRIBUTE_NONNULL_;
+static bool print_completion(const char *filename, const char *tooltext, const string& prefix) ATTRIBUTE_NONNULL((1, 2));
+static bool match_timed(MatchTree *matchtree, PackageReader *reader) ATTRIBUTE_NONNULL_;
+static bool earlier(const NamesIndex::Entry& a, const NamesIndex::Entry& b);
+static bool match_installed(Database *db, const DBHeader& header, PortageSettings *ps, VarDbPkg *varpkg_db, NamesIndex *index, MatchTree *matchtree, eix::ptr_list<Package> *matches, bool only_printed, PrintXml *json_stream, const SetStability *stability) ATTRIBUTE_NONNULL((1, 3, 4, 5, 6, 7, 10));
 static void print_wordvec(const WordVec& vec);
-static void print_unused(const string& filename, const string& excludefiles, const eix::ptr_list<Package>& packagelist, bool test_empty);
-static void print_removed(const string& dirname, const string& excludefiles, const eix::ptr_list<Package>& packagelist);
-inline static void print_unused(const string& filename, const string& excludefiles, const eix::ptr_list<Package>& packagelist);
-inline static void print_unused(const string& filename, const string& excludefiles, const eix::ptr_list<Package>& packagelist) {
-	print_unused(filename, excludefiles, packagelist, false);
+static void print_unused(const string& filename, const string& excludefiles, const PackageIndex& packages, bool test_empty);
+static void print_removed(const string& dirname, const string& excludefiles, const PackageIndex& packages);
+inline static void print_unused(const string& filename, const string& excludefiles, const PackageIndex& packages);
+inline static void print_unused(const string& filename, const string& excludefiles, const PackageIndex& packages) {
+	print_unused(filename, excludefiles, packages, false);
 }
 
 /**
@@ -116,6 +128,8 @@ static void dump_help() {
 "                           (needs DEP=true)\n"
 "     --print-world-sets    print the world sets\n"
 "     --print-profile-paths print all paths of current profile\n"
+"     --complete PREFIX     print categories/ and names (or category/name if\n"
+"                           PREFIX contains /) starting with PREFIX\n"
 "     --256                 Print all ansi color palettes\n"
 "     --256d                Print ansi color palettes for foreground (dark)\n"
 "     --256d0               Print ansi color palette dark (normal)\n"
@@ -134,6 +148,7 @@ static void dump_help() {
 "         --care            always read slots of installed packages\n"
 "         --deps-installed  always read deps of installed packages\n"
 "         --cache-file      use another cache-file instead of %s\n"
+"         --stats (toggle)  print timing statistics to stderr at exit\n"
 "     -R  --remote (toggle)  use remote cache-file %s\n"
 "     -Z  --remote2 (toggle) use remote cache-file %s\n"
 "\n"
@@ -149,6 +164,7 @@ static void dump_help() {
 "                            Usually faster with COUNT_ONLY_PRINTED=false\n"
 "         --brief2 (toggle)  Print at most two packages then stop\n"
 "     --xml (toggle)         output results in XML format\n"
+"     --json (toggle)        output results as JSON, one package per line\n"
 "     -c, --compact          compact search results\n"
 "     -v, --verbose          verbose search results\n"
 "     -N, --normal           ignores -c, -v, and DEFAULT_FORMAT\n"
@@ -209,6 +225,10 @@ static void dump_help() {
 "    --properties-live         Match packages with PROPERTIES=live\n"
 "    --properties-virtual      Match packages with PROPERTIES=virtual\n"
 "    --properties-set          Match packages with PROPERTIES=set\n"
+"    --rdeps ATOM          Match packages with a dependency on category/name\n"
+"                          of ATOM (on name in any category if ATOM has no\n"
+"                          category; with --depend etc. only of this class;\n"
+"                          needs DEP=true)\n"
 "    -T, --test-obsolete   Match packages with obsolete entries in\n"
 "                          /etc/portage/package.* (see man eix)\n"
 "                          Use -t to check non-existing packages\n"
@@ -259,6 +279,7 @@ static void dump_help() {
 static const char *formatstring;
 static const char *eix_cachefile(NULLPTR);
 static const char *var_to_print(NULLPTR);
+static const char *complete_prefix(NULLPTR);
 
 enum OverlayMode {
 	mode_list_used_renumbered  = 0,
@@ -308,8 +329,10 @@ static struct LocalOptions {
 		dump_defaults,
 		known_vars,
 		xml,
+		json,
 		test_unused,
 		do_debug,
+		stats,
 		ignore_etc_portage,
 		is_current,
 		remote,
@@ -362,6 +385,7 @@ EixOptionList::EixOptionList() {
 	push_back(Option("compact",       'c',     Option::BOOLEAN_T,     &rc_options.compact_output));
 	push_back(Option("normal",        'N',     Option::BOOLEAN_T,     &rc_options.normal_output));
 	push_back(Option("xml",           O_XML,   Option::BOOLEAN,       &rc_options.xml));
+	push_back(Option("json",          O_JSON,  Option::BOOLEAN,       &rc_options.json));
 	push_back(Option("help",          'h',     Option::BOOLEAN_T,     &rc_options.show_help));
 	push_back(Option("version",       'V',     Option::BOOLEAN_T,     &rc_options.show_version));
 	push_back(Option("dump",          O_DUMP,  Option::BOOLEAN_T,     &rc_options.dump_eixrc));
@@ -369,6 +393,7 @@ EixOptionList::EixOptionList() {
 	push_back(Option("known-vars",   O_KNOWN_VARS, Option::BOOLEAN_T, &rc_options.known_vars));
 	push_back(Option("test-non-matching", 't', Option::BOOLEAN_T,     &rc_options.test_unused));
 	push_back(Option("debug",         O_DEBUG, Option::BOOLEAN_T,     &rc_options.do_debug));
+	push_back(Option("stats",         O_STATS, Option::BOOLEAN,       &rc_options.stats));
 
 	push_back(Option("print-all-eapis",     O_HASH_EAPI,     Option::BOOLEAN_T, &rc_options.hash_eapi));
 	push_back(Option("print-all-useflags",  O_HASH_IUSE,     Option::BOOLEAN_T, &rc_options.hash_iuse));
@@ -382,6 +407,7 @@ EixOptionList::EixOptionList() {
 	push_back(Option("ignore-etc-portage",  O_IGNORE_ETC_PORTAGE, Option::BOOLEAN_T,  &rc_options.ignore_etc_portage));
 
 	push_back(Option("print",               O_PRINT_VAR,    Option::STRING,     &var_to_print));
+	push_back(Option("complete",            O_COMPLETE,     Option::STRING,     &complete_prefix));
 
 	push_back(Option("format",         O_FMT,         Option::STRING,   &formatstring));
 
@@ -446,6 +472,7 @@ EixOptionList::EixOptionList() {
 	push_back(Option("properties-live",        O_PROPERTIES_LIVE));
 	push_back(Option("properties-virtual",     O_PROPERTIES_VIRTUAL));
 	push_back(Option("properties-set",         O_PROPERTIES_SET));
+	push_back(Option("rdeps",         O_RDEPS,       Option::KEEP_STRING));
 	push_back(Option("dup-packages",  'd'));
 	push_back(Option("dup-versions",  'D'));
 	push_back(Option("test-obsolete", 'T'));
@@ -505,6 +532,7 @@ static void setup_defaults(EixRc *rc, bool is_tty) {
 
 	rc_options.quick           = rc->getBool("QUICKMODE");
 	rc_options.be_quiet        = rc->getBool("QUIETMODE");
+	rc_options.stats           = rc->getBool("EIX_STATS");
 	rc_options.care            = rc->getBool("CAREMODE");
 	rc_options.deps_installed  = rc->getBool("DEPS_INSTALLED");
 	switch(rc->getInteger("REMOTE_DEFAULT")) {
@@ -565,6 +593,27 @@ static bool print_overlay_table(PrintFormat *fmt, DBHeader *header, PrintFormat:
 	return printed_overlay;
 }
 
+static void mark_overlays(const Package *p, bool *need_overlay_table, PrintFormat::OverlayUsed *overlay_used) {
+	if(p->largest_overlay == 0) {
+		return;
+	}
+	*need_overlay_table = true;
+	if(overlay_mode > mode_list_used) {
+		return;
+	}
+	for(Package::const_iterator ver(p->begin());
+		likely(ver != p->end()); ++ver) {
+		ExtendedVersion::Overlay key(ver->overlay_key);
+		if(key > 0) {
+			(*overlay_used)[key - 1] = true;
+		}
+	}
+}
+
+static unsigned int print_jobs_setting(EixRc *rc) {
+	return ForkWorkers::jobs_setting(rc->getInteger("PRINT_JOBS"));
+}
+
 static void parseFormat(const char *sourcename, const char *content) {
 	string errtext;
 	if(likely(format->parseFormat(content, &errtext))) {
@@ -613,6 +662,7 @@ int run_eix(int argc, char** argv) {
 	PrintFormat::init_static();
 	format = new PrintFormat(get_package_property);
 
+	Stats::start("eixrc");
 	EixRc& eixrc(get_eixrc(EIX_VARS_PREFIX)); {
 		string errtext;
 		bool success(drop_permissions(&eixrc, &errtext));
@@ -630,6 +680,7 @@ int run_eix(int argc, char** argv) {
 
 	// Read our options from the commandline.
 	ArgumentReader argreader(argc, argv, EixOptionList());
+	Stats::enable(rc_options.stats);
 
 	if(unlikely(rc_options.ansi)) {
 		AnsiColor::AnsiPalette();
@@ -684,6 +735,11 @@ int run_eix(int argc, char** argv) {
 		return (is_current_dbversion(cachefile.c_str(), tooltext) ? EXIT_SUCCESS : EXIT_FAILURE);
 	}
 
+	// Complete names for shells without reading the settings
+	if(unlikely(complete_prefix != NULLPTR)) {
+		return (print_completion(cachefile.c_str(), tooltext, complete_prefix) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
 	// Show version
 	if(unlikely(rc_options.show_version)) {
 		dump_version();
@@ -696,7 +752,10 @@ int run_eix(int argc, char** argv) {
 			cerr << eix::format(_("cannot redirect to \"%s\"")) % DEV_NULL << endl;
 			return EXIT_FAILURE;
 		}
-	} {  // Print color palette if requested
+	}
+	OutputSink::init();
+
+	{  // Print color palette if requested
 		AnsiColor::WhichPalette palette;
 		if(unlikely(rc_options.palette256)) {
 			palette = AnsiColor::PALETTE_ALL;
@@ -732,7 +791,7 @@ int run_eix(int argc, char** argv) {
 
 	bool only_printed;
 
-	if(unlikely(rc_options.xml)) {
+	if(unlikely(rc_options.xml || rc_options.json)) {
 		rc_options.pure_packages = format->no_color = true;
 		only_printed = false;
 	} else {
@@ -753,6 +812,7 @@ int run_eix(int argc, char** argv) {
 	}
 
 	parse_error = new ParseError(rc_options.no_warn);
+	Stats::start("settings");
 	PortageSettings portagesettings(&eixrc, parse_error, true, false, rc_options.print_profile_paths);
 	if(unlikely(rc_options.print_profile_paths)) {
 		return EXIT_SUCCESS;
@@ -769,6 +829,7 @@ int run_eix(int argc, char** argv) {
 	MaskList<Mask> *marked_list(NULLPTR);
 
 	/* Open database file */
+	Stats::start("header");
 	Database db;
 	if(unlikely(!opencache(&db, cachefile.c_str(), tooltext))) {
 		return EXIT_FAILURE;
@@ -841,49 +902,79 @@ int run_eix(int argc, char** argv) {
 	SetStability stability(&portagesettings, !rc_options.ignore_etc_portage, false, eixrc.getBool("ALWAYS_ACCEPT_KEYWORDS"));
 
 	MatchTree *matchtree = new MatchTree(eixrc.getBool("DEFAULT_IS_OR"));
-	parse_cli(matchtree, &eixrc, &varpkg_db, &portagesettings, format, &stability, &header, parse_error, &marked_list, argreader);
+	parse_cli(matchtree, &eixrc, &varpkg_db, &portagesettings, format, &stability, &header, &db, parse_error, &marked_list, argreader);
+
+	// With --json, print each package as soon as it matches unless the
+	// matches are sorted afterwards or the unused entries are printed first
+	PrintXml *json_stream(NULLPTR);
+	if(unlikely(rc_options.json) && !FuzzyAlgorithm::used() && !rc_options.test_unused) {
+		json_stream = new PrintJson(&header, &varpkg_db, format, &stability, &eixrc,
+			portagesettings["PORTDIR"]);
+		json_stream->start();
+	}
 
 	eix::ptr_list<Package> matches;
-	eix::ptr_list<Package> all_packages; {
-		PackageReader reader(&db, header, &portagesettings);
-		bool add_rest(false);
-		while(likely(reader.next())) {
-			if(unlikely(add_rest)) {
-				all_packages.push_back(reader.release());
-			} else if(unlikely(matchtree->match(&reader))) {
-				Package *release(reader.release());
-				if(unlikely(release == NULLPTR)) {
-					break;
-				}
-				matches.push_back(release);
-				if(unlikely(only_printed &&
-					(rc_options.brief ||
-						(rc_options.brief2 && (matches.size() > 1))))) {
-					if(unlikely(rc_options.test_unused)) {
-						add_rest = true;
-					} else {
+	PackageIndex all_packages; {
+		Stats::start("scan");
+		NamesIndex index;
+		eix::OffsetType start(db.tell());
+		if(header.names_index && likely(!rc_options.test_unused) &&
+			matchtree->requires_installed() && index.read_trailer(&db)) {
+			if(unlikely(!match_installed(&db, header, &portagesettings, &varpkg_db, &index, matchtree, &matches, only_printed, json_stream, &stability))) {
+				return EXIT_FAILURE;
+			}
+		} else {
+			string errtext;
+			if(unlikely(!db.seekabs(start, &errtext))) {
+				cerr << errtext << endl;
+				return EXIT_FAILURE;
+			}
+			PackageReader reader(&db, header, &portagesettings);
+			bool add_rest(false);
+			while(likely(reader.next())) {
+				if(unlikely(add_rest)) {
+					if(unlikely(!reader.read(PackageReader::VERSIONS))) {
 						break;
 					}
-				}
-				if(unlikely(rc_options.test_unused)) {
-					all_packages.push_back(release);
-				}
-			} else {
-				if(unlikely(rc_options.test_unused)) {
+					all_packages.add(*reader.get());
+				} else if(unlikely(Stats::enabled() ? match_timed(matchtree, &reader) : matchtree->match(&reader))) {
 					Package *release(reader.release());
 					if(unlikely(release == NULLPTR)) {
 						break;
 					}
-					all_packages.push_back(release);
-				} else if(unlikely(!reader.skip())) {
-					break;
+					matches.push_back(release);
+					if(unlikely(json_stream != NULLPTR)) {
+						stability.set_stability(release);
+						json_stream->package(release);
+					}
+					if(unlikely(only_printed &&
+						(rc_options.brief ||
+							(rc_options.brief2 && (matches.size() > 1))))) {
+						if(unlikely(rc_options.test_unused)) {
+							add_rest = true;
+						} else {
+							break;
+						}
+					}
+					if(unlikely(rc_options.test_unused)) {
+						all_packages.add(*release);
+					}
+				} else {
+					if(unlikely(rc_options.test_unused)) {
+						if(unlikely(!reader.read(PackageReader::VERSIONS))) {
+							break;
+						}
+						all_packages.add(*reader.get());
+					} else if(unlikely(!reader.skip())) {
+						break;
+					}
 				}
 			}
-		}
-		const char *err_cstr(reader.get_errtext());
-		if(unlikely(err_cstr != NULLPTR)) {
-			cerr << err_cstr << endl;
-			return EXIT_FAILURE;
+			const char *err_cstr(reader.get_errtext());
+			if(unlikely(err_cstr != NULLPTR)) {
+				cerr << err_cstr << endl;
+				return EXIT_FAILURE;
+			}
 		}
 	}
 
@@ -891,6 +982,7 @@ int run_eix(int argc, char** argv) {
 	delete matchtree;
 
 	if(unlikely(rc_options.test_unused)) {
+		Stats::start("unused");
 		bool empty(eixrc.getBool("TEST_FOR_EMPTY"));
 		if(likely(eixrc.getBool("TEST_KEYWORDS"))) {
 			print_unused(eixrc.m_eprefixconf + USER_KEYWORDS_FILE1,
@@ -940,6 +1032,7 @@ int run_eix(int argc, char** argv) {
 		}
 	}
 
+	Stats::start("format");
 	/* Sort the found matches by rating */
 	if(unlikely(FuzzyAlgorithm::sort_by_levenshtein())) {
 		matches.sort(FuzzyAlgorithm::compare);
@@ -953,12 +1046,18 @@ int run_eix(int argc, char** argv) {
 	PrintFormat::OverlayUsed overlay_used(header.countOverlays(), false);
 	format->set_overlay_used(&overlay_used, &need_overlay_table);
 	eix::ptr_list<Package>::size_type count(0);
-	PrintXml *print_xml(NULLPTR);
-	if(rc_options.xml || rc_options.be_quiet) {
+	PrintXml *print_xml(json_stream);
+	if(rc_options.xml || rc_options.json || rc_options.be_quiet) {
 		overlay_mode = mode_list_none;
 		rc_options.pure_packages = true;
 	}
-	if(rc_options.xml && !matches.empty()) {
+	if(json_stream != NULLPTR) {
+		// Started before the scan
+	} else if(rc_options.json && !matches.empty()) {
+		print_xml = new PrintJson(&header, &varpkg_db, format, &stability, &eixrc,
+			portagesettings["PORTDIR"]);
+		print_xml->start();
+	} else if(rc_options.xml && !matches.empty()) {
 		print_xml = new PrintXml(&header, &varpkg_db, format, &stability, &eixrc,
 			portagesettings["PORTDIR"]);
 		print_xml->start();
@@ -967,38 +1066,49 @@ int run_eix(int argc, char** argv) {
 	bool reached_limit(false), over_limit(false);
 	string limit_var(rc_options.compact_output ? "EIX_LIMIT_COMPACT" : "EIX_LIMIT");
 	eix::Treesize limit(is_tty ? eixrc.getInteger(limit_var) : 0);
-	for(eix::ptr_list<Package>::iterator it(matches.begin());
-		likely(it != matches.end()); ++it) {
-		stability.set_stability(*it);
-
-		if(unlikely(rc_options.xml)) {
-			print_xml->package(*it);
-			continue;
+	unsigned int print_jobs(print_jobs_setting(&eixrc));
+	if(json_stream != NULLPTR) {
+		// The packages were printed when they matched
+	} else if((print_jobs > 1) && (limit == 0) && (print_xml == NULLPTR) &&
+		(overlay_mode != mode_list_used_renumbered) &&
+		!rc_options.brief && !rc_options.brief2) {
+		// Render the packages in parallel, printing in the original order
+		ParallelPrint::Packages packages;
+		for(eix::ptr_list<Package>::iterator it(matches.begin());
+			likely(it != matches.end()); ++it) {
+			mark_overlays(*it, &need_overlay_table, &overlay_used);
+			packages.push_back(*it);
+		}
+		ParallelPrint parallel(format, &header, &varpkg_db, &portagesettings,
+			&stability, &overlay_used, &need_overlay_table);
+		if(unlikely(!parallel.print(packages, print_jobs, &count))) {
+			cerr << _("a process for printing in parallel failed") << endl;
+			return EXIT_FAILURE;
 		}
+		have_printed = (count != 0);
+	} else {
+		for(eix::ptr_list<Package>::iterator it(matches.begin());
+			likely(it != matches.end()); ++it) {
+			stability.set_stability(*it);
 
-		if(it->largest_overlay != 0) {
-			need_overlay_table = true;
-			if(overlay_mode <= mode_list_used) {
-				for(Package::iterator ver(it->begin());
-					likely(ver != it->end()); ++ver) {
-					ExtendedVersion::Overlay key(ver->overlay_key);
-					if(key > 0) {
-						overlay_used[key - 1] = true;
-					}
-				}
+			if(unlikely(print_xml != NULLPTR)) {
+				print_xml->package(*it);
+				continue;
 			}
-		}
-		if(overlay_mode != mode_list_used_renumbered) {
-			if(format->print(*it, &header, &varpkg_db, &portagesettings, &stability, reached_limit)) {
-				have_printed = true;
-				++count;
-				if(unlikely(reached_limit)) {
-					over_limit = true;
-				} else if(unlikely(count == limit)) {
-					reached_limit = true;
-				}
-				if(unlikely(rc_options.brief || (rc_options.brief2 && count > 1))) {
-					break;
+
+			mark_overlays(*it, &need_overlay_table, &overlay_used);
+			if(overlay_mode != mode_list_used_renumbered) {
+				if(format->print(*it, &header, &varpkg_db, &portagesettings, &stability, reached_limit)) {
+					have_printed = true;
+					++count;
+					if(unlikely(reached_limit)) {
+						over_limit = true;
+					} else if(unlikely(count == limit)) {
+						reached_limit = true;
+					}
+					if(unlikely(rc_options.brief || (rc_options.brief2 && count > 1))) {
+						break;
+					}
 				}
 			}
 		}
@@ -1086,13 +1196,7 @@ int run_eix(int argc, char** argv) {
 		}
 	}
 
-	// Delete matches (or all_packages, respectively)
-	if(unlikely(rc_options.test_unused)) {
-		all_packages.delete_and_clear();
-		matches.clear();
-	} else {
-		matches.delete_and_clear();
-	}
+	matches.delete_and_clear();
 	delete marked_list;
 
 	if(unlikely(!count)) {
@@ -1108,6 +1212,66 @@ GCC_DIAG_ON(sign-conversion)
 	return EXIT_SUCCESS;
 }  // NOLINT(readability/fn_size)
 
+/**
+Charge the time of the tests (but not of the decoding) to phase "match"
+**/
+static bool match_timed(MatchTree *matchtree, PackageReader *reader) {
+	Stats::Timer timer("match");
+	return matchtree->match(reader);
+}
+
+static bool earlier(const NamesIndex::Entry& a, const NamesIndex::Entry& b) {
+	return (a.second < b.second);
+}
+
+/**
+If only installed packages can match, test only those: Find them with the
+index of the names and read them in the order of the database
+**/
+static bool match_installed(Database *db, const DBHeader& header, PortageSettings *ps, VarDbPkg *varpkg_db, NamesIndex *index, MatchTree *matchtree, eix::ptr_list<Package> *matches, bool only_printed, PrintXml *json_stream, const SetStability *stability) {
+	WordVec names;
+	varpkg_db->getInstalledNames(&names);
+	std::sort(names.begin(), names.end());
+	NamesIndex::Entries packages;
+	string errtext;
+	if(unlikely(!index->find_keys(db, NamesIndex::FULL, names, &packages, &errtext))) {
+		cerr << errtext << endl;
+		return false;
+	}
+	std::sort(packages.begin(), packages.end(), earlier);
+	PackageReader reader(db, header, ps);
+	for(NamesIndex::Entries::const_iterator it(packages.begin());
+		likely(it != packages.end()); ++it) {
+		string::size_type slash(it->first.find('/'));
+		if(unlikely(!reader.seekPackage(it->first.substr(0, slash), it->first.substr(slash + 1), it->second))) {
+			break;
+		}
+		if(!(Stats::enabled() ? match_timed(matchtree, &reader) : matchtree->match(&reader))) {
+			continue;
+		}
+		Package *release(reader.release());
+		if(unlikely(release == NULLPTR)) {
+			break;
+		}
+		matches->push_back(release);
+		if(unlikely(json_stream != NULLPTR)) {
+			stability->set_stability(release);
+			json_stream->package(release);
+		}
+		if(unlikely(only_printed &&
+			(rc_options.brief ||
+				(rc_options.brief2 && (matches->size() > 1))))) {
+			break;
+		}
+	}
+	const char *err_cstr(reader.get_errtext());
+	if(unlikely(err_cstr != NULLPTR)) {
+		cerr << err_cstr << endl;
+		return false;
+	}
+	return true;
+}
+
 static bool opencache(Database *db, const char *filename, const char *tooltext) {
 	if(likely(db->openread(filename))) {
 		return true;
@@ -1128,6 +1292,78 @@ static bool is_current_dbversion(const char *filename, const char *tooltext) {
 	return db.read_header(&header, NULLPTR);
 }
 
+/**
+Print categories with a trailing slash and names of packages or, if prefix
+contains a slash, category/name of packages which start with prefix.
+The index of the names is used if the database has one.
+**/
+static bool print_completion(const char *filename, const char *tooltext, const string& prefix) {
+	Database db;
+	if(unlikely(!opencache(&db, filename, tooltext))) {
+		return false;
+	}
+	bool full(prefix.find('/') != string::npos);
+	WordSet result;
+	string errtext;
+	NamesIndex index;
+	if(index.read_trailer(&db)) {
+		NamesIndex::Entries entries;
+		if(unlikely(!index.find(&db, (full ? NamesIndex::FULL : NamesIndex::SHORT), prefix, &entries, &errtext))) {
+			cerr << errtext << endl;
+			return false;
+		}
+		for(NamesIndex::Entries::const_iterator it(entries.begin());
+			likely(it != entries.end()); ++it) {
+			result.insert(it->first);
+		}
+	} else {
+		DBHeader header;
+		if(unlikely(!db.seekabs(0, NULLPTR)) ||
+			unlikely(!db.read_header(&header, NULLPTR))) {
+			cerr << eix::format(_(
+				"%s was created with an incompatible eix-update:\n"
+				"It uses database format %s (current is %s).\n"
+				"Please run \"%s\" and try again."))
+				% filename % header.version % DBHeader::current
+				% tooltext << endl;
+			return false;
+		}
+		PackageReader reader(&db, header);
+		while(reader.next()) {
+			if(unlikely(!reader.read(PackageReader::NAME))) {
+				break;
+			}
+			const Package *p(reader.get());
+			if(full) {
+				string name(p->category + "/" + p->name);
+				if(name.compare(0, prefix.size(), prefix) == 0) {
+					result.insert(name);
+				}
+			} else {
+				if(p->name.compare(0, prefix.size(), prefix) == 0) {
+					result.insert(p->name);
+				}
+				if(p->category.compare(0, prefix.size(), prefix) == 0) {
+					result.insert(p->category + "/");
+				}
+			}
+			if(unlikely(!reader.skip())) {
+				break;
+			}
+		}
+		const char *err(reader.get_errtext());
+		if(unlikely(err != NULLPTR)) {
+			cerr << eix::format(_("error in database file %s: %s"))
+				% filename % err << endl;
+			return false;
+		}
+	}
+	for(WordSet::const_iterator it(result.begin()); likely(it != result.end()); ++it) {
+		cout << *it << "\n";
+	}
+	return true;
+}
+
 static void print_wordvec(const WordVec& vec) {
 	for(WordVec::const_iterator it(vec.begin());
 		likely(it != vec.end()); ++it) {
@@ -1136,7 +1372,7 @@ static void print_wordvec(const WordVec& vec) {
 	cout << "--\n";
 }
 
-static void print_unused(const string& filename, const string& excludefiles, const eix::ptr_list<Package>& packagelist, bool test_empty) {
+static void print_unused(const string& filename, const string& excludefiles, const PackageIndex& packages, bool test_empty) {
 	WordVec unused;
 	LineVec lines;
 	WordSet excludes;
@@ -1183,13 +1419,7 @@ static void print_unused(const string& filename, const string& excludefiles, con
 			parse_error->output(filename, lines.begin(), i, errtext);
 			continue;
 		}
-		eix::ptr_list<Package>::const_iterator pi(packagelist.begin());
-		for( ; likely(pi != packagelist.end()); ++pi) {
-			if(m.ismatch(**pi)) {
-				break;
-			}
-		}
-		if(pi != packagelist.end()) {
+		if(packages.have_match(m)) {
 			continue;
 		}
 		unused.push_back(*i);
@@ -1208,15 +1438,7 @@ static void print_unused(const string& filename, const string& excludefiles, con
 	print_wordvec(unused);
 }
 
-static void print_removed(const string& dirname, const string& excludefiles, const eix::ptr_list<Package>& packagelist) {
-	/* For faster testing, we build a category->name set */
-	typedef map<string, WordSet> CatName;
-	CatName cat_name;
-	for(eix::ptr_list<Package>::const_iterator pit(packagelist.begin());
-		likely(pit != packagelist.end()); ++pit) {
-		cat_name[pit->category].insert(pit->name);
-	}
-
+static void print_removed(const string& dirname, const string& excludefiles, const PackageIndex& packages) {
 	/* This will contain categories/packages to be printed */
 	WordVec failure;
 
@@ -1231,15 +1453,13 @@ static void print_removed(const string& dirname, const string& excludefiles, con
 		string cat_slash(*cit);
 		cat_slash.append(1, '/');
 		pushback_files(dirname + cat_slash, &names, NULLPTR, 2, true, false);
-		CatName::const_iterator cat(cat_name.find(*cit));
-		const WordSet *ns((cat == cat_name.end()) ? NULLPTR : &(cat->second));
 		for(WordVec::const_iterator nit(names.begin());
 			likely(nit != names.end()); ++nit) {
 			char *name(ExplodeAtom::split_name(nit->c_str()));
 			if(unlikely(name == NULLPTR)) {
 				continue;
 			}
-			if(unlikely((ns == NULLPTR) || (ns->find(name) == ns->end()))) {
+			if(unlikely(!packages.have_package(*cit, name))) {
 				if(unlikely(!know_excludes)) {
 					know_excludes = true;
 					WordVec excludelist;
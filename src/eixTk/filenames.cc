@@ -41,6 +41,7 @@
 #include "eixTk/filenames.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/stats.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/sysutils.h"
 
@@ -176,6 +177,7 @@ bool same_filenames(const char *mask, const char *name, bool glob, bool resolve_
 	string n(normalize_path(name, false, false));
 	if(!glob)
 		return (m == n);
+	Stats::count(Stats::FNMATCH_CALLS);
 	return (!fnmatch(m.c_str(), n.c_str(), 0));
 }
 
@@ -10,6 +10,8 @@
 
 // include "eixTk/i18n.h" This comment satisfies check_include script
 
+#define EIX_GETTEXT_CONTEXT_GLUE "\004"
+
 #ifdef ENABLE_NLS
 
 // We do not use gettext.h:
@@ -26,8 +28,6 @@
 // For these, variants of the inline versions from gettext.h
 // produce perhaps the shortest code
 
-#define EIX_GETTEXT_CONTEXT_GLUE "\004"
-
 #define eix_pgettext(p, a) eix::pgettext_aux(p EIX_GETTEXT_CONTEXT_GLUE a, a)
 #define eix_npgettext(p, a, b, n) eix::npgettext_aux(p EIX_GETTEXT_CONTEXT_GLUE a, a, b, n)
 
@@ -0,0 +1,163 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <iostream>
+#include <streambuf>
+
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/outputsink.h"
+#include "eixTk/stats.h"
+
+using std::cout;
+
+static OutputSink *sink = NULLPTR;
+
+static int stdout_fd() ATTRIBUTE_PURE;
+
+static int stdout_fd() {
+#ifdef HAVE_FILENO
+	return fileno(stdout);
+#else
+	return 1;
+#endif
+}
+
+OutputSink::OutputSink() : failed(false), original(NULLPTR) {
+	buffer = new char[buffer_size];
+	setp(buffer, buffer + buffer_size);
+	interactive = (isatty(stdout_fd()) != 0);
+	struct stat st;
+	regular = ((fstat(stdout_fd(), &st) == 0) && S_ISREG(st.st_mode));
+}
+
+OutputSink::~OutputSink() {
+	if(original != NULLPTR) {
+		sync();
+		cout.rdbuf(original);
+	}
+	delete[] buffer;
+}
+
+void OutputSink::init() {
+	// A static object is destroyed (and thus flushed) when the program ends
+	static OutputSink instance;
+	if(sink != NULLPTR) {
+		return;
+	}
+	sink = &instance;
+	cout.flush();
+	fflush(stdout);
+	instance.original = cout.rdbuf(&instance);
+}
+
+void OutputSink::interactive_flush() {
+	if(unlikely((sink != NULLPTR) && sink->interactive)) {
+		sink->sync();
+	}
+}
+
+void OutputSink::stream_flush() {
+	if(likely(sink != NULLPTR) && !sink->regular) {
+		sink->sync();
+	}
+}
+
+bool OutputSink::write_out(const char *data, size_t len) {
+	Stats::Timer timer("output");
+	const char *buf(pbase());
+	size_t buflen(pptr() - pbase());
+	setp(buffer, buffer + buffer_size);
+	if(unlikely(failed)) {
+		return false;
+	}
+	int fd(stdout_fd());
+	while(likely((buflen != 0) || (len != 0))) {
+		ssize_t written;
+#ifdef HAVE_SYS_UIO_H
+		struct iovec iov[2];
+		int count(0);
+		if(buflen != 0) {
+			iov[count].iov_base = const_cast<char *>(buf);
+			iov[count++].iov_len = buflen;
+		}
+		if(len != 0) {
+			iov[count].iov_base = const_cast<char *>(data);
+			iov[count++].iov_len = len;
+		}
+		written = writev(fd, iov, count);
+#else
+		written = ((buflen != 0) ? write(fd, buf, buflen) : write(fd, data, len));
+#endif
+		if(unlikely(written < 0)) {
+			if(errno == EINTR) {
+				continue;
+			}
+			failed = true;
+			return false;
+		}
+		size_t done(written);
+		if(done >= buflen) {
+			done -= buflen;
+			buflen = 0;
+			data += done;
+			len -= done;
+		} else {
+			buf += done;
+			buflen -= done;
+		}
+	}
+	return true;
+}
+
+OutputSink::int_type OutputSink::overflow(int_type c) {
+	if(unlikely(!write_buffer())) {
+		return traits_type::eof();
+	}
+	if(traits_type::eq_int_type(c, traits_type::eof())) {
+		return traits_type::not_eof(c);
+	}
+	*pptr() = traits_type::to_char_type(c);
+	pbump(1);
+	return c;
+}
+
+std::streamsize OutputSink::xsputn(const char *s, std::streamsize n) {
+	size_t len(n);
+	if(likely(len <= static_cast<size_t>(epptr() - pptr()))) {
+		memcpy(pptr(), s, len);
+		pbump(static_cast<int>(len));
+		return n;
+	}
+	if(len < buffer_size / 2) {
+		// Small chunks are collected in the fresh buffer
+		if(unlikely(!write_buffer())) {
+			return 0;
+		}
+		memcpy(pptr(), s, len);
+		pbump(static_cast<int>(len));
+		return n;
+	}
+	return (likely(write_out(s, len)) ? n : 0);
+}
+
+int OutputSink::sync() {
+	return (likely(write_buffer()) ? 0 : -1);
+}
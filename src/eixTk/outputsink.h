@@ -0,0 +1,71 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_EIXTK_OUTPUTSINK_H_
+#define SRC_EIXTK_OUTPUTSINK_H_ 1
+
+#include <sys/types.h>
+
+#include <streambuf>
+
+#include "eixTk/constexpr.h"
+#include "eixTk/null.h"
+
+/**
+A large buffer for the standard output stream which is written to stdout
+only when it is full, when the stream is flushed (e.g. by output to the
+standard error stream), when the program ends, or (if stdout is a
+terminal) after each printed package. Records which are streamed are also
+flushed if stdout is a pipe.
+A large chunk which does not fit is written together with the buffered
+data in one writev() call.
+**/
+class OutputSink : public std::streambuf {
+	private:
+		static CONSTEXPR size_t buffer_size = 128 * 1024;
+
+		char *buffer;
+		bool interactive, regular, failed;
+		std::streambuf *original;
+
+		OutputSink();
+
+		/**
+		Write the buffered data and then len bytes of data
+		**/
+		bool write_out(const char *data, size_t len);
+		bool write_buffer() {
+			return write_out(NULLPTR, 0);
+		}
+
+	protected:
+		int_type overflow(int_type c);
+		std::streamsize xsputn(const char *s, std::streamsize n);
+		int sync();
+
+	public:
+		~OutputSink();
+
+		/**
+		Redirect the standard output stream into the buffer; the buffer is
+		flushed when the program ends
+		**/
+		static void init();
+
+		/**
+		Flush the buffer if stdout is a terminal
+		**/
+		static void interactive_flush();
+
+		/**
+		Flush the buffer unless stdout is a regular file, so that a reader
+		of a pipe gets each record as soon as it is complete
+		**/
+		static void stream_flush();
+};
+
+#endif  // SRC_EIXTK_OUTPUTSINK_H_
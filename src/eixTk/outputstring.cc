@@ -245,23 +245,19 @@ void OutputString::print(std::string *dest, WordSize *s) const {
 		dest->append(m_string);
 	} else {
 		WordSize r(0);
-		WordSize curr(*s);
 		for(InsertType::const_iterator it(m_insert.begin());
 			unlikely(it != m_insert.end()); ++it) {
 			if(*it > r) {
 				dest->append(m_string, r, (*it) - r);
 				r = *it;
 			}
-			curr += *(++it);
+			// The stored size does not contain what was inserted before
+			WordSize curr(*s + inserted + *(++it));
 			WordSize aim(*(++it));
-			WordSize d;
 			if(aim  == 0) {  // tab
-				d = 8 - (curr % 8);
-				curr += d;
-				inserted += d;
+				inserted += 8 - (curr % 8);
 			} else if(curr < aim) {
-				d = aim - curr;
-				curr = aim;
+				WordSize d(aim - curr);
 				inserted += d;
 				dest->append(d, ' ');
 			}
@@ -275,6 +271,61 @@ void OutputString::print(std::string *dest, WordSize *s) const {
 	}
 }
 
+static void pack_size(string *dest, WordSize s) ATTRIBUTE_NONNULL_;
+static bool unpack_size(WordSize *s, const char **pos, const char *end) ATTRIBUTE_NONNULL_;
+
+static void pack_size(string *dest, WordSize s) {
+	dest->append(reinterpret_cast<const char *>(&s), sizeof(s));
+}
+
+static bool unpack_size(WordSize *s, const char **pos, const char *end) {
+	if(unlikely(static_cast<WordSize>(end - *pos) < sizeof(*s))) {
+		return false;
+	}
+	memcpy(s, *pos, sizeof(*s));
+	*pos += sizeof(*s);
+	return true;
+}
+
+void OutputString::pack(string *dest) const {
+	dest->append(1, (absolute ? '1' : '0'));
+	pack_size(dest, m_size);
+	pack_size(dest, m_insert.size());
+	for(InsertType::const_iterator it(m_insert.begin());
+		unlikely(it != m_insert.end()); ++it) {
+		pack_size(dest, *it);
+	}
+	pack_size(dest, m_string.size());
+	dest->append(m_string);
+}
+
+bool OutputString::unpack(const char **pos, const char *end) {
+	if(unlikely(*pos == end)) {
+		return false;
+	}
+	absolute = (*((*pos)++) == '1');
+	WordSize len;
+	if(unlikely(!unpack_size(&m_size, pos, end) ||
+		!unpack_size(&len, pos, end))) {
+		return false;
+	}
+	m_insert.clear();
+	for(; unlikely(len != 0); --len) {
+		WordSize i;
+		if(unlikely(!unpack_size(&i, pos, end))) {
+			return false;
+		}
+		m_insert.push_back(i);
+	}
+	if(unlikely(!unpack_size(&len, pos, end) ||
+		(static_cast<WordSize>(end - *pos) < len))) {
+		return false;
+	}
+	m_string.assign(*pos, len);
+	*pos += len;
+	return true;
+}
+
 void OutputString::print(WordSize *s) const {
 	string d;
 	print(&d, s);
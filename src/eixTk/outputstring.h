@@ -126,6 +126,18 @@ class OutputString {
 		void append(const OutputString& a);
 		void print(std::string *dest, WordSize *s) const ATTRIBUTE_NONNULL_;
 		void print(WordSize *s) const ATTRIBUTE_NONNULL_;
+
+		/**
+		Append a raw representation to dest for passing it to another
+		process of the same binary
+		**/
+		void pack(std::string *dest) const ATTRIBUTE_NONNULL_;
+
+		/**
+		Read a representation written by pack() and advance *pos
+		@return false if the data is incomplete
+		**/
+		bool unpack(const char **pos, const char *end) ATTRIBUTE_NONNULL_;
 };
 
 #endif  // SRC_EIXTK_OUTPUTSTRING_H_
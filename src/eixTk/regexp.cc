@@ -9,16 +9,23 @@
 
 #include <config.h>
 
+#ifdef WITH_PCRE2
+#include <langinfo.h>
+#endif
+
 #include <cstdlib>
+#include <cstring>
 
 #include <iostream>
 #include <string>
 #include <vector>
 
 #include "eixTk/diagnostics.h"
+#include "eixTk/inttypes.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
 #include "eixTk/regexp.h"
+#include "eixTk/stats.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/stringutils.h"
 
@@ -28,6 +35,279 @@ using std::vector;
 using std::cerr;
 using std::endl;
 
+static inline char ascii_lower(char c) ATTRIBUTE_CONST;
+static inline char ascii_lower(char c) {
+	return (((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c + ('a' - 'A')) : c);
+}
+
+static inline char ascii_upper(char c) ATTRIBUTE_CONST;
+static inline char ascii_upper(char c) {
+	return (((c >= 'a') && (c <= 'z')) ? static_cast<char>(c - ('a' - 'A')) : c);
+}
+
+static inline bool is_ascii(char c) ATTRIBUTE_CONST;
+static inline bool is_ascii(char c) {
+	return (static_cast<unsigned char>(c) < 0x80);
+}
+
+/**
+@return pointer behind the bracket expression starting after p or to '\0'
+**/
+static const char *skip_bracket(const char *p) ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+static const char *skip_bracket(const char *p) {
+	if(*p == '^') {
+		++p;
+	}
+	if(*p == ']') {
+		++p;
+	}
+	for(; *p != '\0'; ++p) {
+		if(*p == ']') {
+			return p + 1;
+		}
+		if((*p == '[') && ((p[1] == ':') || (p[1] == '.') || (p[1] == '='))) {
+			const char delim(p[1]);
+			for(p += 2; (*p != '\0') && ((*p != delim) || (p[1] != ']')); ++p) {
+			}
+			if(*p == '\0') {
+				break;
+			}
+			++p;
+		}
+	}
+	return p;
+}
+
+/**
+@return the longest literal which every match of the extended regular
+expression contains. Parentheses, brackets, special escapes and non-ASCII
+characters end a literal; a character followed by *, ? or { is dropped.
+Every literal is optional if there is an alternative at top level.
+**/
+static string required_literal(const char *regex, bool icase) ATTRIBUTE_NONNULL_;
+static string required_literal(const char *regex, bool icase) {
+	string best, run;
+	for(const char *p(regex); *p != '\0'; ) {
+		char c(*(p++));
+		switch(c) {
+			case '|':
+				return "";
+			case '(':
+				for(int depth(1); (depth != 0) && (*p != '\0'); ) {
+					c = *(p++);
+					if(c == '(') {
+						++depth;
+					} else if(c == ')') {
+						--depth;
+					} else if(c == '[') {
+						p = skip_bracket(p);
+					} else if((c == '\\') && (*p != '\0')) {
+						++p;
+					}
+				}
+				c = '\0';
+				break;
+			case '[':
+				p = skip_bracket(p);
+				c = '\0';
+				break;
+			case '*':
+			case '?':
+			case '{':
+			case '+':
+				// A sequence of quantifiers drops the character unless all are +
+				for(bool optional(false); ; c = *(p++)) {
+					if(c == '{') {
+						for(; (*p != '\0') && (*(p++) != '}'); ) {
+						}
+					} else if((c != '*') && (c != '?') && (c != '+')) {
+						--p;
+						if(optional && !run.empty()) {
+							run.erase(run.size() - 1);
+						}
+						break;
+					}
+					optional = (optional || (c != '+'));
+				}
+				c = '\0';
+				break;
+			case '.':
+			case '^':
+			case '$':
+			case ')':
+				c = '\0';
+				break;
+			case '\\':
+				c = *p;
+				if(c == '\0') {
+					break;
+				}
+				++p;
+				if(my_isalnum(c) || (c == '<') || (c == '>') || (c == '`') || (c == '\'')) {
+					c = '\0';
+				}
+				break;
+			default:
+				break;
+		}
+		if((c == '\0') || !is_ascii(c)) {
+			if(run.size() > best.size()) {
+				best.swap(run);
+			}
+			run.clear();
+			continue;
+		}
+		run.append(1, (icase ? ascii_lower(c) : c));
+	}
+	if(run.size() > best.size()) {
+		best.swap(run);
+	}
+	return best;
+}
+
+#ifdef WITH_PCRE2
+/**
+Translate an extended regular expression into the syntax of PCRE2.
+With dotless_i, the expression is for caseless UTF-8 where the GNU C library
+matches i, I and the dotless i with each other, but PCRE2 does not.
+@return false if the expression uses a feature whose meaning differs
+**/
+static bool pcre2_translate(string *dest, const char *regex, bool dotless_i) ATTRIBUTE_NONNULL_;
+static bool pcre2_translate(string *dest, const char *regex, bool dotless_i) {
+	dest->clear();
+	bool quantifiable(false);
+	for(const char *p(regex); *p != '\0'; ++p) {
+		char c(*p);
+		switch(c) {
+			case '\\':
+				c = *(++p);
+				if(c == '<') {
+					dest->append("\\b(?=\\w)");
+				} else if(c == '>') {
+					dest->append("\\b(?<=\\w)");
+				} else if(c == '`') {
+					dest->append("\\A");
+				} else if(c == '\'') {
+					dest->append("\\z");
+				} else if((c == '\0') || !is_ascii(c) ||
+					(my_isalnum(c) && (std::strchr("123456789wWsSbB", c) == NULLPTR))) {
+					return false;
+				} else {
+					dest->append(1, '\\');
+					dest->append(1, c);
+				}
+				quantifiable = (std::strchr("<>`'bB", c) == NULLPTR);
+				continue;
+			case '[':
+				dest->append(1, '[');
+				if(p[1] == '^') {
+					dest->append(1, *(++p));
+				}
+				if(p[1] == ']') {
+					dest->append("\\]");
+					++p;
+				}
+				for(c = *(++p); c != ']'; c = *(++p)) {
+					if((c == '\0') || (dotless_i &&
+						((std::strchr("iI-\xc4", c) != NULLPTR) || (c == '[')))) {
+						return false;
+					}
+					if(c == '\\') {
+						dest->append(1, '\\');
+					} else if((c == '[') && ((p[1] == '.') || (p[1] == '='))) {
+						return false;
+					} else if((c == '[') && (p[1] == ':')) {
+						const char *end(std::strstr(p + 2, ":]"));
+						if(end == NULLPTR) {
+							return false;
+						}
+						dest->append(p, end + 1 - p);
+						p = end + 1;
+						c = ']';
+					}
+					dest->append(1, c);
+				}
+				dest->append(1, ']');
+				quantifiable = true;
+				continue;
+			case '{':
+				if(!quantifiable) {
+					return false;
+				}
+				dest->append(1, '{');
+				if(p[1] == ',') {
+					dest->append(1, '0');
+				} else if(!my_isdigit(p[1])) {
+					return false;
+				}
+				for(c = *(++p); c != '}'; c = *(++p)) {
+					if(!my_isdigit(c) && (c != ',')) {
+						return false;
+					}
+					dest->append(1, c);
+				}
+				dest->append(1, '}');
+				quantifiable = false;
+				continue;
+			case '*':
+			case '+':
+			case '?':
+				if(!quantifiable) {
+					return false;
+				}
+				quantifiable = false;
+				break;
+			case '(':
+			case '|':
+			case '^':
+			case '$':
+				quantifiable = false;
+				break;
+			default:
+				quantifiable = true;
+				if(dotless_i && ((c == 'i') || (c == 'I') ||
+					((c == '\xc4') && (p[1] == '\xb1')))) {
+					dest->append("[iI\xc4\xb1]");
+					if(c == '\xc4') {
+						++p;
+					}
+					continue;
+				}
+				break;
+		}
+		dest->append(1, c);
+	}
+	return true;
+}
+
+/**
+@return the options of PCRE2 which correspond to the current locale or
+0 if the current locale is not supported
+**/
+static uint32_t pcre2_locale_options() {
+	if(MB_CUR_MAX == 1) {
+		return PCRE2_DOTALL|PCRE2_DOLLAR_ENDONLY;
+	}
+	const char *codeset(nl_langinfo(CODESET));
+	if((codeset == NULLPTR) || ((std::strcmp(codeset, "UTF-8") != 0) && (std::strcmp(codeset, "utf8") != 0))) {
+		return 0;
+	}
+	return PCRE2_DOTALL|PCRE2_DOLLAR_ENDONLY|PCRE2_UTF|PCRE2_UCP|PCRE2_MATCH_INVALID_UTF;
+}
+
+/**
+Character tables of PCRE2 for single-byte locales
+**/
+static pcre2_compile_context *pcre2_context() {
+	static pcre2_compile_context *context(NULLPTR);
+	if((context == NULLPTR) && (MB_CUR_MAX == 1)) {
+		context = pcre2_compile_context_create(NULLPTR);
+		pcre2_set_character_tables(context, pcre2_maketables(NULLPTR));
+	}
+	return context;
+}
+#endif
+
 /**
 Free the regular expression
 **/
@@ -36,16 +316,22 @@ void Regex::free() {
 		regfree(&m_re);
 		m_compiled = false;
 	}
+	m_required.clear();
+#ifdef WITH_PCRE2
+	if(m_pcre != NULLPTR) {
+		pcre2_match_data_free(m_pcre_data);
+		pcre2_code_free(m_pcre);
+		m_pcre = NULLPTR;
+		m_pcre_data = NULLPTR;
+	}
+#endif
 }
 
 /**
 Compile a regular expression
 **/
 void Regex::compile(const char *regex, int eflags) {
-	if(unlikely(m_compiled)) {
-		regfree(&m_re);
-		m_compiled = false;
-	}
+	free();
 	if((regex == NULLPTR) || (regex[0] == '\0')) {
 		return;
 	}
@@ -58,6 +344,64 @@ void Regex::compile(const char *regex, int eflags) {
 		exit(EXIT_FAILURE);
 	}
 	m_compiled = true;
+	m_icase = ((eflags & REG_ICASE) != 0);
+	m_required = required_literal(regex, m_icase);
+#ifdef WITH_PCRE2
+	uint32_t options(pcre2_locale_options());
+	string pattern;
+	if((options == 0) || ((eflags & REG_NEWLINE) != 0) ||
+		!pcre2_translate(&pattern, regex,
+			(m_icase && ((options & PCRE2_UTF) != 0)))) {
+		return;
+	}
+	if(m_icase) {
+		options |= PCRE2_CASELESS;
+	}
+	int errorcode;
+	PCRE2_SIZE erroroffset;
+	m_pcre = pcre2_compile(reinterpret_cast<PCRE2_SPTR>(pattern.c_str()),
+		pattern.size(), options, &errorcode, &erroroffset, pcre2_context());
+	if(m_pcre == NULLPTR) {
+		return;
+	}
+	pcre2_jit_compile(m_pcre, PCRE2_JIT_COMPLETE);
+	m_pcre_data = pcre2_match_data_create(1, NULLPTR);
+#endif
+}
+
+/**
+@return false if s cannot match since it lacks m_required
+**/
+bool Regex::prefilter(const char *s) const {
+	if(m_required.empty()) {
+		return true;
+	}
+	if(!m_icase) {
+		return (std::strstr(s, m_required.c_str()) != NULLPTR);
+	}
+	// Candidates for the first character are found by strpbrk
+	const char *rest(m_required.c_str() + 1);
+	string::size_type len(m_required.size() - 1);
+	char first[3] = { m_required[0], ascii_upper(m_required[0]), '\0' };
+	for(const char *p(s); (p = std::strpbrk(p, first)) != NULLPTR; ) {
+		++p;
+		string::size_type i(0);
+		for(; (i != len) && (ascii_lower(p[i]) == rest[i]); ++i) {
+		}
+		if(i == len) {
+			return true;
+		}
+	}
+	// In some locales, non-ASCII characters match i, k, or s with REG_ICASE
+	if(std::strpbrk(m_required.c_str(), "iks") == NULLPTR) {
+		return false;
+	}
+	for(; *s != '\0'; ++s) {
+		if(!is_ascii(*s)) {
+			return true;
+		}
+	}
+	return false;
 }
 
 /**
@@ -65,7 +409,28 @@ void Regex::compile(const char *regex, int eflags) {
 @return true if the regular expression matches
 **/
 bool Regex::match(const char *s) const {
-	return (!m_compiled) || (!regexec(get(), s, 0, NULLPTR, 0));
+	if(!m_compiled) {
+		return true;
+	}
+	if(!prefilter(s)) {
+		Stats::count(Stats::REGEX_REJECTS);
+		return false;
+	}
+	Stats::count(Stats::REGEX_CALLS);
+#ifdef WITH_PCRE2
+	if(m_pcre != NULLPTR) {
+		int result(pcre2_match(m_pcre, reinterpret_cast<PCRE2_SPTR>(s),
+			PCRE2_ZERO_TERMINATED, 0, 0, m_pcre_data, NULLPTR));
+		if(result == PCRE2_ERROR_NOMATCH) {
+			return false;
+		}
+		if(likely(result >= 0)) {
+			return true;
+		}
+		// On errors like exceeded limits, POSIX decides
+	}
+#endif
+	return !regexec(get(), s, 0, NULLPTR, 0);
 }
 
 /**
@@ -85,7 +450,9 @@ bool Regex::match(const char *s, string::size_type *b, string::size_type *e) con
 		}
 		return true;
 	}
-	if(regexec(get(), s, 1, pmatch, 0)) {
+	bool rejected(!prefilter(s));
+	Stats::count(rejected ? Stats::REGEX_REJECTS : Stats::REGEX_CALLS);
+	if(rejected || regexec(get(), s, 1, pmatch, 0)) {
 		if(likely(b != NULLPTR)) {
 			*b = string::npos;
 		}
@@ -12,16 +12,28 @@
 
 #include <regex.h>
 
+#ifdef WITH_PCRE2
+#ifndef PCRE2_CODE_UNIT_WIDTH
+#define PCRE2_CODE_UNIT_WIDTH 8
+#endif
+#include <pcre2.h>
+#endif
+
 // include <cstdlib> make check_includes happy
 
 #include <string>
 #include <vector>
 
+#include "eixTk/null.h"
 
 /**
 Handle regular expressions.
 It is normally used within global scope so that a regular expression doesn't
 have to be compiled with every instance of a class using it.
+A literal which every match must contain is extracted when compiling;
+strings without it are rejected before the regular expression is executed.
+If compiled with PCRE2, the JIT of PCRE2 is used for plain matching when the
+expression can be translated; POSIX is still used for the matched range.
 **/
 
 class Regex {
@@ -30,12 +42,14 @@ class Regex {
 		Initalize class
 		**/
 		Regex() : m_compiled(false) {
+			init();
 		}
 
 		/**
 		Initalize and compile regular expression
 		**/
 		Regex(const char *regex, int eflags) : m_compiled(false) {
+			init();
 			compile(regex, eflags);
 		}
 
@@ -43,6 +57,7 @@ class Regex {
 		Initalize and compile regular expression
 		**/
 		explicit Regex(const char *regex) : m_compiled(false) {
+			init();
 			compile(regex, REG_EXTENDED);
 		}
 
@@ -98,6 +113,34 @@ class Regex {
 		Is the regex already compiled and nonempty?
 		**/
 		bool m_compiled;
+
+		/**
+		A literal contained in every match (lowercase for REG_ICASE)
+		**/
+		std::string m_required;
+		bool m_icase;
+
+#ifdef WITH_PCRE2
+		/**
+		The translated expression or NULLPTR if only POSIX is used
+		**/
+		pcre2_code *m_pcre;
+		pcre2_match_data *m_pcre_data;
+#endif
+
+	private:
+		void init() {
+			m_icase = false;
+#ifdef WITH_PCRE2
+			m_pcre = NULLPTR;
+			m_pcre_data = NULLPTR;
+#endif
+		}
+
+		/**
+		@return false if s cannot match since it lacks m_required
+		**/
+		bool prefilter(const char *s) const ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
 };
 
 class RegexList {
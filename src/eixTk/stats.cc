@@ -0,0 +1,153 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <sys/time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eixTk/eixint.h"
+#include "eixTk/i18n.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/stats.h"
+
+using std::map;
+using std::string;
+using std::vector;
+
+class StatsPhase {
+	public:
+		string name;
+		double wall, cpu;
+		eix::UNumber counters[Stats::COUNTERS];
+
+		explicit StatsPhase(const string& n) : name(n), wall(0), cpu(0) {
+			for(unsigned int i(0); likely(i != Stats::COUNTERS); ++i) {
+				counters[i] = 0;
+			}
+		}
+};
+
+typedef vector<StatsPhase> StatsPhases;
+typedef map<string, Stats::Index> StatsIndex;
+
+static const char *counter_names[Stats::COUNTERS] = {
+	"bytes read",
+	"packages decoded",
+	"packages skipped",
+	"regex calls",
+	"regex prefilter rejects",
+	"fnmatch calls",
+	"versions compared"
+};
+
+eix::UNumber Stats::counters[Stats::COUNTERS];
+bool Stats::m_enabled = false;
+bool Stats::m_recording = false;
+
+static StatsPhases *phases = NULLPTR;
+static StatsIndex *phase_index;
+static Stats::Index current;
+static double last_wall, last_cpu;
+static eix::UNumber last_counters[Stats::COUNTERS];
+
+static double wall_time();
+static double cpu_time();
+
+static double wall_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULLPTR);
+	return (static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1000000.0);
+}
+
+static double cpu_time() {
+	return (static_cast<double>(std::clock()) / CLOCKS_PER_SEC);
+}
+
+void Stats::init() {
+	phases = new StatsPhases;
+	phase_index = new StatsIndex;
+	m_recording = true;
+	current = phase("startup");
+	last_wall = wall_time();
+	last_cpu = cpu_time();
+}
+
+void Stats::enable(bool on) {
+	if(unlikely(phases == NULLPTR)) {
+		return;
+	}
+	if(on) {
+		if(!m_enabled) {
+			m_enabled = true;
+			std::atexit(report);
+		}
+		return;
+	}
+	m_recording = false;
+}
+
+Stats::Index Stats::phase(const string& name) {
+	StatsIndex::const_iterator it(phase_index->find(name));
+	if(it != phase_index->end()) {
+		return it->second;
+	}
+	Index i(phases->size());
+	phases->push_back(StatsPhase(name));
+	(*phase_index)[name] = i;
+	return i;
+}
+
+Stats::Index Stats::switch_to(Index next) {
+	double wall(wall_time());
+	double cpu(cpu_time());
+	StatsPhase& p((*phases)[current]);
+	p.wall += wall - last_wall;
+	p.cpu += cpu - last_cpu;
+	last_wall = wall;
+	last_cpu = cpu;
+	for(unsigned int i(0); likely(i != COUNTERS); ++i) {
+		p.counters[i] += counters[i] - last_counters[i];
+		last_counters[i] = counters[i];
+	}
+	Index previous(current);
+	current = next;
+	return previous;
+}
+
+void Stats::report() {
+	switch_to(current);
+	double wall(0), cpu(0);
+	fprintf(stderr, "%s\n%-32s %10s %10s\n", _("Statistics:"), _("phase"),
+		_("wall [s]"), _("cpu [s]"));
+	for(StatsPhases::const_iterator it(phases->begin()); likely(it != phases->end()); ++it) {
+		wall += it->wall;
+		cpu += it->cpu;
+		fprintf(stderr, "%-32s %10.3f %10.3f\n", it->name.c_str(), it->wall, it->cpu);
+		const char *separator("   ");
+		for(unsigned int i(0); likely(i != COUNTERS); ++i) {
+			if(it->counters[i] == 0) {
+				continue;
+			}
+			fprintf(stderr, "%s%s: %lu", separator, counter_names[i],
+				static_cast<unsigned long>(it->counters[i]));  // NOLINT(runtime/int)
+			separator = ", ";
+		}
+		if(*separator == ',') {
+			fputc('\n', stderr);
+		}
+	}
+	fprintf(stderr, "%-32s %10.3f %10.3f\n", _("total"), wall, cpu);
+}
@@ -0,0 +1,126 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_EIXTK_STATS_H_
+#define SRC_EIXTK_STATS_H_ 1
+
+#include <string>
+#include <vector>
+
+#include "eixTk/eixint.h"
+#include "eixTk/likely.h"
+
+/**
+Opt-in timing and counting (EIX_STATS or --stats).
+Each moment is charged to exactly one phase: Either the phase set by
+start(), or the phase of the innermost Timer. The counters are always
+incremented but only charged to the phases if statistics are recorded.
+If enabled, a report is printed to stderr when the program ends.
+**/
+class Stats {
+	public:
+		enum Counter {
+			BYTES_READ,
+			PACKAGES_DECODED,
+			PACKAGES_SKIPPED,
+			REGEX_CALLS,
+			REGEX_REJECTS,
+			FNMATCH_CALLS,
+			VERSIONS_COMPARED,
+			COUNTERS
+		};
+
+		typedef std::vector<std::string>::size_type Index;
+
+		static eix::UNumber counters[COUNTERS];
+
+		static void count(Counter c) {
+			++counters[c];
+		}
+
+		static void count(Counter c, eix::UNumber n) {
+			counters[c] += n;
+		}
+
+		/**
+		Start recording in phase "startup": Until enable() is called,
+		only the phases set by start() are recorded
+		**/
+		static void init();
+
+		/**
+		Decide whether statistics are recorded and reported
+		**/
+		static void enable(bool on);
+
+		static bool enabled() {
+			return m_enabled;
+		}
+
+		static bool recording() {
+			return m_recording;
+		}
+
+		/**
+		End the current phase and continue with phase name
+		**/
+		static void start(const std::string& name) {
+			if(unlikely(m_recording)) {
+				switch_to(phase(name));
+			}
+		}
+
+		/**
+		Charge the time since the last switch to the current phase
+		@return the previous phase
+		**/
+		static Index switch_to(Index next);
+
+		/**
+		@return the index of phase name, creating it if necessary
+		**/
+		static Index phase(const std::string& name);
+
+		static void report();
+
+		/**
+		Charge the time of its lifetime (minus that of inner timers) to a phase
+		**/
+		class Timer {
+			public:
+				Timer() : active(false) {
+				}
+
+				explicit Timer(const char *name) : active(m_enabled) {
+					if(unlikely(active)) {
+						previous = switch_to(phase(name));
+					}
+				}
+
+				void start(const std::string& name) {
+					if(unlikely(m_enabled)) {
+						previous = switch_to(phase(name));
+						active = true;
+					}
+				}
+
+				~Timer() {
+					if(unlikely(active)) {
+						switch_to(previous);
+					}
+				}
+
+			private:
+				bool active;
+				Index previous;
+		};
+
+	private:
+		static bool m_enabled, m_recording;
+};
+
+#endif  // SRC_EIXTK_STATS_H_
@@ -30,6 +30,7 @@
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/stats.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/stringutils.h"
 
@@ -558,9 +559,37 @@ void StringHash::finalize() {
 	}
 }
 
+void StringHash::finalize_index() {
+	if(finalized) {
+		return;
+	}
+	finalized = true;
+	str_map.clear();
+	size_type i(0);
+	for(const_iterator it(begin()); likely(it != end()); ++it) {
+		str_map[*it] = i++;
+	}
+}
+
+StringHash::size_type StringHash::append_string(const string& s) {
+	if(!finalized) {
+		cerr << _("internal error: Index required before sorting.") << endl;
+		exit(EXIT_FAILURE);
+	}
+	StrSizeMap::const_iterator i(str_map.find(s));
+	if(i != str_map.end()) {
+		return i->second;
+	}
+	size_type index(size());
+	push_back(s);
+	str_map[s] = index;
+	return index;
+}
+
 bool match_list(const char **str_list, const char *str) {
 	if(str_list != NULLPTR) {
 		while(likely(*str_list != NULLPTR)) {
+			Stats::count(Stats::FNMATCH_CALLS);
 			if(fnmatch(*(str_list++), str, 0) == 0) {
 				return true;
 			}
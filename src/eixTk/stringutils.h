@@ -429,6 +429,17 @@ class StringHash : public WordVec {
 
 		void finalize();
 
+		/**
+		Finalize a hash filled by store_string() such that get_index()
+		can be used and further strings can be appended with append_string()
+		**/
+		void finalize_index();
+
+		/**
+		@return the index of s in a hash after finalizing, appending s if new
+		**/
+		StringHash::size_type append_string(const std::string& s);
+
 		void store_string(const std::string& s);
 		void store_words(const WordVec& v);
 		void store_words(const std::string& s) {
@@ -0,0 +1,166 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <iostream>
+#include <string>
+
+#include "eixTk/likely.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/workers.h"
+
+using std::string;
+
+using std::cout;
+
+static bool write_all(int fd, const char *data, string::size_type len) ATTRIBUTE_NONNULL_;
+static bool read_all(int fd, char *data, string::size_type len) ATTRIBUTE_NONNULL_;
+
+static bool write_all(int fd, const char *data, string::size_type len) {
+	while(likely(len != 0)) {
+		ssize_t r(write(fd, data, len));
+		if(unlikely(r <= 0)) {
+			if((r < 0) && (errno == EINTR)) {
+				continue;
+			}
+			return false;
+		}
+		data += r;
+		len -= r;
+	}
+	return true;
+}
+
+static bool read_all(int fd, char *data, string::size_type len) {
+	while(likely(len != 0)) {
+		ssize_t r(read(fd, data, len));
+		if(unlikely(r <= 0)) {
+			if((r < 0) && (errno == EINTR)) {
+				continue;
+			}
+			return false;
+		}
+		data += r;
+		len -= r;
+	}
+	return true;
+}
+
+unsigned int ForkWorkers::jobs_setting(unsigned int jobs) {
+#if defined(HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+	if(jobs == 0) {
+		long cpus(sysconf(_SC_NPROCESSORS_ONLN));
+		if(cpus > 0) {
+			jobs = static_cast<unsigned int>(cpus);
+		}
+	}
+#endif
+	return jobs;
+}
+
+/**
+A message is the length followed by the data
+**/
+void ForkWorkers::init_message(string *msg) {
+	msg->assign(sizeof(WordSize), '\0');
+}
+
+bool ForkWorkers::send_message(int fd, string *msg) {
+	WordSize len(msg->size() - sizeof(WordSize));
+	memcpy(&((*msg)[0]), &len, sizeof(len));
+	return write_all(fd, msg->data(), msg->size());
+}
+
+bool ForkWorkers::read_message(Index i, string *msg) {
+	int fd(workers[i].fd);
+	WordSize len;
+	if(unlikely(!read_all(fd, reinterpret_cast<char *>(&len), sizeof(len)))) {
+		return false;
+	}
+	msg->resize(len);
+	return ((len == 0) || read_all(fd, &((*msg)[0]), len));
+}
+
+bool ForkWorkers::start(Index count) {
+	// The workers must not inherit buffered output
+	cout.flush();
+	fflush(stdout);
+	m_jobs = count;
+	for(Index i(0); likely(i != count); ++i) {
+		int fds[2];
+		if(unlikely(pipe(fds) != 0)) {
+			break;
+		}
+		pid_t pid(fork());
+		if(unlikely(pid < 0)) {
+			close(fds[0]);
+			close(fds[1]);
+			break;
+		}
+		if(pid == 0) {
+			close(fds[0]);
+			for(Workers::const_iterator it(workers.begin());
+				likely(it != workers.end()); ++it) {
+				close(it->fd);
+			}
+			bool success(run_worker(fds[1], i));
+			close(fds[1]);
+			_exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		close(fds[1]);
+		Worker w;
+		w.pid = pid;
+		w.fd = fds[0];
+		workers.push_back(w);
+	}
+	if(likely(workers.size() == count)) {
+		return true;
+	}
+	stop();
+	return false;
+}
+
+void ForkWorkers::stop() {
+	for(Workers::iterator it(workers.begin()); likely(it != workers.end()); ++it) {
+		kill(it->pid, SIGTERM);
+		close(it->fd);
+		int status;
+		while(unlikely(waitpid(it->pid, &status, 0) < 0) && (errno == EINTR)) {
+		}
+	}
+	workers.clear();
+}
+
+bool ForkWorkers::finish() {
+	bool success(true);
+	for(Workers::iterator it(workers.begin()); likely(it != workers.end()); ++it) {
+		close(it->fd);
+		int status(0);
+		while(unlikely(waitpid(it->pid, &status, 0) < 0)) {
+			if(errno != EINTR) {
+				break;
+			}
+		}
+		if(unlikely(!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))) {
+			success = false;
+		}
+	}
+	workers.clear();
+	return success;
+}
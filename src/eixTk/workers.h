@@ -0,0 +1,93 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_EIXTK_WORKERS_H_
+#define SRC_EIXTK_WORKERS_H_ 1
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+/**
+Forked worker processes, each sending messages to the parent through
+its own pipe. The parent decides from which worker it reads next, so
+results can be collected in any fixed order.
+**/
+class ForkWorkers {
+	public:
+		typedef std::vector<int>::size_type Index;
+
+		ForkWorkers() : m_jobs(0) {
+		}
+
+		virtual ~ForkWorkers() {
+			stop();
+		}
+
+		/**
+		@return jobs, or the number of processors if jobs is 0
+		**/
+		static unsigned int jobs_setting(unsigned int jobs);
+
+		/**
+		Start count workers; worker i calls run_worker(fd, i) and terminates
+		@return false if not all could be started (then none is running)
+		**/
+		bool start(Index count);
+
+		/**
+		@return the number of workers passed to start()
+		**/
+		Index jobs() const {
+			return m_jobs;
+		}
+
+		/**
+		Read the next message of worker i
+		@return false on error or if the worker has closed its pipe
+		**/
+		bool read_message(Index i, std::string *msg) ATTRIBUTE_NONNULL_;
+
+		/**
+		Close the pipes and wait for the workers
+		@return true if all workers succeeded
+		**/
+		bool finish();
+
+		/**
+		Kill all workers
+		**/
+		void stop();
+
+		/**
+		Start a message in a worker: The length is filled in by send_message
+		**/
+		static void init_message(std::string *msg) ATTRIBUTE_NONNULL_;
+
+		static bool send_message(int fd, std::string *msg) ATTRIBUTE_NONNULL_;
+
+	protected:
+		/**
+		Called in the worker process
+		@return true if successful
+		**/
+		virtual bool run_worker(int fd, Index i) = 0;
+
+	private:
+		class Worker {
+			public:
+				pid_t pid;
+				int fd;
+		};
+		typedef std::vector<Worker> Workers;
+
+		Workers workers;
+		Index m_jobs;
+};
+
+#endif  // SRC_EIXTK_WORKERS_H_
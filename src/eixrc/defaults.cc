@@ -10,8 +10,6 @@
 // Make check_includes happy:
 // #include <config.h> #include "eixTk/i18n.h" #include <cstdlib>
 
-#if (DEFAULT_PART == 1)
-
 AddOption(STRING, "EIXRC",
 	"", P_("EIXRC",
 	"The file which is used instead of /etc/eixrc and ~/.eixrc.\n"
@@ -168,6 +166,12 @@ AddOption(STRING, "EIX_PREVIOUS",
 	"%{EPREFIX}" EIX_PREVIOUS, P_("EIX_PREVIOUS",
 	"This file is the previous eix cache (used by eix-diff and eix-sync)."));
 
+AddOption(STRING, "EIX_HISTORY",
+	"", P_("EIX_HISTORY",
+	"If nonempty, eix-update appends the packages which changed since its previous\n"
+	"run to this file, so that eix-diff -G can compare any two of these\n"
+	"generations of the database."));
+
 AddOption(STRING, "EIX_REMOTE1",
 	"%{EPREFIX}" EIX_REMOTECACHEFILE1, P_("EIX_REMOTE1",
 	"This is the eix cache used when -R is in effect. If the string is nonempty,\n"
@@ -200,6 +204,11 @@ AddOption(STRING, "EBUILD_DEPEND_TEMP",
 	"%{EPREFIX_PORTAGE_EXEC}/var/cache/edb/dep/aux_db_key_temp", P_("EBUILD_DEPEND_TEMP",
 	"The path to the tempfile generated by \"ebuild depend\"."));
 
+AddOption(INTEGER, "EBUILD_JOBS",
+	"0", P_("EBUILD_JOBS",
+	"The maximal number of ebuild.sh processes run in parallel by the\n"
+	"cache method ebuild*. The value 0 means the number of processors."));
+
 AddOption(STRING, "EIX_WORLD",
 	"%{EPREFIX_ROOT}/var/lib/portage/world", P_("EIX_WORLD",
 	"This file is considered as the world file."));
@@ -273,6 +282,14 @@ AddOption(INTEGER, "EIX_LIMIT_COMPACT",
 	"The maximal number of matches shown on terminal in compact mode.\n"
 	"The value 0 means all matches are shown."));
 
+AddOption(INTEGER, "PRINT_JOBS",
+	"1", P_("PRINT_JOBS",
+	"The maximal number of processes formatting matches of eix in parallel.\n"
+	"The output is the same as with sequential formatting. Parallel\n"
+	"formatting is not used for --xml, --json, --brief, or if the output\n"
+	"is limited; --json prints each match as soon as it is found.\n"
+	"The value 0 means the number of processors."));
+
 AddOption(BOOLEAN, "QUICKMODE",
 	"false", P_("QUICKMODE",
 	"Whether --quick is on by default."));
@@ -291,6 +308,11 @@ AddOption(BOOLEAN, "QUIETMODE",
 	"false", P_("QUIETMODE",
 	"Whether --quiet is on by default."));
 
+AddOption(BOOLEAN, "EIX_STATS",
+	"false", P_("EIX_STATS",
+	"Whether --stats is on by default, i.e. whether eix, eix-diff, and eix-update\n"
+	"print the time spent in each phase and some counters to stderr at exit."));
+
 AddOption(STRING, "PRINT_APPEND",
 	"\\n", P_("PRINT_APPEND",
 	"This string is appended to the output of --print.\n"
@@ -313,6 +335,12 @@ AddOption(BOOLEAN, "DIFF_PRINT_HEADER",
 	"true", P_("DIFF_PRINT_HEADER",
 	"Should eix-diff print a header info line?"));
 
+AddOption(INTEGER, "DIFF_JOBS",
+	"1", P_("DIFF_JOBS",
+	"The number of processes in which eix-diff compares the categories.\n"
+	"The output is the same as with a single process.\n"
+	"The value 0 means the number of processors."));
+
 AddOption(BOOLEAN, "NO_RESTRICTIONS",
 	"false", P_("NO_RESTRICTIONS",
 	"This variable is only used for delayed substitution.\n"
@@ -356,6 +384,19 @@ AddOption(BOOLEAN, "REQUIRED_USE",
 	REQUIRED_USE_DEFAULT, P_("REQUIRED_USE",
 	"If true, store/use REQUIRED_USE. Usage increases disk/memory requirements."));
 
+AddOption(BOOLEAN, "SPLIT_NAMES",
+	"false", P_("SPLIT_NAMES",
+	"If true, eix-update stores the names, versions, slots, and overlays of the\n"
+	"packages of each category separately from the other data. This speeds up\n"
+	"searches which need only these."));
+
+AddOption(BOOLEAN, "NAMES_INDEX",
+	"true", P_("NAMES_INDEX",
+	"If true, eix-update appends a sorted index of the package names (and, with\n"
+	"DEP=true, of the dependencies) to the database. It is used by eix --complete\n"
+	"and eix --rdeps, and by eix to read only the installed packages if no other\n"
+	"package can match."));
+
 AddOption(STRING, "DEFAULT_FORMAT",
 	"normal", P_("DEFAULT_FORMAT",
 	"Defines whether --compact or --verbose is on by default."));
@@ -448,6 +489,11 @@ AddOption(BOOLEAN, "UPDATE_VERBOSE",
 	"false", P_("UPDATE_VERBOSE",
 	"Whether eix-update -v is on by default (output cache method per ebuild)"));
 
+AddOption(INTEGER, "UPDATE_WATCH_DELAY",
+	"5", P_("UPDATE_WATCH_DELAY",
+	"With eix-update --watch, the database is written when no further change\n"
+	"happened for this number of seconds."));
+
 AddOption(STRING, "CACHE_METHOD_PARSE",
 	"#metadata-md5#metadata-flat#assign", P_("CACHE_METHOD_PARSE",
 	"This string is appended to all cache methods using parse[*] or ebuild[*]."));
@@ -528,9 +574,6 @@ AddOption(BOOLEAN, "RECOMMEND_LOCAL_MODE",
 AddOption(BOOLEAN, "RECURSIVE_SETS",
 	"true", P_("RECURSIVE_SETS",
 	"Are packages/sets in included sets part of the parent set?"));
-#endif
-
-#if (DEFAULT_PART == 2)
 
 AddOption(BOOLEAN, "UPGRADE_TO_HIGHEST_SLOT",
 	"true", P_("UPGRADE_TO_HIGHEST_SLOT",
@@ -1105,9 +1148,6 @@ AddOption(BOOLEAN, "SLOT_UPGRADE_FORBID",
 	"%{\\EIXCFGDIR}/package.slot_upgrade_forbid", P_("SLOT_UPGRADE_FORBID",
 	"If UPGRADE_TO_HIGHEST_SLOT=true, then packages listed in these files/dirs\n"
 	"are treated as if UPGRADE_TO_HIGHEST_SLOT=false."));
-#endif
-
-#if (DEFAULT_PART == 3)
 
 AddOption(BOOLEAN, "SLOT_UPGRADE_ALLOW",
 	"%{\\EIXCFGDIR}/package.slot_upgrade_allow", P_("SLOT_UPGRADE_ALLOW",
@@ -1598,9 +1638,6 @@ AddOption(STRING, "TAG_NEW",
 	"(%{DIFF_COLOR_NEW_TAG})%{DIFF_CHAR_NEW}(%{COLOR_RESET})", P_("TAG_NEW",
 	"This variable is only used for delayed substitution.\n"
 	"It defines the tag printed for new packages (eix-diff)."));
-#endif
-
-#if (DEFAULT_PART == 4)
 
 AddOption(STRING, "TAG_BETTER",
 	"(%{DIFF_COLOR_BETTER})%{DIFF_CHAR_BETTER}(%{COLOR_RESET})", P_("TAG_BETTER",
@@ -2242,9 +2279,6 @@ AddOption(STRING, "IVERSIONS_VERBOSE",
 	"%{IVERSIONS}%{FORMAT_PROPRESTRICT}%{FORMAT_BINARY}%{OVERLAYVER}", P_("IVERSIONS_VERBOSE",
 	"This variable is only used for delayed substitution.\n"
 	"It defines the format for an installed version with most data and slot."));
-#endif
-
-#if (DEFAULT_PART == 5)
 
 AddOption(STRING, "PVERSIONO_VERBOSE",
 	"%{PVERSIONO}%{FORMAT_PROPRESTRICT}%{FORMAT_BINARY}%{OVERLAYVER}", P_("PVERSIONO_VERBOSE",
@@ -3186,9 +3220,6 @@ AddOption(STRING, "FORMATLINE_LICENSES",
 	"%{?PRINT_ALWAYS}{}%{FORMAT_NEWLINE}%{else}%{FORMAT_NEWLINE}{}%{}", P_("FORMATLINE_LICENSES",
 	"This variable is only used for delayed substitution.\n"
 	"It defines the format for a line with the package licenses."));
-#endif
-
-#if (DEFAULT_PART == 6)
 
 AddOption(STRING, "DIFF_FORMATLINE",
 	"%{FORMAT_OVERLAYKEY}"
@@ -3516,5 +3547,3 @@ AddOption(STRING, "DUMMY",
 	"", P_("DUMMY",
 	"This variable is ignored. You can use it to collect delayed references to\n"
 	"locally added (unused) variables so that they are printed with --dump."));
-
-#endif
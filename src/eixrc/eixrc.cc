@@ -15,8 +15,8 @@
 
 #include <iostream>
 #include <map>
-#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "eixTk/eixint.h"
@@ -38,7 +38,6 @@
 #define EIX_USERRC   "/.eixrc"
 
 using std::map;
-using std::set;
 using std::string;
 using std::vector;
 
@@ -53,15 +52,18 @@ const EixRc::DelayvarFlags
 
 static void override_by_env(map<string, string> *m) ATTRIBUTE_NONNULL_;
 
-EixRcOption::EixRcOption(OptionType t, string name, string val, string desc) {
-	type = t;
-	key = name;
-	if(type == LOCAL) {
-		local_value = val;
-	} else {
-		value = val;
-		description = desc;
+const char *EixRcOption::translated(const char *s) {
+	const char *msgid(strchr(s, EIX_GETTEXT_CONTEXT_GLUE[0]));
+	if(likely(msgid == NULLPTR)) {
+		return s;
 	}
+#ifdef ENABLE_NLS
+	const char *translation(gettext(s));
+	if(translation != s) {
+		return translation;
+	}
+#endif
+	return msgid + 1;
 }
 
 eix::SignedBool EixRc::getBoolText(const string& key, const char *text) {
@@ -155,15 +157,21 @@ LocalMode EixRc::getLocalMode(const string& key) {
 	return LOCALMODE_DEFAULT;
 }
 
-const char *EixRc::cstr(const string& key) const {
+const char *EixRc::cstr(const string& key) {
 	my_map::const_iterator s(main_map.find(key));
-	if(s == main_map.end()) {
+	if(likely(s != main_map.end())) {
+		return (s->second).c_str();
+	}
+	KeySet known;
+	KeyList local_keys;
+	join_all(&known, &local_keys);
+	if(known.find(key) == known.end()) {
 		return NULLPTR;
 	}
-	return (s->second).c_str();
+	return (*this)[key].c_str();
 }
 
-const char *EixRc::prefix_cstr(const string& key) const {
+const char *EixRc::prefix_cstr(const string& key) {
 	const char *s(cstr(key));
 	if(unlikely(s == NULLPTR)) {
 		return NULLPTR;
@@ -193,15 +201,8 @@ void EixRc::read() {
 	}
 	modify_value(&m_eprefixconf, name);
 
-	set<string> has_delayed;
-
-	// First, we create defaults and main_map with all variables
-	// (including all values required by delayed references).
-	read_undelayed(&has_delayed);
-
-	// Resolve delayed references recursively.
-	for(default_index i(0); i < defaults.size(); ++i)
-		resolve_delayed(defaults[i].key, &has_delayed);
+	// Delayed references are resolved only when a variable is needed
+	read_undelayed();
 
 	// set m_eprefixconf to possibly new settings:
 	m_eprefixconf = (*this)["PORTAGE_CONFIGROOT"];
@@ -209,30 +210,42 @@ void EixRc::read() {
 
 const string& EixRc::operator[](const string& key) {
 	my_map::const_iterator it(main_map.find(key));
-	if(it != main_map.end())
+	if(likely(it != main_map.end()))
 		return it->second;
-	add_later_variable(key);
+	requested.push_back(key);
+	resolve_delayed(key);
 	return main_map[key];
 }
 
-/**
-This will fetch a variable which was not set in the
-defaults (or its modification or its delayed references),
-i.e. it must be fetched from the config or ENV setting.
-Of course, it will be resolved for delayed substitutions,
-and delayed references are also be added similarly.
-**/
-void EixRc::add_later_variable(const string& key) {
-	set<string> has_delayed;
-	join_key(key, &has_delayed, true, NULLPTR);
-	resolve_delayed(key, &has_delayed);
+string EixRc::raw_value(const string& key) {
+	string value;
+	my_map::const_iterator f(filevarmap.find(key));
+	if(f != filevarmap.end()) {
+	/*
+	Note that if a variable is defined in a file and in ENV,
+	its value was already overridden from ENV.
+	*/
+		value = f->second;
+	} else {
+	// If it was not defined in a file, it might be in ENV anyway:
+		const char *envval(getenv(key.c_str()));
+		if(unlikely(envval != NULLPTR))
+			value = envval;
+	}
+	/*
+	For the case that some day e.g. variables with PREFIXSTRING
+	should possibly also allow to contain local variables,
+	better modify it:
+	*/
+	modify_value(&value, key);
+	return value;
 }
 
-void EixRc::resolve_delayed(const string& key, set<string> *has_delayed) {
-	set<string> visited;
+void EixRc::resolve_delayed(const string& key) {
+	KeySet visited;
 	const char *errtext;
 	string errvar;
-	if(unlikely(resolve_delayed_recurse(key, &visited, has_delayed,
+	if(unlikely(resolve_delayed_recurse(key, &visited,
 		&errtext, &errvar) == NULLPTR)) {
 		cerr << eix::format(_(
 			"fatal config error: %s in delayed substitution of %s"))
@@ -241,12 +254,20 @@ void EixRc::resolve_delayed(const string& key, set<string> *has_delayed) {
 	}
 }
 
-string *EixRc::resolve_delayed_recurse(const string& key, set<string> *visited, set<string> *has_delayed, const char **errtext, string *errvar) {
-	string *value(&(main_map[key]));
-	if(has_delayed->find(key) == has_delayed->end()) {
-		modify_value(value, key);
+string *EixRc::resolve_delayed_recurse(const string& key, KeySet *visited, const char **errtext, string *errvar) {
+	std::pair<my_map::iterator, bool> inserted(main_map.insert(
+		my_map::value_type(key, string())));
+	string *value(&(inserted.first->second));
+	if(likely(!inserted.second)) {
+		// The variable is resolved or currently being resolved
+		if(unlikely(visited->find(key) != visited->end())) {
+			*errtext = _("self-reference");
+			*errvar = key;
+			return NULLPTR;
+		}
 		return value;
 	}
+	*value = raw_value(key);
 	string::size_type pos(0);
 	for(;;) {
 		string::size_type length;
@@ -256,7 +277,6 @@ string *EixRc::resolve_delayed_recurse(const string& key, set<string> *visited,
 		bool will_test(false);
 		switch(type) {
 			case DelayedNotFound:
-				has_delayed->erase(key);
 				modify_value(value, key);
 				return value;
 			case DelayedFi:
@@ -288,7 +308,7 @@ string *EixRc::resolve_delayed_recurse(const string& key, set<string> *visited,
 		const string *s(resolve_delayed_recurse(
 			(((varflags & DELAYVAR_STAR) != DELAYVAR_NONE) ?
 				(varprefix + varname) : varname),
-			visited, has_delayed, errtext, errvar));
+			visited, errtext, errvar));
 		visited->erase(key);
 		if(unlikely(s == NULLPTR)) {
 			return NULLPTR;
@@ -400,14 +420,17 @@ static void override_by_env(map<string, string> *m) {
 }
 
 /**
-Create defaults and the main_map with all variables
-(including all values required by delayed references).
-@arg has_delayed is initialized to corresponding keys
+Create filevarmap with all variables from defaults, files and ENV
 **/
-void EixRc::read_undelayed(set<string> *has_delayed) {
-	// Initialize with the default variables
-	for(default_index i(0); likely(i < defaults.size()); ++i)
-		filevarmap[defaults[i].key] = defaults[i].value;
+void EixRc::read_undelayed() {
+	// Initialize with the default variables; in sorted order,
+	// each one is inserted at the end of the map
+	for(default_index i(0); likely(i < defaults_size); ++i) {
+		const EixRcOption& option(defaults[sorted_defaults[i]]);
+		my_map::iterator it(filevarmap.insert(filevarmap.end(),
+			my_map::value_type(option.key, option.get_value())));
+		modify_value(&(it->second), it->first);
+	}
 
 	// override with ENV
 	override_by_env(&filevarmap);
@@ -467,57 +490,31 @@ void EixRc::read_undelayed(set<string> *has_delayed) {
 		}
 	}
 
-	// Set new values as default and for printing with --dump.
-	set<string> original_defaults;
-	for(vector<EixRcOption>::iterator it(defaults.begin());
-		likely(it != defaults.end()); ++it) {
-		string *value(&filevarmap[it->key]);
-		modify_value(value, it->key);
-		it->local_value = *value;
-		original_defaults.insert(it->key);
-	}
-	// Since join_key_if_new modifies the defaults vector, our loop
-	// must go over a copy of the keys and not over the defaults vector.
-	for(set<string>::const_iterator it(original_defaults.begin());
-		likely(it != original_defaults.end()); ++it) {
-		join_key(*it, has_delayed, false, &original_defaults);
-	}
 }
 
 /**
-Recursively eval and join key and its delayed references to
-main_map and default; set has_delayed if appropriate
+Collect all variables: the defaults, the variables which are
+(recursively) referenced by them or by requested variables.
+@arg local_keys is appended the keys which are not defaults
 **/
-void EixRc::join_key(const string& key, set<string> *has_delayed, bool add_top_to_defaults, const set<string> *exclude_defaults) {
-	string *val(&main_map[key]);
-	my_map::const_iterator f(filevarmap.find(key));
-	if(unlikely(f != filevarmap.end())) {
-	/*
-	Note that if a variable is defined in a file and in ENV,
-	its value was already overridden from ENV.
-	*/
-		*val = f->second;
-	} else {
-	// If it was not defined in a file, it might be in ENV anyway:
-		char *envval(getenv(key.c_str()));
-		if(unlikely(envval != NULLPTR))
-			*val = string(envval);
+void EixRc::join_all(KeySet *known, KeyList *local_keys) {
+	for(default_index i(0); likely(i < defaults_size); ++i) {
+		join_key(defaults[sorted_defaults[i]].key, known, local_keys);
 	}
-	/*
-	For the case that some day e.g. prefix_keys (variables with
-	PREFIXSTRING) should possibly also allow to contain local variables,
-	better modify it:
-	*/
-	modify_value(val, key);
-
-	if(unlikely(add_top_to_defaults)) {
-		if(unlikely((exclude_defaults == NULLPTR) || (exclude_defaults->find(key) == exclude_defaults->end())))
-			defaults.push_back(EixRcOption(EixRcOption::LOCAL, key, *val, ""));
+	for(KeyList::const_iterator it(requested.begin());
+		likely(it != requested.end()); ++it) {
+		join_key(*it, known, local_keys);
 	}
-	join_key_rec(key, *val, has_delayed, exclude_defaults);
 }
 
-void EixRc::join_key_rec(const string& key, const string& val, set<string> *has_delayed, const set<string> *exclude_defaults) {
+void EixRc::join_key(const string& key, KeySet *known, KeyList *local_keys) {
+	if(!known->insert(key).second) {
+		return;
+	}
+	if(find_default(key) == NULLPTR) {
+		local_keys->push_back(key);
+	}
+	string val(raw_value(key));
 	string::size_type pos(0);
 	string::size_type length;
 	for(;; pos += length) {
@@ -531,10 +528,8 @@ void EixRc::join_key_rec(const string& key, const string& val, set<string> *has_
 			case DelayedIfFalse:
 				break;
 			default:
-				has_delayed->insert(key);
 				continue;
 		}
-		has_delayed->insert(key);
 		if(unlikely((varflags & DELAYVAR_STAR) != DELAYVAR_NONE)) {
 			static const char *prefixlist[] = {
 				EIX_VARS_PREFIX,
@@ -545,20 +540,14 @@ void EixRc::join_key_rec(const string& key, const string& val, set<string> *has_
 			};
 			for(const char **prefix(prefixlist);
 				*prefix != NULLPTR; ++prefix) {
-				join_key_if_new(string(*prefix) + varname,
-				has_delayed, exclude_defaults);
+				join_key(string(*prefix) + varname, known, local_keys);
 			}
 		} else {
-			join_key_if_new(varname, has_delayed, exclude_defaults);
+			join_key(varname, known, local_keys);
 		}
 	}
 }
 
-void EixRc::join_key_if_new(const string& key, set<string> *has_delayed, const set<string> *exclude_defaults) {
-	if(unlikely(main_map.find(key) == main_map.end()))
-		join_key(key, has_delayed, true, exclude_defaults);
-}
-
 EixRc::DelayedType EixRc::find_next_delayed(const string& str, string::size_type *posref, string::size_type *length, string *varname, DelayvarFlags *varflags, string *append) {
 	string::size_type pos(*posref);
 	for(;; pos += 2) {
@@ -681,23 +670,35 @@ EixRc::DelayedType EixRc::find_next_delayed(const string& str, string::size_type
 
 void EixRc::modify_value(string *value, const string& key) {
 	if(*value == "/") {
-		if(prefix_keys.find(key) != prefix_keys.end())
+		const EixRcOption *option(find_default(key));
+		if((option != NULLPTR) && (option->type == EixRcOption::PREFIXSTRING))
 			value->clear();
 	}
 }
 
 void EixRc::clear() {
-	defaults.clear();
-	prefix_keys.clear();
 	filevarmap.clear();
 	main_map.clear();
+	requested.clear();
 }
 
-void EixRc::addDefault(EixRcOption option) {
-	if(unlikely(option.type == EixRcOption::PREFIXSTRING))
-		prefix_keys.insert(option.key);
-	modify_value(&(option.value), option.key);
-	defaults.push_back(option);
+const EixRcOption *EixRc::find_default(const string& key) {
+	default_index low(0);
+	default_index high(defaults_size);
+	while(low < high) {
+		default_index mid((low + high) / 2);
+		const EixRcOption *option(defaults + sorted_defaults[mid]);
+		int cmp(key.compare(option->key));
+		if(cmp == 0) {
+			return option;
+		}
+		if(cmp < 0) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+	return NULLPTR;
 }
 
 bool EixRc::istrue(const char *s) {
@@ -786,7 +787,7 @@ void EixRc::dumpDefaults(FILE *s, bool use_defaults) {
 	string message(use_defaults ?
 		_("was locally changed to:") :
 		_("changed locally, default was:"));
-	for(vector<EixRcOption>::size_type i(0); likely(i < defaults.size()); ++i) {
+	for(default_index i(0); likely(i < defaults_size); ++i) {
 		const char *typestring("UNKNOWN");
 		switch(defaults[i].type) {
 			case EixRcOption::BOOLEAN:
@@ -801,23 +802,15 @@ void EixRc::dumpDefaults(FILE *s, bool use_defaults) {
 			case EixRcOption::INTEGER:
 				typestring = "INTEGER";
 				break;
-			case EixRcOption::LOCAL:
-				typestring = NULLPTR;
-				break;
 			default:
 				break;
 		}
-		const char *key(defaults[i].key.c_str());
-		string value(defaults[i].local_value);
+		const char *key(defaults[i].key);
+		string value(raw_value(key));
 		escape_string(&value, doublequotes);
-		string deflt(defaults[i].value);
+		string deflt(defaults[i].get_value());
+		modify_value(&deflt, key);
 		escape_string(&deflt, doublequotes);
-		if(unlikely(typestring == NULLPTR)) {
-			fprintf(s, "# %s\n%s=\"%s\"\n\n",
-				_("locally added:"),
-				key, value.c_str());
-			continue;
-		}
 		const string& output(use_defaults ? deflt : value);
 		const string& comment(use_defaults ? value : deflt);
 
@@ -826,7 +819,7 @@ void EixRc::dumpDefaults(FILE *s, bool use_defaults) {
 				"# %s\n"
 				"%s=\"%s\"\n",
 				as_comment(typestring).c_str(),
-				as_comment(defaults[i].description.c_str()).c_str(),
+				as_comment(defaults[i].get_description()).c_str(),
 				key,
 				output.c_str());
 		if(deflt == value) {
@@ -840,4 +833,15 @@ void EixRc::dumpDefaults(FILE *s, bool use_defaults) {
 				as_comment(comment).c_str());
 		}
 	}
+	KeySet known;
+	KeyList local_keys;
+	join_all(&known, &local_keys);
+	for(KeyList::const_iterator it(local_keys.begin());
+		likely(it != local_keys.end()); ++it) {
+		string value(raw_value(*it));
+		escape_string(&value, doublequotes);
+		fprintf(s, "# %s\n%s=\"%s\"\n\n",
+			_("locally added:"),
+			it->c_str(), value.c_str());
+	}
 }
@@ -29,13 +29,30 @@
 #define UPDATE_VARS_PREFIX "UPDATE_"
 #define DROP_VARS_PREFIX "DROP_"
 
+/**
+A default variable. All strings are static; value and description may
+start with a gettext context which is translated only when needed.
+This is an aggregate so that the table of defaults is initialized statically.
+**/
 class EixRcOption {
 	public:
-		typedef enum { STRING, PREFIXSTRING, INTEGER, BOOLEAN, LOCAL } OptionType;
+		typedef enum { STRING, PREFIXSTRING, INTEGER, BOOLEAN } OptionType;
 		OptionType type;
-		std::string key, value, local_value, description;
+		const char *key, *value, *description;
 
-		EixRcOption(OptionType t, std::string name, std::string val, std::string desc);
+		/**
+		@return the default value, translated if necessary
+		**/
+		const char *get_value() const ATTRIBUTE_NONNULL_ {
+			return translated(value);
+		}
+
+		const char *get_description() const ATTRIBUTE_NONNULL_ {
+			return translated(description);
+		}
+
+	private:
+		static const char *translated(const char *s) ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
 };
 
 class EixRc {
@@ -45,15 +62,13 @@ class EixRc {
 		explicit EixRc(const char *prefix) ATTRIBUTE_NONNULL_ : varprefix(prefix) {
 		}
 
-		typedef std::vector<EixRcOption>::size_type default_index;
+		typedef unsigned int default_index;
 		typedef std::pair<RedAtom, RedAtom> RedPair;
 
 		void read();
 
 		void clear();
 
-		void addDefault(EixRcOption option);
-
 		bool getBool(const std::string& key) {
 			return istrue((*this)[key].c_str());
 		}
@@ -72,9 +87,12 @@ class EixRc {
 
 		void dumpDefaults(FILE *s, bool use_defaults) ATTRIBUTE_NONNULL_;
 
-		const char *cstr(const std::string& key) const ATTRIBUTE_PURE;
+		/**
+		@return a null pointer if key is neither a default nor referenced by one
+		**/
+		const char *cstr(const std::string& key);
 
-		const char *prefix_cstr(const std::string& key) const ATTRIBUTE_PURE;
+		const char *prefix_cstr(const std::string& key);
 
 		void known_vars();
 		bool print_var(const std::string& key);
@@ -83,44 +101,62 @@ class EixRc {
 
 	private:
 		typedef std::map<std::string, std::string> my_map;
+		typedef std::set<std::string> KeySet;
+		typedef std::vector<std::string> KeyList;
 		std::string varprefix;
+		/**
+		The resolved variables; they are resolved only when first needed
+		**/
 		my_map main_map;
+		/**
+		The unresolved variables from the defaults, files, and ENV
+		**/
 		my_map filevarmap;
-		std::vector<EixRcOption> defaults;
-		std::set<std::string> prefix_keys;
+		/**
+		The defaults in the order of defaults.cc and def_i18n.cc, and the
+		indices of the entries sorted by key. Both tables are generated
+		at build time into defaults_table.cc by generate_defaults.sh.
+		**/
+		static const EixRcOption defaults[];
+		static const default_index defaults_size;
+		static const default_index sorted_defaults[];
+		/**
+		The variables which were asked for (for --dump)
+		**/
+		KeyList requested;
 
 		enum DelayedType { DelayedNotFound, DelayedVariable, DelayedIfTrue, DelayedIfFalse, DelayedIfNonempty, DelayedIfEmpty, DelayedElse, DelayedFi, DelayedQuote };
 
+		/**
+		@return the default of key (by binary search) or a null pointer
+		**/
+		static const EixRcOption *find_default(const std::string& key) ATTRIBUTE_PURE;
+
 		static bool istrue(const char *s) ATTRIBUTE_PURE;
 		static bool getRedundantFlagAtom(const char *s, Keywords::Redundant type, RedAtom *r) ATTRIBUTE_NONNULL((3));
 
 		void modify_value(std::string *value, const std::string& key);
 
 		/**
-		This will fetch a variable which was not set in the
-		defaults (or its modification or its delayed references),
-		i.e. it must be fetched from the config or ENV setting.
-		Of course, it will be resolved for delayed substitutions,
-		and delayed references are also be added similarly.
+		@return the unresolved value of key from the config or ENV setting
 		**/
-		void add_later_variable(const std::string& key);
+		std::string raw_value(const std::string& key);
 
-		void resolve_delayed(const std::string& key, std::set<std::string> *has_delayed) ATTRIBUTE_NONNULL_;
-		std::string *resolve_delayed_recurse(const std::string& key, std::set<std::string> *visited, std::set<std::string> *has_delayed, const char **errtext, std::string *errvar) ATTRIBUTE_NONNULL_;
+		void resolve_delayed(const std::string& key);
+		std::string *resolve_delayed_recurse(const std::string& key, KeySet *visited, const char **errtext, std::string *errvar) ATTRIBUTE_NONNULL_;
 
 		/**
-		Create defaults and main_map with all variables
-		(including all values required by delayed references).
-		@arg has_delayed is initialized to corresponding keys
+		Create filevarmap with all variables from defaults, files and ENV
 		**/
-		void read_undelayed(std::set<std::string> *has_delayed) ATTRIBUTE_NONNULL_;
+		void read_undelayed();
+
 		/**
-		Recursively join key and its delayed references to
-		main_map and default; set has_delayed if appropriate
+		Collect all variables: the defaults, the variables which are
+		(recursively) referenced by them or by requested variables.
+		@arg local_keys is appended the keys which are not defaults
 		**/
-		void join_key(const std::string& key, std::set<std::string> *has_delayed, bool add_top_to_defaults, const std::set<std::string> *exclude_defaults) ATTRIBUTE_NONNULL((3));
-		void join_key_rec(const std::string& key, const std::string& val, std::set<std::string> *has_delayed, const std::set<std::string> *exclude_defaults) ATTRIBUTE_NONNULL((4));
-		void join_key_if_new(const std::string& key, std::set<std::string> *has_delayed, const std::set<std::string> *exclude_defaults) ATTRIBUTE_NONNULL((3));
+		void join_all(KeySet *known, KeyList *local_keys) ATTRIBUTE_NONNULL_;
+		void join_key(const std::string& key, KeySet *known, KeyList *local_keys) ATTRIBUTE_NONNULL((3, 4));
 
 		typedef uint8_t DelayvarFlags;
 		static CONSTEXPR DelayvarFlags
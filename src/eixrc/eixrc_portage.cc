@@ -27,10 +27,8 @@ using std::cout;
 
 void EixRc::known_vars() {
 	set<string> vars;
-	for(map<string, string>::const_iterator it(main_map.begin());
-		it != main_map.end(); ++it) {
-		vars.insert(it->first);
-	}
+	KeyList local_keys;
+	join_all(&vars, &local_keys);
 	ParseError parse_error(true);
 	PortageSettings ps(this, &parse_error, false, true);
 	for(map<string, string>::const_iterator it(ps.begin());
@@ -0,0 +1,46 @@
+#!/usr/bin/env sh
+# Generate the static table of the eixrc defaults from the AddOption lines
+# of the files passed as arguments (defaults.cc and def_i18n.cc).
+# The table keeps the order of the files (for --dump); the index lists
+# the entries sorted by key (for the binary search).
+set -u
+
+LC_ALL=C
+export LC_ALL
+
+cat<<END
+// AUTOGENERATED BY MAKE .. DO NOT EDIT!
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Wolfgang Frisch <xororand@users.sourceforge.net>
+//   Emil Beinroth <emilbeinroth@gmx.net>
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include "eixrc/eixrc.h"
+#include "eixrc/globals.h"
+
+const EixRcOption EixRc::defaults[] = {
+END
+
+sed -e 's/));$/)),/' -- "$@" || exit
+
+cat<<END
+};
+
+const EixRc::default_index EixRc::defaults_size =
+	sizeof(EixRc::defaults) / sizeof(EixRc::defaults[0]);
+
+const EixRc::default_index EixRc::sorted_defaults[] = {
+END
+
+sed -n -e 's/^AddOption([A-Z]*, "\([^"]*\)".*$/\1/p' -- "$@" \
+	| awk '{ print $0, NR - 1 }' | sort | awk '{ print "\t" $2 "," }' \
+	|| exit
+
+cat<<END
+};
+END
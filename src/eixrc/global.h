@@ -22,11 +22,4 @@ EixRc& get_eixrc(const char *varprefix) ATTRIBUTE_NONNULL_;
 **/
 EixRc& get_eixrc() ATTRIBUTE_PURE;
 
-void fill_defaults_part_1(EixRc *eixrc) ATTRIBUTE_NONNULL_;
-void fill_defaults_part_2(EixRc *eixrc) ATTRIBUTE_NONNULL_;
-void fill_defaults_part_3(EixRc *eixrc) ATTRIBUTE_NONNULL_;
-void fill_defaults_part_4(EixRc *eixrc) ATTRIBUTE_NONNULL_;
-void fill_defaults_part_5(EixRc *eixrc) ATTRIBUTE_NONNULL_;
-void fill_defaults_part_6(EixRc *eixrc) ATTRIBUTE_NONNULL_;
-
 #endif  // SRC_EIXRC_GLOBAL_H_
@@ -31,8 +31,13 @@
 #define EXIT_FAILURE 1
 #endif
 
+// The defaults are static strings: Translations are looked up only
+// when needed; see EixRcOption
+
+#undef P_
+#define P_(p, a) p EIX_GETTEXT_CONTEXT_GLUE a
+
 #define AddOption(opt_type, opt_name, opt_default, opt_description) \
-	eixrc->addDefault(EixRcOption(EixRcOption::opt_type, opt_name, \
-		opt_default, opt_description))
+	{ EixRcOption::opt_type, opt_name, opt_default, opt_description }
 
 #endif  // SRC_EIXRC_GLOBALS_H_
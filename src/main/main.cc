@@ -23,6 +23,7 @@
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/stats.h"
 #include "eixTk/stringutils.h"
 #include "main/main.h"
 
@@ -34,6 +35,7 @@ You must define by a wrapper file - one or several of
 	VERSIONSORT_BINARY
 	MASKED_BINARY
 	DROP_PERMISSIONS_BINARY
+	BENCH_BINARY (not with others)
 to build the corresponding functionality into the generated binary.
 If several are selected, main() will select depending on the call name.
 */
@@ -98,6 +100,14 @@ If several are selected, main() will select depending on the call name.
 #endif
 #endif
 
+#ifdef BENCH_BINARY
+#ifdef USE_BINARY
+#error "BENCH_BINARY cannot be combined with other binaries"
+#else
+#define USE_BINARY run_eix_bench
+#endif
+#endif
+
 #ifdef BINARY_COLLECTION
 #undef USE_BINARY
 #define USE_BINARY run_program
@@ -209,6 +219,7 @@ inline static int run_program(int argc, char *argv[]) {
 #endif
 
 int main(int argc, char** argv) {
+	Stats::init();
 #ifdef ENABLE_NLS
 	/* Initialize GNU gettext support */
 	setlocale (LC_ALL, "");
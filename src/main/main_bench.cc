@@ -0,0 +1,11 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#define BENCH_BINARY 1
+#include "main/main.cc"  // NOLINT(build/include)
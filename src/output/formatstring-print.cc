@@ -47,7 +47,7 @@ using std::string;
 using std::cerr;
 using std::endl;
 
-static Package *old_or_new(string *new_name, Package *older, Package *newer, const string& name) ATTRIBUTE_NONNULL_;
+static bool is_old_name(string *new_name, const string& name) ATTRIBUTE_NONNULL_;
 
 class VersionVariables {
 	private:
@@ -342,8 +342,8 @@ class Scanner {
 		};
 		enum Prop { PKG, VER };
 		typedef void (PrintFormat::*Plain)(OutputString *s, Package *pkg) const;
-		typedef void (PrintFormat::*ColonVar)(Package *pkg, const string& after_colon) const;
-		typedef void (PrintFormat::*ColonOther)(OutputString *s, Package *pkg, const string& after_colon) const;
+		typedef void (PrintFormat::*ColonVar)(Package *pkg, ColonArgument *arg) const;
+		typedef void (PrintFormat::*ColonOther)(OutputString *s, Package *pkg, ColonArgument *arg) const;
 
 	protected:
 		map<string, Diff> diff;
@@ -569,43 +569,61 @@ void PrintFormat::init_static() {
 	AnsiColor::init_static();
 }
 
-void PrintFormat::get_pkg_property(OutputString *s, Package *package, const string& name) const {
+/**
+The resolved form of a non-diff property
+**/
+class CompiledPackageProperty : public CompiledProperty {
+	public:
+		string name;
+		Scanner::Prop t;
+		Scanner::Plain plain;
+		Scanner::ColonVar colon_var;
+		Scanner::ColonOther colon_other;
+		ColonArgument arg;
+
+		CompiledPackageProperty(const PrintFormat *fmt, const string& n, Scanner::Prop type, Scanner::Plain p) : CompiledProperty(KIND_PACKAGE, fmt), name(n), t(type), plain(p), colon_var(NULLPTR), colon_other(NULLPTR), arg(string()) {
+		}
+
+		CompiledPackageProperty(const PrintFormat *fmt, const string& n, Scanner::Prop type, Scanner::ColonVar cv, Scanner::ColonOther co, const string& after_colon) : CompiledProperty(KIND_PACKAGE, fmt), name(n), t(type), plain(NULLPTR), colon_var(cv), colon_other(co), arg(after_colon) {
+		}
+};
+
+static CompiledPackageProperty *compile_pkg_property(const PrintFormat *fmt, const string& name) ATTRIBUTE_NONNULL_;
+
+static CompiledPackageProperty *compile_pkg_property(const PrintFormat *fmt, const string& name) {
 	eix_assert_static(scanner != NULLPTR);
 	Scanner::Prop t;
 	Scanner::Plain plain(scanner->get_plain(name, &t));
-	Scanner::ColonVar colon_var;
-	Scanner::ColonOther colon_other;
-	string after_colon;
-	if(plain == NULLPTR) {
-		string::size_type col(name.find(':'));
-		if(likely(col != string::npos)) {
-			// we misuse here "after_colon" to mean "before_colon"
-			after_colon.assign(name.substr(0, col));
-			colon_var = scanner->get_colon_var(after_colon, &t);
-			if(unlikely(colon_var == NULLPTR)) {
-				colon_other = scanner->get_colon_other(after_colon, &t);
-				if(unlikely(colon_other == NULLPTR)) {
-					// flag that we failed
-					col = string::npos;
-				}
-			}
+	if(plain != NULLPTR) {
+		return new CompiledPackageProperty(fmt, name, t, plain);
+	}
+	string::size_type col(name.find(':'));
+	if(likely(col != string::npos)) {
+		string before_colon(name, 0, col);
+		Scanner::ColonVar colon_var(scanner->get_colon_var(before_colon, &t));
+		Scanner::ColonOther colon_other(NULLPTR);
+		if(colon_var == NULLPTR) {
+			colon_other = scanner->get_colon_other(before_colon, &t);
 		}
-		if(unlikely(col == string::npos)) {
-			cerr << eix::format(_("unknown property \"%s\"")) % name << endl;
-			exit(EXIT_FAILURE);
+		if(likely((colon_var != NULLPTR) || (colon_other != NULLPTR))) {
+			return new CompiledPackageProperty(fmt, name, t, colon_var, colon_other, name.substr(col + 1));
 		}
-		after_colon.assign(name, col + 1, string::npos);
 	}
-	if(unlikely((t == Scanner::VER) && (version_variables == NULLPTR))) {
-		cerr << eix::format(_("property \"%s\" used outside version context")) % name << endl;
+	cerr << eix::format(_("unknown property \"%s\"")) % name << endl;
+	exit(EXIT_FAILURE);
+}
+
+void PrintFormat::get_pkg_property(OutputString *s, Package *package, CompiledPackageProperty *prop) const {
+	if(unlikely((prop->t == Scanner::VER) && (version_variables == NULLPTR))) {
+		cerr << eix::format(_("property \"%s\" used outside version context")) % prop->name << endl;
 		exit(EXIT_FAILURE);
 	}
-	if(plain != NULLPTR) {
-		(this->*plain)(s, package);
+	if(prop->plain != NULLPTR) {
+		(this->*(prop->plain))(s, package);
 		return;
 	}
-	if(colon_var == NULLPTR) {
-		(this->*colon_other)(s, package, after_colon);
+	if(prop->colon_var == NULLPTR) {
+		(this->*(prop->colon_other))(s, package, &(prop->arg));
 		return;
 	}
 	// colon_var:
@@ -615,21 +633,24 @@ void PrintFormat::get_pkg_property(OutputString *s, Package *package, const stri
 	VersionVariables variables;
 	VersionVariables *previous_variables(version_variables);
 	version_variables = &variables;
-	(this->*colon_var)(package, after_colon);
+	(this->*(prop->colon_var))(package, &(prop->arg));
 	version_variables = previous_variables;
 	s->assign(variables.result);
 }
 
-void PrintFormat::COLON_VER_DATE(OutputString *s, Package *package, const string& after_colon) const {
+void PrintFormat::COLON_VER_DATE(OutputString *s, Package *package, ColonArgument *arg) const {
 	if(version_variables->isinst) {
 		InstVersion *i(version_variables->instver());
 		vardb->readInstDate(*package, i);
-		s->assign_smart(date_conv((*eix_rc)[after_colon].c_str(), i->instDate));
+		if(unlikely(arg->value == NULLPTR)) {
+			arg->value = &((*eix_rc)[arg->whole.name]);
+		}
+		s->assign_smart(date_conv(arg->value->c_str(), i->instDate));
 		return;
 	}
 }
 
-void PrintFormat::colon_pkg_availableversions(Package *package, const string& after_colon, bool only_marked) const {
+void PrintFormat::colon_pkg_availableversions(Package *package, ColonArgument *arg, bool only_marked) const {
 	VerVec *versions(NULLPTR);
 	if(unlikely(only_marked)) {
 		if(unlikely(marked_list == NULLPTR) ||
@@ -649,87 +670,84 @@ void PrintFormat::colon_pkg_availableversions(Package *package, const string& af
 			return;
 		}
 	}
-	string::size_type col(after_colon.find(':'));
-	if(col == string::npos) {
-		get_versions_versorted(package, parse_variable(after_colon), versions);
-		varcache[after_colon].in_use = false;
+	if(!(arg->two_parts)) {
+		get_versions_versorted(package, parse_variable(&(arg->whole)), versions);
+		arg->whole.release();
 	} else if(!(package->have_nontrivial_slots())) {
-		string var(after_colon, 0, col);
-		get_versions_versorted(package, parse_variable(var), versions);
-		varcache[var].in_use = false;
+		get_versions_versorted(package, parse_variable(&(arg->first)), versions);
+		arg->first.release();
 	} else {
-		string var(after_colon, col + 1, string::npos);
-		get_versions_slotsorted(package, parse_variable(var), versions);
-		varcache[var].in_use = false;
+		get_versions_slotsorted(package, parse_variable(&(arg->second)), versions);
+		arg->second.release();
 	}
 	delete versions;
 }
 
-void PrintFormat::COLON_PKG_AVAILABLEVERSIONS(Package *package, const string& after_colon) const {
-	colon_pkg_availableversions(package, after_colon, false);
+void PrintFormat::COLON_PKG_AVAILABLEVERSIONS(Package *package, ColonArgument *arg) const {
+	colon_pkg_availableversions(package, arg, false);
 }
 
-void PrintFormat::COLON_PKG_MARKEDVERSIONS(Package *package, const string& after_colon) const {
-	colon_pkg_availableversions(package, after_colon, true);
+void PrintFormat::COLON_PKG_MARKEDVERSIONS(Package *package, ColonArgument *arg) const {
+	colon_pkg_availableversions(package, arg, true);
 }
 
-void PrintFormat::colon_pkg_bestversion(Package *package, const string& after_colon, bool allow_unstable) const {
+void PrintFormat::colon_pkg_bestversion(Package *package, ColonArgument *arg, bool allow_unstable) const {
 	const Version *ver(package->best(allow_unstable));
 	version_variables->setversion(ver);
 	if(likely(ver != NULLPTR)) {
-		recPrint(&(version_variables->result), package, get_package_property, parse_variable(after_colon));
-		varcache[after_colon].in_use = false;
+		recPrint(&(version_variables->result), package, get_package_property, parse_variable(&(arg->whole)));
+		arg->whole.release();
 	}
 }
 
-void PrintFormat::COLON_PKG_BESTVERSION(Package *package, const string& after_colon) const {
-	colon_pkg_bestversion(package, after_colon, false);
+void PrintFormat::COLON_PKG_BESTVERSION(Package *package, ColonArgument *arg) const {
+	colon_pkg_bestversion(package, arg, false);
 }
 
-void PrintFormat::COLON_PKG_BESTVERSIONS(Package *package, const string& after_colon) const {
-	colon_pkg_bestversion(package, after_colon, true);
+void PrintFormat::COLON_PKG_BESTVERSIONS(Package *package, ColonArgument *arg) const {
+	colon_pkg_bestversion(package, arg, true);
 }
 
-void PrintFormat::colon_pkg_bestslotversions(Package *package, const string& after_colon, bool allow_unstable) const {
+void PrintFormat::colon_pkg_bestslotversions(Package *package, ColonArgument *arg, bool allow_unstable) const {
 	const Version *ver(package->best(allow_unstable));
 	version_variables->setversion(ver);
 	VerVec versions;
 	package->best_slots(&versions, allow_unstable);
 	if(!versions.empty()) {
-		get_versions_versorted(package, parse_variable(after_colon), &versions);
-		varcache[after_colon].in_use = false;
+		get_versions_versorted(package, parse_variable(&(arg->whole)), &versions);
+		arg->whole.release();
 	}
 }
 
-void PrintFormat::COLON_PKG_BESTSLOTVERSIONS(Package *package, const string& after_colon) const {
-	colon_pkg_bestslotversions(package, after_colon, false);
+void PrintFormat::COLON_PKG_BESTSLOTVERSIONS(Package *package, ColonArgument *arg) const {
+	colon_pkg_bestslotversions(package, arg, false);
 }
 
-void PrintFormat::COLON_PKG_BESTSLOTVERSIONSS(Package *package, const string& after_colon) const {
-	colon_pkg_bestslotversions(package, after_colon, true);
+void PrintFormat::COLON_PKG_BESTSLOTVERSIONSS(Package *package, ColonArgument *arg) const {
+	colon_pkg_bestslotversions(package, arg, true);
 }
 
-void PrintFormat::colon_pkg_bestslotupgradeversions(Package *package, const string& after_colon, bool allow_unstable) const {
+void PrintFormat::colon_pkg_bestslotupgradeversions(Package *package, ColonArgument *arg, bool allow_unstable) const {
 	VerVec versions;
 	package->best_slots_upgrade(&versions, vardb, portagesettings, allow_unstable);
 	if(!versions.empty()) {
-		get_versions_versorted(package, parse_variable(after_colon), &versions);
-		varcache[after_colon].in_use = false;
+		get_versions_versorted(package, parse_variable(&(arg->whole)), &versions);
+		arg->whole.release();
 	}
 }
 
-void PrintFormat::COLON_PKG_BESTSLOTUPGRADEVERSIONS(Package *package, const string& after_colon) const {
-	colon_pkg_bestslotupgradeversions(package, after_colon, false);
+void PrintFormat::COLON_PKG_BESTSLOTUPGRADEVERSIONS(Package *package, ColonArgument *arg) const {
+	colon_pkg_bestslotupgradeversions(package, arg, false);
 }
 
-void PrintFormat::COLON_PKG_BESTSLOTUPGRADEVERSIONSS(Package *package, const string& after_colon) const {
-	colon_pkg_bestslotupgradeversions(package, after_colon, true);
+void PrintFormat::COLON_PKG_BESTSLOTUPGRADEVERSIONSS(Package *package, ColonArgument *arg) const {
+	colon_pkg_bestslotupgradeversions(package, arg, true);
 }
 
-void PrintFormat::COLON_PKG_INSTALLEDVERSIONS(Package *package, const string& after_colon) const {
+void PrintFormat::COLON_PKG_INSTALLEDVERSIONS(Package *package, ColonArgument *arg) const {
 	version_variables->isinst = true;
-	get_installed(package, parse_variable(after_colon));
-	varcache[after_colon].in_use = false;
+	get_installed(package, parse_variable(&(arg->whole)));
+	arg->whole.release();
 }
 
 void PrintFormat::PKG_INSTALLED(OutputString *s, Package *package) const {
@@ -1769,28 +1787,63 @@ void PrintFormat::VER_MASKREASONSS(OutputString *s, Package *package ATTRIBUTE_U
 	ver_maskreasons(s, maskreasonss_skip, maskreasonss_sep);
 }
 
-static Package *old_or_new(string *new_name, Package *older, Package *newer, const string& name) {
+/**
+@return true if name refers to the old package; new_name is the stripped name
+**/
+static bool is_old_name(string *new_name, const string& name) {
 	const char *s(name.c_str());
 	if(strncmp(s, "old", 3) == 0) {
 		*new_name = s + 3;
-		return older;
+		return true;
 	}
 	if(strncmp(s, "new", 3) == 0) {
 		*new_name = s + 3;
-		return newer;
+		return false;
 	}
 	*new_name = name;
-	return newer;
+	return false;
 }
 
-void get_package_property(OutputString *s, const PrintFormat *fmt, void *entity, const string& name) {
-	fmt->get_pkg_property(s, static_cast<Package *>(entity), name);
+/**
+The resolved form of a property of eix-diff
+**/
+class CompiledDiffProperty : public CompiledProperty {
+	public:
+		Scanner::Diff diff;
+		bool older;
+		CompiledPackageProperty *prop;
+
+		CompiledDiffProperty(const PrintFormat *fmt, Scanner::Diff d) : CompiledProperty(KIND_DIFF, fmt), diff(d), older(false), prop(NULLPTR) {
+		}
+
+		~CompiledDiffProperty() {
+			delete prop;
+		}
+};
+
+void get_package_property(OutputString *s, const PrintFormat *fmt, void *entity, const Property& prop) {
+	CompiledProperty *c(prop.get_compiled(CompiledProperty::KIND_PACKAGE, fmt));
+	if(unlikely(c == NULLPTR)) {
+		c = compile_pkg_property(fmt, prop.name);
+		prop.set_compiled(c);
+	}
+	fmt->get_pkg_property(s, static_cast<Package *>(entity), static_cast<CompiledPackageProperty *>(c));
 }
 
-void get_diff_package_property(OutputString *s, const PrintFormat *fmt, void *entity, const string& name) {
+void get_diff_package_property(OutputString *s, const PrintFormat *fmt, void *entity, const Property& prop) {
 	Package *older((static_cast<Package**>(entity))[0]);
 	Package *newer((static_cast<Package**>(entity))[1]);
-	Scanner::Diff diff(scanner->get_diff(name));
+	CompiledDiffProperty *c(static_cast<CompiledDiffProperty *>(prop.get_compiled(CompiledProperty::KIND_DIFF, fmt)));
+	if(unlikely(c == NULLPTR)) {
+		c = new CompiledDiffProperty(fmt, scanner->get_diff(prop.name));
+		if(c->diff == Scanner::DIFF_NONE) {
+			string new_name;
+			c->older = is_old_name(&new_name, prop.name);
+			c->prop = compile_pkg_property(fmt, new_name);
+		}
+		prop.set_compiled(c);
+	}
+	Scanner::Diff diff(c->diff);
 	if(unlikely(diff != Scanner::DIFF_NONE)) {
 		LocalCopy copynewer(fmt, newer);
 		LocalCopy copyolder(fmt, older);
@@ -1823,7 +1876,5 @@ void get_diff_package_property(OutputString *s, const PrintFormat *fmt, void *en
 		}
 		return;
 	}
-	string new_name;
-	Package *package(old_or_new(&new_name, older, newer, name));
-	fmt->get_pkg_property(s, package, new_name);
+	fmt->get_pkg_property(s, (c->older ? older : newer), c->prop);
 }
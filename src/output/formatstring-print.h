@@ -10,12 +10,11 @@
 #ifndef SRC_OUTPUT_FORMATSTRING_PRINT_H_
 #define SRC_OUTPUT_FORMATSTRING_PRINT_H_ 1
 
-#include <string>
-
-class PrintFormat;
 class OutputString;
+class PrintFormat;
+class Property;
 
-void get_package_property(OutputString *s, const PrintFormat *fmt, void *entity, const std::string& name) ATTRIBUTE_NONNULL_;
-void get_diff_package_property(OutputString *s, const PrintFormat *fmt, void *void_entity, const std::string& name) ATTRIBUTE_NONNULL_;
+void get_package_property(OutputString *s, const PrintFormat *fmt, void *entity, const Property& prop) ATTRIBUTE_NONNULL_;
+void get_diff_package_property(OutputString *s, const PrintFormat *fmt, void *void_entity, const Property& prop) ATTRIBUTE_NONNULL_;
 
 #endif  // SRC_OUTPUT_FORMATSTRING_PRINT_H_
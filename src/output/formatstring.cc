@@ -15,6 +15,7 @@
 #include <cstring>
 
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -26,6 +27,7 @@
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/outputsink.h"
 #include "eixTk/outputstring.h"
 #include "eixTk/regexp.h"
 #include "eixTk/stringtypes.h"
@@ -37,6 +39,7 @@
 class PortageSettings;
 class Darkmode;
 
+using std::map;
 using std::string;
 using std::vector;
 
@@ -126,6 +129,51 @@ Node *PrintFormat::parse_variable(const string& varname) const {
 	return rootnode;
 }
 
+Node *PrintFormat::parse_variable(VariableReference *ref) const {
+	VarParserCacheNode *v(ref->node);
+	if(unlikely(v == NULLPTR)) {
+		Node *rootnode(parse_variable(ref->name));
+		ref->node = &(varcache[ref->name]);
+		return rootnode;
+	}
+	if(unlikely(v->in_use)) {
+		cerr << eix::format(_("variable %s calls itself for printing")) % ref->name << endl;
+		exit(EXIT_FAILURE);
+	}
+	v->in_use = true;
+	return v->rootnode();
+}
+
+ColonArgument::ColonArgument(const string& arg) : whole(arg), value(NULLPTR) {
+	string::size_type col(arg.find(':'));
+	two_parts = (col != string::npos);
+	if(two_parts) {
+		first.name.assign(arg, 0, col);
+		second.name.assign(arg, col + 1, string::npos);
+	}
+}
+
+class CompiledUserVariable : public CompiledProperty {
+	public:
+		OutputString *value;
+
+		CompiledUserVariable(const PrintFormat *fmt, OutputString *v) : CompiledProperty(KIND_USER_VARIABLE, fmt), value(v) {
+		}
+};
+
+/**
+The entries of user_variables are never erased, so we can keep pointers
+**/
+OutputString *PrintFormat::get_user_variable(const Property& prop) const {
+	CompiledProperty *c(prop.get_compiled(CompiledProperty::KIND_USER_VARIABLE, this));
+	if(likely(c != NULLPTR)) {
+		return static_cast<CompiledUserVariable *>(c)->value;
+	}
+	OutputString *value(&(user_variables[prop.name]));
+	prop.set_compiled(new CompiledUserVariable(this, value));
+	return value;
+}
+
 void PrintFormat::overlay_keytext(OutputString *s, ExtendedVersion::Overlay overlay, bool plain) const {
 	ExtendedVersion::Overlay number(overlay);
 	if(number != 0) {
@@ -363,12 +411,12 @@ bool PrintFormat::recPrint(OutputString *result, void *entity, GetProperty get_p
 			case Node::OUTPUT: {
 					Property *p(static_cast<Property*>(root));
 					if(p->user_variable) {
-						if(printString(result, user_variables[p->name])) {
+						if(printString(result, *get_user_variable(*p))) {
 							printed = true;
 						}
 					} else {
 						OutputString s;
-						get_property(&s, this, entity, p->name);
+						get_property(&s, this, entity, *p);
 						if(printString(result, s)) {
 							printed = true;
 						}
@@ -383,11 +431,11 @@ bool PrintFormat::recPrint(OutputString *result, void *entity, GetProperty get_p
 					OutputString *rhs;
 					switch(ief->rhs) {
 						case ConditionBlock::RHS_VAR:
-							rhs = &(user_variables[ief->text.text.as_string()]);
+							rhs = get_user_variable(ief->rhs_variable);
 							break;
 						case ConditionBlock::RHS_PROPERTY:
 							rhs = &rhsvalue;
-							get_property(rhs, this, entity, ief->text.text.as_string());
+							get_property(rhs, this, entity, ief->rhs_variable);
 							break;
 						default:
 						// case ConditionBlock::RHS_STRING:
@@ -395,7 +443,7 @@ bool PrintFormat::recPrint(OutputString *result, void *entity, GetProperty get_p
 							break;
 					}
 					if(root->type == Node::SET) {
-						OutputString& r(user_variables[ief->variable.name]);
+						OutputString& r(*get_user_variable(ief->variable));
 						if(ief->negation) {
 							if(rhs->empty()) {
 								r.set_one();
@@ -410,10 +458,10 @@ bool PrintFormat::recPrint(OutputString *result, void *entity, GetProperty get_p
 					// Node::IF:
 					bool ok;
 					if(ief->user_variable) {
-						ok = rhs->is_equal(user_variables[ief->variable.name]);
+						ok = rhs->is_equal(*get_user_variable(ief->variable));
 					} else {
 						OutputString r;
-						get_property(&r, this, entity, ief->variable.name);
+						get_property(&r, this, entity, ief->variable);
 						ok = rhs->is_equal(r);
 					}
 					if(ief->negation) {
@@ -615,7 +663,7 @@ FormatParser::ParserState FormatParser::state_IF() {
 		last_error = _("'{' without closing '}'");
 		return ERROR;
 	}
-	n->variable = Property(string(name_start, i));
+	n->variable = Property(string(name_start, i), n->user_variable);
 
 	band_position = seek_character(band_position);
 	if(*band_position == '}') {
@@ -709,6 +757,9 @@ GCC_DIAG_ON(sign-conversion)
 		}
 	}
 	n->text = Text(textbuffer);
+	if(n->rhs != ConditionBlock::RHS_STRING) {
+		n->rhs_variable = Property(textbuffer.as_string(), n->rhs == ConditionBlock::RHS_VAR);
+	}
 
 	if(*band_position != '}') {
 		if(*band_position) {
@@ -838,6 +889,21 @@ bool FormatParser::start(const char *fmt, bool colors, bool parse_only_colors, s
 
 /* return true if something was actually printed */
 bool PrintFormat::print(void *entity, GetProperty get_property, Node *root, const DBHeader *dbheader, VarDbPkg *vardbpkg, const PortageSettings *ps, const SetStability *s, bool check_only) {
+	if(unlikely(check_only)) {
+		OutputString dummy;
+		return render(&dummy, entity, get_property, root, dbheader, vardbpkg, ps, s);
+	}
+	bool r(render(NULLPTR, entity, get_property, root, dbheader, vardbpkg, ps, s));
+	OutputSink::interactive_flush();
+	return r;
+}
+
+void PrintFormat::print_rendered(const OutputString& rendered) const {
+	printString(NULLPTR, rendered);
+	OutputSink::interactive_flush();
+}
+
+bool PrintFormat::render(OutputString *result, void *entity, GetProperty get_property, Node *root, const DBHeader *dbheader, VarDbPkg *vardbpkg, const PortageSettings *ps, const SetStability *s) {
 	// The four hackish variables
 	header = dbheader;
 	vardb = vardbpkg;
@@ -846,14 +912,12 @@ bool PrintFormat::print(void *entity, GetProperty get_property, Node *root, cons
 	version_variables = NULLPTR;
 
 	varcache.clear_use();
-	user_variables.clear();
-	bool r;
-	if(unlikely(check_only)) {
-		OutputString dummy;
-		r = recPrint(&dummy, entity, get_property, root);
-	} else {
-		r = recPrint(NULLPTR, entity, get_property, root);
+	// Do not erase the entries: Their addresses are stored in the nodes
+	for(map<string, OutputString>::iterator it(user_variables.begin());
+		likely(it != user_variables.end()); ++it) {
+		it->second.clear();
 	}
+	bool r(recPrint(result, entity, get_property, root));
 	// Reset the four hackish variables
 	header = NULLPTR;
 	vardb = NULLPTR;
@@ -19,6 +19,7 @@
 
 #include "database/header.h"
 #include "eixTk/assert.h"
+#include "eixTk/likely.h"
 #include "eixTk/null.h"
 #include "eixTk/outputstring.h"
 #include "portage/extendedversion.h"
@@ -67,18 +68,71 @@ class Text : public Node {
 		}
 };
 
+class PrintFormat;
+
+/**
+The resolved form of a property: it is computed when the property is
+printed first, so that later printing needs no lookups by name.
+**/
+class CompiledProperty {
+	public:
+		enum Kind { KIND_USER_VARIABLE, KIND_PACKAGE, KIND_DIFF } kind;
+
+		/**
+		The format whose data (e.g. variables) were used for resolving
+		**/
+		const PrintFormat *owner;
+
+		CompiledProperty(Kind k, const PrintFormat *fmt) : kind(k), owner(fmt) {
+		}
+
+		virtual ~CompiledProperty() {
+		}
+};
+
 class Property : public Node {
 	public:
 		std::string name;
 		bool user_variable;
+		mutable CompiledProperty *compiled;
+
+		Property() : Node(OUTPUT), user_variable(false), compiled(NULLPTR) {
+		}
+
+		explicit Property(const std::string& n) : Node(OUTPUT), name(n), user_variable(false), compiled(NULLPTR) {
+		}
+
+		Property(const std::string& n, bool user_var) : Node(OUTPUT), name(n), user_variable(user_var), compiled(NULLPTR) {
+		}
+
+		Property(const Property& p) : Node(OUTPUT), name(p.name), user_variable(p.user_variable), compiled(NULLPTR) {
+		}
+
+		Property& operator=(const Property& p) {
+			name = p.name;
+			user_variable = p.user_variable;
+			delete compiled;
+			compiled = NULLPTR;
+			return *this;
+		}
 
-		Property() : Node(OUTPUT), user_variable(false) {
+		~Property() {
+			delete compiled;
 		}
 
-		explicit Property(const std::string& n) : Node(OUTPUT), name(n), user_variable(false) {
+		/**
+		@return the resolution if it is of kind k and was made by fmt
+		**/
+		CompiledProperty *get_compiled(CompiledProperty::Kind k, const PrintFormat *fmt) const {
+			if(likely((compiled != NULLPTR) && (compiled->kind == k) && (compiled->owner == fmt))) {
+				return compiled;
+			}
+			return NULLPTR;
 		}
 
-		Property(const std::string& n, bool user_var) : Node(OUTPUT), name(n), user_variable(user_var) {
+		void set_compiled(CompiledProperty *c) const {
+			delete compiled;
+			compiled = c;
 		}
 };
 
@@ -89,6 +143,10 @@ class ConditionBlock : public Node {
 		Property variable;
 		Text     text;
 		enum Rhs { RHS_STRING, RHS_PROPERTY, RHS_VAR } rhs;
+		/**
+		The name of text if rhs is RHS_PROPERTY or RHS_VAR
+		**/
+		Property rhs_variable;
 		Node     *if_true, *if_false;
 		bool user_variable, negation;
 
@@ -178,16 +236,58 @@ class VarParserCache : public VarParserCacheMap {
 		void clear_use();
 };
 
+/**
+A variable name together with its entry in VarParserCache.
+The entry is looked up (and parsed) only when it is first needed.
+**/
+class VariableReference {
+	public:
+		std::string name;
+		VarParserCacheNode *node;
+
+		VariableReference() : node(NULLPTR) {
+		}
+
+		explicit VariableReference(const std::string& n) : name(n), node(NULLPTR) {
+		}
+
+		void release() {
+			node->in_use = false;
+		}
+};
+
+/**
+The argument after the colon of a property like <date:FORMAT>,
+split into the possibly needed variables
+**/
+class ColonArgument {
+	public:
+		VariableReference whole;
+		/**
+		The parts before and after a second colon, if two_parts is true
+		**/
+		bool two_parts;
+		VariableReference first, second;
+		/**
+		The eixrc value of whole.name (resolved on first use)
+		**/
+		const std::string *value;
+
+		explicit ColonArgument(const std::string& arg);
+};
+
+class CompiledPackageProperty;
+
 class VersionVariables;
 
 class PrintFormat {
 	friend class LocalCopy;
 	friend class Scanner;
-	friend void get_package_property(OutputString *s, const PrintFormat *fmt, void *entity, const std::string& name) ATTRIBUTE_NONNULL_;
-	friend void get_diff_package_property(OutputString *s, const PrintFormat *fmt, void *void_entity, const std::string& name) ATTRIBUTE_NONNULL_;
+	friend void get_package_property(OutputString *s, const PrintFormat *fmt, void *entity, const Property& prop) ATTRIBUTE_NONNULL_;
+	friend void get_diff_package_property(OutputString *s, const PrintFormat *fmt, void *void_entity, const Property& prop) ATTRIBUTE_NONNULL_;
 
 	public:
-		typedef void (*GetProperty)(OutputString *s, const PrintFormat *fmt, void *entity, const std::string& property) ATTRIBUTE_NONNULL_;
+		typedef void (*GetProperty)(OutputString *s, const PrintFormat *fmt, void *entity, const Property& property) ATTRIBUTE_NONNULL_;
 		typedef std::vector<ExtendedVersion::Overlay> OverlayTranslations;
 		typedef std::vector<bool> OverlayUsed;
 
@@ -232,31 +332,39 @@ class PrintFormat {
 		bool parse_variable(Node **rootnode, const std::string& varname, std::string *errtext) const ATTRIBUTE_NONNULL((2));
 		Node *parse_variable(const std::string& varname) const;
 
+		/**
+		Like parse_variable, but looks up the variable only on first use.
+		The caller must call ref->release() when finished.
+		**/
+		Node *parse_variable(VariableReference *ref) const ATTRIBUTE_NONNULL_;
+
+		OutputString *get_user_variable(const Property& prop) const;
+
 		void iuse_expand(OutputString *s, const IUseSet& iuse, bool coll, HandleExpand expand) const;
 		void get_inst_use(OutputString *s, const Package& package, InstVersion *i, HandleExpand expand) const ATTRIBUTE_NONNULL_;
 		void get_installed(Package *package, Node *root) const ATTRIBUTE_NONNULL((2));
 		void get_versions_versorted(Package *package, Node *root, PrintFormat::VerVec *versions) const ATTRIBUTE_NONNULL((2));
 		void get_versions_slotsorted(Package *package, Node *root, PrintFormat::VerVec *versions) const ATTRIBUTE_NONNULL((2));
-		void get_pkg_property(OutputString *s, Package *package, const std::string& name) const ATTRIBUTE_NONNULL_;
+		void get_pkg_property(OutputString *s, Package *package, CompiledPackageProperty *prop) const ATTRIBUTE_NONNULL_;
 
 		// It follows a list of indirect functions called in get_pkg_property():
 		// Functions with capital letters are parser destinations; other functions
 		// here are sort of "macros" used by several other "capital letter" functions.
 
-		void COLON_VER_DATE(OutputString *s, Package *package, const std::string& after_colon) const ATTRIBUTE_NONNULL_;
-		void colon_pkg_availableversions(Package *package, const std::string& after_colon, bool only_marked) const ATTRIBUTE_NONNULL_;
-		void COLON_PKG_AVAILABLEVERSIONS(Package *package, const std::string& after_colon) const ATTRIBUTE_NONNULL_;
-		void COLON_PKG_MARKEDVERSIONS(Package *package, const std::string& after_colon) const ATTRIBUTE_NONNULL_;
-		void colon_pkg_bestversion(Package *package, const std::string& after_colon, bool allow_unstable) const ATTRIBUTE_NONNULL_;
-		void COLON_PKG_BESTVERSION(Package *package, const std::string& after_colon) const ATTRIBUTE_NONNULL_;
-		void COLON_PKG_BESTVERSIONS(Package *package, const std::string& after_colon) const ATTRIBUTE_NONNULL_;
-		void colon_pkg_bestslotversions(Package *package, const std::string& after_colon, bool allow_unstable) const ATTRIBUTE_NONNULL_;
-		void COLON_PKG_BESTSLOTVERSIONS(Package *package, const std::string& after_colon) const ATTRIBUTE_NONNULL_;
-		void COLON_PKG_BESTSLOTVERSIONSS(Package *package, const std::string& after_colon) const ATTRIBUTE_NONNULL_;
-		void colon_pkg_bestslotupgradeversions(Package *package, const std::string& after_colon, bool allow_unstable) const ATTRIBUTE_NONNULL_;
-		void COLON_PKG_BESTSLOTUPGRADEVERSIONS(Package *package, const std::string& after_colon) const ATTRIBUTE_NONNULL_;
-		void COLON_PKG_BESTSLOTUPGRADEVERSIONSS(Package *package, const std::string& after_colon) const ATTRIBUTE_NONNULL_;
-		void COLON_PKG_INSTALLEDVERSIONS(Package *package, const std::string& after_colon) const ATTRIBUTE_NONNULL_;
+		void COLON_VER_DATE(OutputString *s, Package *package, ColonArgument *arg) const ATTRIBUTE_NONNULL_;
+		void colon_pkg_availableversions(Package *package, ColonArgument *arg, bool only_marked) const ATTRIBUTE_NONNULL_;
+		void COLON_PKG_AVAILABLEVERSIONS(Package *package, ColonArgument *arg) const ATTRIBUTE_NONNULL_;
+		void COLON_PKG_MARKEDVERSIONS(Package *package, ColonArgument *arg) const ATTRIBUTE_NONNULL_;
+		void colon_pkg_bestversion(Package *package, ColonArgument *arg, bool allow_unstable) const ATTRIBUTE_NONNULL_;
+		void COLON_PKG_BESTVERSION(Package *package, ColonArgument *arg) const ATTRIBUTE_NONNULL_;
+		void COLON_PKG_BESTVERSIONS(Package *package, ColonArgument *arg) const ATTRIBUTE_NONNULL_;
+		void colon_pkg_bestslotversions(Package *package, ColonArgument *arg, bool allow_unstable) const ATTRIBUTE_NONNULL_;
+		void COLON_PKG_BESTSLOTVERSIONS(Package *package, ColonArgument *arg) const ATTRIBUTE_NONNULL_;
+		void COLON_PKG_BESTSLOTVERSIONSS(Package *package, ColonArgument *arg) const ATTRIBUTE_NONNULL_;
+		void colon_pkg_bestslotupgradeversions(Package *package, ColonArgument *arg, bool allow_unstable) const ATTRIBUTE_NONNULL_;
+		void COLON_PKG_BESTSLOTUPGRADEVERSIONS(Package *package, ColonArgument *arg) const ATTRIBUTE_NONNULL_;
+		void COLON_PKG_BESTSLOTUPGRADEVERSIONSS(Package *package, ColonArgument *arg) const ATTRIBUTE_NONNULL_;
+		void COLON_PKG_INSTALLEDVERSIONS(Package *package, ColonArgument *arg) const ATTRIBUTE_NONNULL_;
 		void PKG_INSTALLED(OutputString *s, Package *package) const ATTRIBUTE_NONNULL_;
 		void PKG_VERSIONLINES(OutputString *s, Package *package) const ATTRIBUTE_NONNULL_;
 		void PKG_SLOTSORTED(OutputString *s, Package *package) const ATTRIBUTE_NONNULL_;
@@ -480,6 +588,21 @@ class PrintFormat {
 			overlay_keytext(s, overlay, false);
 		}
 
+		/**
+		Append the output for entity to result (or print it if result is NULLPTR)
+		@return true if something was actually output
+		**/
+		bool render(OutputString *result, void *entity, GetProperty get_property, Node *root, const DBHeader *dbheader, VarDbPkg *vardbpkg, const PortageSettings *ps, const SetStability *s) ATTRIBUTE_NONNULL((3, 6, 7, 8, 9));
+
+		bool render(OutputString *result, void *entity, const DBHeader *dbheader, VarDbPkg *vardbpkg, const PortageSettings *ps, const SetStability *s) ATTRIBUTE_NONNULL((3, 4, 5, 6, 7)) {
+			return render(result, entity, m_get_property, root_node, dbheader, vardbpkg, ps, s);
+		}
+
+		/**
+		Print the result of render()
+		**/
+		void print_rendered(const OutputString& rendered) const;
+
 		/* return true if something was actually printed */
 		bool print(void *entity, GetProperty get_property, Node *root, const DBHeader *dbheader, VarDbPkg *vardbpkg, const PortageSettings *ps, const SetStability *s, bool check_only) ATTRIBUTE_NONNULL((2, 5, 6, 7, 8));
 
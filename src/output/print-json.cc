@@ -0,0 +1,243 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <iostream>
+#include <string>
+
+#include "database/header.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/outputsink.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/sysutils.h"
+#include "output/formatstring.h"
+#include "output/print-json.h"
+#include "portage/depend.h"
+#include "portage/extendedversion.h"
+#include "portage/instversion.h"
+#include "portage/overlay.h"
+#include "portage/package.h"
+#include "portage/vardbpkg.h"
+#include "portage/version.h"
+
+using std::string;
+
+using std::cout;
+
+static void append_key(string *out, const char *key) ATTRIBUTE_NONNULL_;
+static void print_key(string *out, const char *key, const string& value) ATTRIBUTE_NONNULL_;
+static void print_key(string *out, const char *key, const WordVec& value) ATTRIBUTE_NONNULL_;
+
+static void append_key(string *out, const char *key) {
+	out->append(",\"");
+	out->append(key);
+	out->append("\":");
+}
+
+static void print_key(string *out, const char *key, const string& value) {
+	append_key(out, key);
+	PrintJson::print_string(out, value);
+}
+
+static void print_key(string *out, const char *key, const WordVec& value) {
+	append_key(out, key);
+	PrintJson::print_list(out, value);
+}
+
+void PrintJson::print_string(string *out, const string& s) {
+	static const char hex[] = "0123456789abcdef";
+	out->append(1, '"');
+	const char *begin(s.data());
+	const char *end(begin + s.size());
+	for(const char *curr(begin); likely(curr != end); ++curr) {
+		const char *replace;
+		char ctrl[7];
+		switch(*curr) {
+			case '"': replace = "\\\""; break;
+			case '\\': replace = "\\\\"; break;
+			case '\n': replace = "\\n"; break;
+			case '\t': replace = "\\t"; break;
+			case '\r': replace = "\\r"; break;
+			default:
+				if(likely(static_cast<unsigned char>(*curr) >= 0x20)) {
+					continue;
+				}
+				ctrl[0] = '\\';
+				ctrl[1] = 'u';
+				ctrl[2] = ctrl[3] = '0';
+				ctrl[4] = hex[(*curr >> 4) & 0x0F];
+				ctrl[5] = hex[*curr & 0x0F];
+				ctrl[6] = '\0';
+				replace = ctrl;
+				break;
+		}
+		out->append(begin, curr - begin);
+		out->append(replace);
+		begin = curr + 1;
+	}
+	out->append(begin, end - begin);
+	out->append(1, '"');
+}
+
+void PrintJson::print_list(string *out, const WordVec& list) {
+	out->append(1, '[');
+	for(WordVec::const_iterator it(list.begin()); likely(it != list.end()); ++it) {
+		if(it != list.begin()) {
+			out->append(1, ',');
+		}
+		print_string(out, *it);
+	}
+	out->append(1, ']');
+}
+
+void PrintJson::package(Package *pkg) {
+	record.clear();
+	record.append("{\"category\":");
+	print_string(&record, pkg->category);
+	print_key(&record, "name", pkg->name);
+	print_key(&record, "description", pkg->desc);
+	print_key(&record, "homepage", pkg->homepage);
+	print_key(&record, "licenses", pkg->licenses);
+	record.append(",\"versions\":[");
+
+	InstalledVersions have_inst;
+	installed_versions(&have_inst, pkg);
+
+	for(Package::const_iterator ver(pkg->begin()); likely(ver != pkg->end()); ++ver) {
+		bool versionInstalled(false);
+		InstVersion *installedVersion(NULLPTR);
+		if(have_inst.find(*ver) != have_inst.end()) {
+			if(var_db_pkg->isInstalled(*pkg, *ver, &installedVersion)) {
+				versionInstalled = true;
+				var_db_pkg->readInstDate(*pkg, installedVersion);
+				var_db_pkg->readEapi(*pkg, installedVersion);
+			}
+		}
+
+		if(ver != pkg->begin()) {
+			record.append(1, ',');
+		}
+		record.append("{\"id\":");
+		print_string(&record, ver->getFull());
+		print_key(&record, "EAPI", ver->eapi.get());
+		ExtendedVersion::Overlay overlay_key(ver->overlay_key);
+		if(unlikely(overlay_key != 0)) {
+			if(print_format->is_virtual(overlay_key)) {
+				record.append(",\"virtual\":true");
+			}
+			const OverlayIdent& overlay(hdr->getOverlay(overlay_key));
+			if((print_overlay || overlay.label.empty()) && !(overlay.path.empty())) {
+				print_key(&record, "overlay", overlay.path);
+			}
+			if(!overlay.label.empty()) {
+				print_key(&record, "repository", overlay.label);
+			}
+		}
+		if(!ver->get_shortfullslot().empty()) {
+			print_key(&record, "slot", ver->get_longfullslot());
+		}
+		if(versionInstalled) {
+			record.append(",\"installed\":true");
+			print_key(&record, "installDate", date_conv(dateformat.c_str(), installedVersion->instDate));
+			print_key(&record, "installEAPI", installedVersion->eapi.get());
+		}
+
+		WordVec mask_text, unmask_text;
+		mask_texts(&mask_text, &unmask_text, *ver, pkg);
+		print_key(&record, "mask", mask_text);
+
+		WordVec reasons;
+		if(unlikely(ver->have_reasons())) {
+			const Version::Reasons *reasons_ptr(ver->reasons_ptr());
+			for(Version::Reasons::const_iterator it(reasons_ptr->begin());
+				unlikely(it != reasons_ptr->end()); ++it) {
+				const WordVec *vec(it->asWordVecPtr());
+				if((vec == NULLPTR) || (vec->empty())) {
+					continue;
+				}
+				reasons.push_back(join_to_string(*vec, "\n"));
+			}
+		}
+		print_key(&record, "maskreasons", reasons);
+		print_key(&record, "unmask", unmask_text);
+
+		append_key(&record, "iuse");
+		record.append(1, '[');
+		const IUseSet::IUseStd& s(ver->iuse.asStd());
+		for(IUseSet::IUseStd::const_iterator it(s.begin()); likely(it != s.end()); ++it) {
+			if(it != s.begin()) {
+				record.append(1, ',');
+			}
+			// USE flag names need no escaping
+			record.append(1, '"');
+			const char *prefix(it->prefix());
+			if(prefix != NULLPTR) {
+				record.append(prefix);
+			}
+			record.append(it->name());
+			record.append(1, '"');
+		}
+		record.append(1, ']');
+		if(Version::use_required_use && !(ver->required_use.empty())) {
+			print_key(&record, "required_use", ver->required_use);
+		}
+		if(versionInstalled) {
+			var_db_pkg->readUse(*pkg, installedVersion);
+			WordVec use_enabled, use_disabled;
+			const WordSet& usedUse(installedVersion->usedUse);
+			for(WordVec::const_iterator iu(installedVersion->inst_iuse.begin());
+				likely(iu != installedVersion->inst_iuse.end()); ++iu) {
+				if(usedUse.find(*iu) == usedUse.end()) {
+					use_disabled.push_back(*iu);
+				} else {
+					use_enabled.push_back(*iu);
+				}
+			}
+			print_key(&record, "use_enabled", use_enabled);
+			print_key(&record, "use_disabled", use_disabled);
+		}
+
+		WordVec restrict_text, properties_text;
+		flag_texts(&restrict_text, &properties_text, *ver);
+		print_key(&record, "restrict", restrict_text);
+		print_key(&record, "properties", properties_text);
+
+		// Unlike --xml, the keywords are part of every record
+		string full_kw(ver->get_full_keywords());
+		print_key(&record, "keywords", full_kw);
+		string eff_kw(ver->get_effective_keywords());
+		if(eff_kw != full_kw) {
+			print_key(&record, "effective_keywords", eff_kw);
+		}
+
+		if(Depend::use_depend) {
+			string dep(ver->depend.get_depend());
+			if(!dep.empty()) {
+				print_key(&record, "depend", dep);
+			}
+			dep = ver->depend.get_rdepend();
+			if(!dep.empty()) {
+				print_key(&record, "rdepend", dep);
+			}
+			dep = ver->depend.get_pdepend();
+			if(!dep.empty()) {
+				print_key(&record, "pdepend", dep);
+			}
+			dep = ver->depend.get_hdepend();
+			if(!dep.empty()) {
+				print_key(&record, "hdepend", dep);
+			}
+		}
+		record.append(1, '}');
+	}
+	record.append("]}\n");
+	cout.write(record.data(), record.size());
+	++count;
+	OutputSink::stream_flush();
+}
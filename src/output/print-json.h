@@ -0,0 +1,56 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_OUTPUT_PRINT_JSON_H_
+#define SRC_OUTPUT_PRINT_JSON_H_ 1
+
+#include <string>
+
+#include "eixTk/stringtypes.h"
+#include "output/print-xml.h"
+
+class DBHeader;
+class EixRc;
+class Package;
+class PrintFormat;
+class SetStability;
+class VarDbPkg;
+
+/**
+Output of packages as newline-delimited JSON: Each package is printed as
+one JSON object on a separate line, so the output can be processed while
+it is still produced. The data are the same as with --xml, and the
+variables XML_KEYWORDS, XML_OVERLAY, and XML_DATE are honoured.
+**/
+class PrintJson : public PrintXml {
+	public:
+		PrintJson(const DBHeader *header, VarDbPkg *vardb, const PrintFormat *printformat, const SetStability *set_stability, EixRc *eixrc, const std::string& port_dir) ATTRIBUTE_NONNULL_ : PrintXml(header, vardb, printformat, set_stability, eixrc, port_dir) {
+		}
+
+		void start() {
+		}
+
+		void package(Package *pkg) ATTRIBUTE_NONNULL_;
+
+		void finish() {
+		}
+
+		/**
+		Append s as a JSON string to out, escaping it while copying
+		**/
+		static void print_string(std::string *out, const std::string& s) ATTRIBUTE_NONNULL_;
+
+		static void print_list(std::string *out, const WordVec& list) ATTRIBUTE_NONNULL_;
+
+	private:
+		/**
+		The package is collected and then written in one piece
+		**/
+		std::string record;
+};
+
+#endif  // SRC_OUTPUT_PRINT_JSON_H_
@@ -0,0 +1,143 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <string>
+
+#include "eixTk/eixint.h"
+#include "eixTk/likely.h"
+#include "eixTk/outputstring.h"
+#include "eixTk/workers.h"
+#include "output/formatstring.h"
+#include "output/print-parallel.h"
+#include "portage/package.h"
+#include "portage/set_stability.h"
+
+using std::string;
+
+/**
+Number of packages rendered by a worker in one piece
+**/
+#define CHUNK_SIZE 32
+
+void ParallelPrint::render_chunk(string *msg, const Packages& packages, Chunk begin, Chunk end) {
+	for(Chunk i(begin); likely(i != end); ++i) {
+		Package *package(packages[i]);
+		stability->set_stability(package);
+		OutputString rendered;
+		if(format->render(&rendered, package, header, vardb, portagesettings, stability)) {
+			msg->append(1, '1');
+			rendered.pack(msg);
+		} else {
+			msg->append(1, '0');
+		}
+	}
+	// The overlays used for printing are needed for the overlay table
+	msg->append(1, (*some_overlay_used ? '1' : '0'));
+	for(PrintFormat::OverlayUsed::const_iterator it(overlay_used->begin());
+		likely(it != overlay_used->end()); ++it) {
+		msg->append(1, (*it ? '1' : '0'));
+	}
+}
+
+bool ParallelPrint::print_chunk(const string& msg, eix::Treesize *count) {
+	const char *pos(msg.data());
+	const char *end(pos + msg.size());
+	string::size_type trailer(overlay_used->size() + 1);
+	OutputString rendered;
+	while(static_cast<string::size_type>(end - pos) > trailer) {
+		if(*(pos++) == '0') {
+			continue;
+		}
+		if(unlikely(!rendered.unpack(&pos, end))) {
+			return false;
+		}
+		format->print_rendered(rendered);
+		++(*count);
+	}
+	if(unlikely(static_cast<string::size_type>(end - pos) != trailer)) {
+		return false;
+	}
+	if(*(pos++) == '1') {
+		*some_overlay_used = true;
+	}
+	for(PrintFormat::OverlayUsed::iterator it(overlay_used->begin());
+		likely(it != overlay_used->end()); ++it) {
+		if(*(pos++) == '1') {
+			*it = true;
+		}
+	}
+	return true;
+}
+
+void ParallelPrint::print_directly(string *msg, const Packages& packages, Chunk chunk, eix::Treesize *count) {
+	Chunk begin(chunk * CHUNK_SIZE);
+	Chunk end(begin + CHUNK_SIZE);
+	if(end > packages.size()) {
+		end = packages.size();
+	}
+	msg->clear();
+	render_chunk(msg, packages, begin, end);
+	print_chunk(*msg, count);
+}
+
+bool ParallelPrint::run_worker(int fd, Index i) {
+	const Packages& packages(*packages_ptr);
+	Chunk size(packages.size());
+	Chunk step(jobs());
+	string msg;
+	for(Chunk chunk(first_chunk + i); chunk * CHUNK_SIZE < size; chunk += step) {
+		Chunk begin(chunk * CHUNK_SIZE);
+		Chunk end(begin + CHUNK_SIZE);
+		if(end > size) {
+			end = size;
+		}
+		init_message(&msg);
+		render_chunk(&msg, packages, begin, end);
+		if(unlikely(!send_message(fd, &msg))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ParallelPrint::print(const Packages& packages, unsigned int max_jobs, eix::Treesize *count) {
+	Chunk size(packages.size());
+	Chunk chunks((size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+	string msg;
+	Chunk next(0);
+	// The first chunk is printed directly: Errors in the format are thus
+	// reported only once, and the workers inherit the lazily read data.
+	for(; (next != chunks) && ((next == 0) || (max_jobs <= 1)); ++next) {
+		print_directly(&msg, packages, next, count);
+	}
+	if(next == chunks) {
+		return true;
+	}
+	Chunk step(chunks - next);
+	if(step > max_jobs) {
+		step = max_jobs;
+	}
+	packages_ptr = &packages;
+	first_chunk = next;
+	if(unlikely(!start(step))) {
+		// Not all workers could be started: print sequentially
+		for(; next != chunks; ++next) {
+			print_directly(&msg, packages, next, count);
+		}
+		return true;
+	}
+	for(Chunk chunk(next); likely(chunk != chunks); ++chunk) {
+		if(unlikely(!read_message((chunk - next) % step, &msg) ||
+			!print_chunk(msg, count))) {
+			stop();
+			return false;
+		}
+	}
+	return finish();
+}
@@ -0,0 +1,78 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_OUTPUT_PRINT_PARALLEL_H_
+#define SRC_OUTPUT_PRINT_PARALLEL_H_ 1
+
+#include <string>
+#include <vector>
+
+#include "eixTk/eixint.h"
+#include "eixTk/null.h"
+#include "eixTk/workers.h"
+#include "output/formatstring.h"
+
+class DBHeader;
+class Package;
+class PortageSettings;
+class SetStability;
+class VarDbPkg;
+
+/**
+Render packages with a PrintFormat in forked worker processes and print
+the results strictly in the original order.
+Each worker has its own copy of the (mutable) state of the PrintFormat,
+so the output is the same as when printing sequentially.
+**/
+class ParallelPrint : public ForkWorkers {
+	public:
+		typedef std::vector<Package *> Packages;
+
+		ParallelPrint(PrintFormat *fmt, const DBHeader *dbheader, VarDbPkg *vardbpkg, const PortageSettings *ps, const SetStability *s, PrintFormat::OverlayUsed *used, bool *some_used) :
+			packages_ptr(NULLPTR), first_chunk(0), format(fmt), header(dbheader), vardb(vardbpkg), portagesettings(ps), stability(s), overlay_used(used), some_overlay_used(some_used) {
+		}
+
+		/**
+		Print all packages, counting in *count those with nonempty output
+		@return false if a worker failed
+		**/
+		bool print(const Packages& packages, unsigned int max_jobs, eix::Treesize *count) ATTRIBUTE_NONNULL_;
+
+	private:
+		typedef Packages::size_type Chunk;
+
+		const Packages *packages_ptr;
+		Chunk first_chunk;
+		PrintFormat *format;
+		const DBHeader *header;
+		VarDbPkg *vardb;
+		const PortageSettings *portagesettings;
+		const SetStability *stability;
+		PrintFormat::OverlayUsed *overlay_used;
+		bool *some_overlay_used;
+
+		/**
+		Render the packages with index in [begin, end) into msg
+		**/
+		void render_chunk(std::string *msg, const Packages& packages, Chunk begin, Chunk end) ATTRIBUTE_NONNULL_;
+
+		/**
+		Print the data of msg as created by render_chunk
+		@return false if msg is corrupt
+		**/
+		bool print_chunk(const std::string& msg, eix::Treesize *count) ATTRIBUTE_NONNULL_;
+
+		/**
+		Render and print the packages of chunk in this process
+		**/
+		void print_directly(std::string *msg, const Packages& packages, Chunk chunk, eix::Treesize *count) ATTRIBUTE_NONNULL((2, 5));
+
+	protected:
+		bool run_worker(int fd, Index i);
+};
+
+#endif  // SRC_OUTPUT_PRINT_PARALLEL_H_
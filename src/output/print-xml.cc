@@ -15,6 +15,7 @@
 #include "database/header.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/outputsink.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/sysutils.h"
 #include "eixrc/eixrc.h"
@@ -121,23 +122,7 @@ static void print_iuse(const IUseSet::IUseStd& s, IUse::Flags wanted, const char
 	}
 }
 
-void PrintXml::package(Package *pkg) {
-	if(unlikely(!started))
-		start();
-	if(unlikely(curcat != pkg->category)) {
-		if(!curcat.empty()) {
-			cout << "\t</category>\n";
-		}
-		curcat = pkg->category;
-		cout << "\t<category name=\"" << escape_xmlstring(curcat) << "\">\n";
-	}
-	// category, name, desc, homepage, licenses;
-	cout << "\t\t<package name=\"" << escape_xmlstring(pkg->name) << "\">\n"
-		"\t\t\t<description>" << escape_xmlstring(pkg->desc) << "</description>\n"
-		"\t\t\t<homepage>" << escape_xmlstring(pkg->homepage) << "</homepage>\n"
-		"\t\t\t<licenses>" << escape_xmlstring(pkg->licenses) << "</licenses>\n";
-
-	set<const Version*> have_inst;
+void PrintXml::installed_versions(InstalledVersions *have_inst, Package *pkg) const {
 	if((likely(var_db_pkg != NULLPTR)) && var_db_pkg->isInstalled(*pkg)) {
 		set<BasicVersion> know_inst;
 		// First we check which versions are installed with correct overlays.
@@ -147,7 +132,7 @@ void PrintXml::package(Package *pkg) {
 				likely(ver != pkg->end()); ++ver) {
 				if(var_db_pkg->isInstalledVersion(*pkg, *ver, *hdr) > 0) {
 					know_inst.insert(**ver);
-					have_inst.insert(*ver);
+					have_inst->insert(*ver);
 				}
 			}
 		}
@@ -159,10 +144,146 @@ void PrintXml::package(Package *pkg) {
 			likely(ver != pkg->rend()); ++ver) {
 			if(know_inst.find(**ver) == know_inst.end()) {
 				know_inst.insert(**ver);
-				have_inst.insert(*ver);
+				have_inst->insert(*ver);
 			}
 		}
 	}
+}
+
+void PrintXml::mask_texts(WordVec *mask_text, WordVec *unmask_text, const Version *ver, Package *pkg) const {
+	MaskFlags currmask(ver->maskflags);
+	KeywordsFlags currkey(ver->keyflags);
+	MaskFlags wasmask;
+	KeywordsFlags waskey;
+	stability->calc_version_flags(false, &wasmask, &waskey, ver, pkg);
+
+	if(wasmask.isHardMasked()) {
+		if(currmask.isProfileMask()) {
+			mask_text->push_back("profile");
+		} else if(currmask.isPackageMask()) {
+			mask_text->push_back("hard");
+		} else if(wasmask.isProfileMask()) {
+			mask_text->push_back("profile");
+			unmask_text->push_back("package_unmask");
+		} else {
+			mask_text->push_back("hard");
+			unmask_text->push_back("package_unmask");
+		}
+	} else if(currmask.isHardMasked()) {
+		mask_text->push_back("package_mask");
+	}
+
+	if(currkey.isStable()) {
+		if(waskey.isStable()) {
+			//
+		} else if(waskey.isUnstable()) {
+			mask_text->push_back("keyword");
+			unmask_text->push_back("package_keywords");
+		} else if(waskey.isMinusKeyword()) {
+			mask_text->push_back("minus_keyword");
+			unmask_text->push_back("package_keywords");
+		} else if(waskey.isAlienStable()) {
+			mask_text->push_back("alien_stable");
+			unmask_text->push_back("package_keywords");
+		} else if(waskey.isAlienUnstable()) {
+			mask_text->push_back("alien_unstable");
+			unmask_text->push_back("package_keywords");
+		} else if(waskey.isMinusUnstable()) {
+			mask_text->push_back("minus_unstable");
+			unmask_text->push_back("package_keywords");
+		} else if(waskey.isMinusAsterisk()) {
+			mask_text->push_back("minus_asterisk");
+			unmask_text->push_back("package_keywords");
+		} else {
+			mask_text->push_back("missing_keyword");
+			unmask_text->push_back("package_keywords");
+		}
+	} else if(currkey.isUnstable()) {
+		mask_text->push_back("keyword");
+	} else if(currkey.isMinusKeyword()) {
+		mask_text->push_back("minus_keyword");
+	} else if(currkey.isAlienStable()) {
+		mask_text->push_back("alien_stable");
+	} else if(currkey.isAlienUnstable()) {
+		mask_text->push_back("alien_unstable");
+	} else if(currkey.isMinusUnstable()) {
+		mask_text->push_back("minus_unstable");
+	} else if(currkey.isMinusAsterisk()) {
+		mask_text->push_back("minus_asterisk");
+	} else {
+		mask_text->push_back("missing_keyword");
+	}
+}
+
+void PrintXml::flag_texts(WordVec *restrict_text, WordVec *properties_text, const ExtendedVersion *ver) {
+	ExtendedVersion::Restrict restrict(ver->restrictFlags);
+	if(unlikely(restrict != ExtendedVersion::RESTRICT_NONE)) {
+		if(unlikely(restrict & ExtendedVersion::RESTRICT_BINCHECKS)) {
+			restrict_text->push_back("binchecks");
+		}
+		if(unlikely(restrict & ExtendedVersion::RESTRICT_STRIP)) {
+			restrict_text->push_back("strip");
+		}
+		if(unlikely(restrict & ExtendedVersion::RESTRICT_TEST)) {
+			restrict_text->push_back("test");
+		}
+		if(unlikely(restrict & ExtendedVersion::RESTRICT_USERPRIV)) {
+			restrict_text->push_back("userpriv");
+		}
+		if(unlikely(restrict & ExtendedVersion::RESTRICT_INSTALLSOURCES)) {
+			restrict_text->push_back("installsources");
+		}
+		if(unlikely(restrict & ExtendedVersion::RESTRICT_FETCH)) {
+			restrict_text->push_back("fetch");
+		}
+		if(unlikely(restrict & ExtendedVersion::RESTRICT_MIRROR)) {
+			restrict_text->push_back("mirror");
+		}
+		if(unlikely(restrict & ExtendedVersion::RESTRICT_PRIMARYURI)) {
+			restrict_text->push_back("primaryuri");
+		}
+		if(unlikely(restrict & ExtendedVersion::RESTRICT_BINDIST)) {
+			restrict_text->push_back("bindist");
+		}
+		if(unlikely(restrict & ExtendedVersion::RESTRICT_PARALLEL)) {
+			restrict_text->push_back("parallel");
+		}
+	}
+	ExtendedVersion::Restrict properties(ver->propertiesFlags);
+	if(unlikely(properties != ExtendedVersion::PROPERTIES_NONE)) {
+		if(unlikely(properties & ExtendedVersion::PROPERTIES_INTERACTIVE)) {
+			properties_text->push_back("interactive");
+		}
+		if(unlikely(properties & ExtendedVersion::PROPERTIES_LIVE)) {
+			properties_text->push_back("live");
+		}
+		if(unlikely(properties & ExtendedVersion::PROPERTIES_VIRTUAL)) {
+			properties_text->push_back("virtual");
+		}
+		if(unlikely(properties & ExtendedVersion::PROPERTIES_SET)) {
+			properties_text->push_back("set");
+		}
+	}
+}
+
+void PrintXml::package(Package *pkg) {
+	if(unlikely(!started))
+		start();
+	if(unlikely(curcat != pkg->category)) {
+		if(!curcat.empty()) {
+			cout << "\t</category>\n";
+		}
+		curcat = pkg->category;
+		cout << "\t<category name=\"" << escape_xmlstring(curcat) << "\">\n";
+	}
+	// category, name, desc, homepage, licenses;
+	cout << "\t\t<package name=\"" << escape_xmlstring(pkg->name) << "\">\n"
+		"\t\t\t<description>" << escape_xmlstring(pkg->desc) << "</description>\n"
+		"\t\t\t<homepage>" << escape_xmlstring(pkg->homepage) << "</homepage>\n"
+		"\t\t\t<licenses>" << escape_xmlstring(pkg->licenses) << "</licenses>\n";
+
+	InstalledVersions have_inst;
+	installed_versions(&have_inst, pkg);
 
 	for(Package::const_iterator ver(pkg->begin()); likely(ver != pkg->end()); ++ver) {
 		bool versionInstalled(false);
@@ -200,69 +321,8 @@ void PrintXml::package(Package *pkg) {
 		}
 		cout << ">\n";
 
-		MaskFlags currmask(ver->maskflags);
-		KeywordsFlags currkey(ver->keyflags);
-		MaskFlags wasmask;
-		KeywordsFlags waskey;
-		stability->calc_version_flags(false, &wasmask, &waskey, *ver, pkg);
-
 		WordVec mask_text, unmask_text;
-		if(wasmask.isHardMasked()) {
-			if(currmask.isProfileMask()) {
-				mask_text.push_back("profile");
-			} else if(currmask.isPackageMask()) {
-				mask_text.push_back("hard");
-			} else if(wasmask.isProfileMask()) {
-				mask_text.push_back("profile");
-				unmask_text.push_back("package_unmask");
-			} else {
-				mask_text.push_back("hard");
-				unmask_text.push_back("package_unmask");
-			}
-		} else if(currmask.isHardMasked()) {
-			mask_text.push_back("package_mask");
-		}
-
-		if(currkey.isStable()) {
-			if(waskey.isStable()) {
-				//
-			} else if(waskey.isUnstable()) {
-				mask_text.push_back("keyword");
-				unmask_text.push_back("package_keywords");
-			} else if(waskey.isMinusKeyword()) {
-				mask_text.push_back("minus_keyword");
-				unmask_text.push_back("package_keywords");
-			} else if(waskey.isAlienStable()) {
-				mask_text.push_back("alien_stable");
-				unmask_text.push_back("package_keywords");
-			} else if(waskey.isAlienUnstable()) {
-				mask_text.push_back("alien_unstable");
-				unmask_text.push_back("package_keywords");
-			} else if(waskey.isMinusUnstable()) {
-				mask_text.push_back("minus_unstable");
-				unmask_text.push_back("package_keywords");
-			} else if(waskey.isMinusAsterisk()) {
-				mask_text.push_back("minus_asterisk");
-				unmask_text.push_back("package_keywords");
-			} else {
-				mask_text.push_back("missing_keyword");
-				unmask_text.push_back("package_keywords");
-			}
-		} else if(currkey.isUnstable()) {
-			mask_text.push_back("keyword");
-		} else if(currkey.isMinusKeyword()) {
-			mask_text.push_back("minus_keyword");
-		} else if(currkey.isAlienStable()) {
-			mask_text.push_back("alien_stable");
-		} else if(currkey.isAlienUnstable()) {
-			mask_text.push_back("alien_unstable");
-		} else if(currkey.isMinusUnstable()) {
-			mask_text.push_back("minus_unstable");
-		} else if(currkey.isMinusAsterisk()) {
-			mask_text.push_back("minus_asterisk");
-		} else {
-			mask_text.push_back("missing_keyword");
-		}
+		mask_texts(&mask_text, &unmask_text, *ver, pkg);
 
 		for(WordVec::const_iterator it(mask_text.begin());
 			unlikely(it != mask_text.end()); ++it) {
@@ -337,53 +397,15 @@ void PrintXml::package(Package *pkg) {
 			}
 		}
 
-		ExtendedVersion::Restrict restrict(ver->restrictFlags);
-		if(unlikely(restrict != ExtendedVersion::RESTRICT_NONE)) {
-			if(unlikely(restrict & ExtendedVersion::RESTRICT_BINCHECKS)) {
-				cout << "\t\t\t\t<restrict flag=\"binchecks\" />\n";
-			}
-			if(unlikely(restrict & ExtendedVersion::RESTRICT_STRIP)) {
-				cout << "\t\t\t\t<restrict flag=\"strip\" />\n";
-			}
-			if(unlikely(restrict & ExtendedVersion::RESTRICT_TEST)) {
-				cout << "\t\t\t\t<restrict flag=\"test\" />\n";
-			}
-			if(unlikely(restrict & ExtendedVersion::RESTRICT_USERPRIV)) {
-				cout << "\t\t\t\t<restrict flag=\"userpriv\" />\n";
-			}
-			if(unlikely(restrict & ExtendedVersion::RESTRICT_INSTALLSOURCES)) {
-				cout << "\t\t\t\t<restrict flag=\"installsources\" />\n";
-			}
-			if(unlikely(restrict & ExtendedVersion::RESTRICT_FETCH)) {
-				cout << "\t\t\t\t<restrict flag=\"fetch\" />\n";
-			}
-			if(unlikely(restrict & ExtendedVersion::RESTRICT_MIRROR)) {
-				cout << "\t\t\t\t<restrict flag=\"mirror\" />\n";
-			}
-			if(unlikely(restrict & ExtendedVersion::RESTRICT_PRIMARYURI)) {
-				cout << "\t\t\t\t<restrict flag=\"primaryuri\" />\n";
-			}
-			if(unlikely(restrict & ExtendedVersion::RESTRICT_BINDIST)) {
-				cout << "\t\t\t\t<restrict flag=\"bindist\" />\n";
-			}
-			if(unlikely(restrict & ExtendedVersion::RESTRICT_PARALLEL)) {
-				cout << "\t\t\t\t<restrict flag=\"parallel\" />\n";
-			}
+		WordVec restrict_text, properties_text;
+		flag_texts(&restrict_text, &properties_text, *ver);
+		for(WordVec::const_iterator it(restrict_text.begin());
+			unlikely(it != restrict_text.end()); ++it) {
+			cout << "\t\t\t\t<restrict flag=\"" << *it << "\" />\n";
 		}
-		ExtendedVersion::Restrict properties(ver->propertiesFlags);
-		if(unlikely(properties != ExtendedVersion::PROPERTIES_NONE)) {
-			if(unlikely(properties & ExtendedVersion::PROPERTIES_INTERACTIVE)) {
-				cout << "\t\t\t\t<properties flag=\"interactive\" />\n";
-			}
-			if(unlikely(properties & ExtendedVersion::PROPERTIES_LIVE)) {
-				cout << "\t\t\t\t<properties flag=\"live\" />\n";
-			}
-			if(unlikely(properties & ExtendedVersion::PROPERTIES_VIRTUAL)) {
-				cout << "\t\t\t\t<properties flag=\"virtual\" />\n";
-			}
-			if(unlikely(properties & ExtendedVersion::PROPERTIES_SET)) {
-				cout << "\t\t\t\t<properties flag=\"set\" />\n";
-			}
+		for(WordVec::const_iterator it(properties_text.begin());
+			unlikely(it != properties_text.end()); ++it) {
+			cout << "\t\t\t\t<properties flag=\"" << *it << "\" />\n";
 		}
 
 		if(keywords_mode != KW_NONE) {
@@ -435,6 +457,7 @@ void PrintXml::package(Package *pkg) {
 	}
 	cout << "\t\t</package>\n";
 	++count;
+	OutputSink::interactive_flush();
 }  // NOLINT(readability/fn_size)
 
 string PrintXml::escape_xmlstring(const string& s) {
@@ -9,20 +9,24 @@
 #ifndef SRC_OUTPUT_PRINT_XML_H_
 #define SRC_OUTPUT_PRINT_XML_H_ 1
 
+#include <set>
 #include <string>
 
 #include "eixTk/constexpr.h"
 #include "eixTk/eixint.h"
 #include "eixTk/null.h"
 #include "eixTk/ptr_list.h"
+#include "eixTk/stringtypes.h"
 #include "portage/package.h"
 
 class EixRc;
 class DBHeader;
+class ExtendedVersion;
 class VarDbPkg;
 class FormbPkg;
 class PrintFormat;
 class SetStability;
+class Version;
 
 class PrintXml {
 	protected:
@@ -43,6 +47,23 @@ class PrintXml {
 		void clear(EixRc *eixrc);
 		void runclear();
 
+		typedef std::set<const Version *> InstalledVersions;
+
+		/**
+		Collect the versions of pkg which should be output as installed
+		**/
+		void installed_versions(InstalledVersions *have_inst, Package *pkg) const ATTRIBUTE_NONNULL_;
+
+		/**
+		Collect the names of the masks of ver and what unmasked it locally
+		**/
+		void mask_texts(WordVec *mask_text, WordVec *unmask_text, const Version *ver, Package *pkg) const ATTRIBUTE_NONNULL_;
+
+		/**
+		Collect the names of the RESTRICT and PROPERTIES flags of ver
+		**/
+		static void flag_texts(WordVec *restrict_text, WordVec *properties_text, const ExtendedVersion *ver) ATTRIBUTE_NONNULL_;
+
 	public:
 		typedef eix::UNumber XmlVersion;
 		static CONSTEXPR XmlVersion current = 13;
@@ -64,12 +85,12 @@ class PrintXml {
 			clear(NULLPTR);
 		}
 
-		void start();
-		void package(Package *pkg) ATTRIBUTE_NONNULL_;
-		void finish();
+		virtual void start();
+		virtual void package(Package *pkg) ATTRIBUTE_NONNULL_;
+		virtual void finish();
 		static std::string escape_xmlstring(const std::string& s);
 
-		~PrintXml() {
+		virtual ~PrintXml() {
 			finish();
 		}
 };
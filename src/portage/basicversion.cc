@@ -22,6 +22,7 @@
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/stats.h"
 #include "eixTk/stringutils.h"
 #include "portage/basicversion.h"
 
@@ -279,6 +280,7 @@ BasicVersion::ParseResult BasicVersion::parseVersion(const string& str, string *
 }
 
 eix::SignedBool BasicVersion::compare(const BasicVersion& left, const BasicVersion& right, bool right_maybe_shorter) {
+	Stats::count(Stats::VERSIONS_COMPARED);
 	for(PartsType::const_iterator it_left(left.m_parts.begin()),
 		it_right(right.m_parts.begin()); ; ++it_left) {
 		if(it_left == left.m_parts.end()) {
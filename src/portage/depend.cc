@@ -11,6 +11,8 @@
 
 #include "eixTk/constexpr.h"
 #include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/stringtypes.h"
 #include "eixTk/stringutils.h"
 #include "portage/depend.h"
 
@@ -89,6 +91,36 @@ string Depend::subst(const string& in, const string& text, bool obs) {
 	return ret;
 }
 
+void Depend::insert_names(WordSet *names, const string& deps) {
+	WordVec words;
+	split_string(&words, deps);
+	for(WordVec::const_iterator it(words.begin()); likely(it != words.end()); ++it) {
+		const string& word(*it);
+		if((word[0] == '!') || (word[word.size() - 1] == '?')) {
+			continue;
+		}
+		string::size_type begin(word.find_first_not_of("<>=~"));
+		string::size_type end(word.find_first_of(":["));
+		if(unlikely(begin == string::npos) || (end == begin)) {
+			continue;
+		}
+		string name(word, begin, ((end == string::npos) ? end : (end - begin)));
+		string::size_type slash(name.find('/'));
+		if((slash == string::npos) || (slash == 0) || (slash + 1 == name.size())) {
+			continue;
+		}
+		if(begin != 0) {
+			// With an operator, the atom has a version
+			const char *version(ExplodeAtom::get_start_of_version(name.c_str() + slash + 1, true));
+			if(unlikely(version == NULLPTR)) {
+				continue;
+			}
+			name.erase(static_cast<string::size_type>(version - name.c_str()) - 1);
+		}
+		names->insert(name);
+	}
+}
+
 bool Depend::operator==(const Depend& d) const {
 	return ((get_depend() == d.get_depend()) &&
 		(get_rdepend() == d.get_rdepend()) &&
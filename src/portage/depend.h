@@ -10,6 +10,8 @@
 
 #include <string>
 
+#include "eixTk/stringtypes.h"
+
 class Database;
 class DBHeader;
 class Version;
@@ -17,6 +19,7 @@ class PackageTree;
 
 class Depend {
 	friend class Database;
+	friend class DBHistory;
 
 	private:
 		std::string m_depend, m_rdepend, m_pdepend, m_hdepend;
@@ -30,6 +33,12 @@ class Depend {
 	public:
 		static bool use_depend;
 
+		/**
+		Insert category/name of all atoms of the dependency string deps
+		into names; blockers and words without a category are omitted
+		**/
+		static void insert_names(WordSet *names, const std::string& deps);
+
 		Depend() : obsolete(false) {
 		}
 
@@ -20,6 +20,7 @@
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/stats.h"
 #include "eixTk/stringutils.h"
 #include "portage/basicversion.h"
 #include "portage/extendedversion.h"
@@ -288,6 +289,7 @@ bool Mask::test(const ExtendedVersion *ev) const {
 			return (BasicVersion::compare_right_maybe_shorter(*ev, *this) == 0);
 
 		case maskOpGlobExt:
+			Stats::count(Stats::FNMATCH_CALLS);
 			return (fnmatch(m_glob.c_str(), ev->getFull().c_str(), 0) == 0);
 
 		case maskOpLess:
@@ -370,8 +372,11 @@ void SetMask::applyItem(Package *pkg) const {
 }
 
 bool Mask::ismatch(const Package& pkg) const {
-	if((fnmatch(m_name.c_str(), pkg.name.c_str(), 0) != 0) ||
-		(fnmatch(m_category.c_str(), pkg.category.c_str(), 0) != 0))
+	Stats::count(Stats::FNMATCH_CALLS);
+	if(fnmatch(m_name.c_str(), pkg.name.c_str(), 0) != 0)
+		return false;
+	Stats::count(Stats::FNMATCH_CALLS);
+	if(fnmatch(m_category.c_str(), pkg.category.c_str(), 0) != 0)
 		return false;
 	for(Package::const_iterator i(pkg.begin()); likely(i != pkg.end()); ++i) {
 		if(test(*i))
@@ -21,6 +21,7 @@
 
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/stats.h"
 #include "portage/conf/cascadingprofile.h"
 #include "portage/conf/portagesettings.h"
 #include "portage/keywords.h"
@@ -62,6 +63,7 @@ Version::SavedMaskIndex SetStability::mask_index(bool get_local) const {
 #endif
 
 void SetStability::set_stability(bool get_local, Package *package) const {
+	Stats::Timer timer("stability");
 	if(get_local) {
 		portagesettings->user_config->setMasks(package, m_filemask_is_profile);
 		portagesettings->user_config->setKeyflags(package);
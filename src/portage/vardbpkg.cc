@@ -138,6 +138,27 @@ InstVec::size_type VarDbPkg::numInstalled(const Package& p) {
 	return vec->size();
 }
 
+void VarDbPkg::getInstalledNames(WordVec *names) {
+	WordVec categories;
+	pushback_files(m_directory, &categories, NULLPTR, 2, true, false);
+	for(WordVec::const_iterator cit(categories.begin());
+		likely(cit != categories.end()); ++cit) {
+		InstVecCat::const_iterator map_it(installed.find(*cit));
+		if(map_it == installed.end()) {
+			readCategory(cit->c_str());
+			map_it = installed.find(*cit);
+		}
+		const InstVecPkg *installed_cat(map_it->second);
+		if(installed_cat == NULLPTR) {
+			continue;
+		}
+		for(InstVecPkg::const_iterator it(installed_cat->begin());
+			likely(it != installed_cat->end()); ++it) {
+			names->push_back(*cit + "/" + it->first);
+		}
+	}
+}
+
 bool VarDbPkg::readOverlay(const Package& p, InstVersion *v, const DBHeader& header) const {
 	if(likely(v->know_overlay))
 		return !v->overlay_failed;
@@ -17,6 +17,7 @@
 #include "eixTk/eixint.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/stringtypes.h"
 #include "portage/basicversion.h"
 #include "portage/instversion.h"
 #include "portage/package.h"
@@ -150,6 +151,11 @@ class VarDbPkg {
 		@return number of installed versions of this package
 		**/
 		InstVec::size_type numInstalled(const Package& p);
+
+		/**
+		Append category/name of all installed packages to names
+		**/
+		void getInstalledNames(WordVec *names) ATTRIBUTE_NONNULL_;
 };
 
 #endif  // SRC_PORTAGE_VARDBPKG_H_
@@ -18,6 +18,7 @@
 
 #include "eixTk/assert.h"
 #include "eixTk/null.h"
+#include "eixTk/stats.h"
 #include "eixTk/unused.h"
 #include "portage/package.h"
 #include "search/algorithms.h"
@@ -38,6 +39,7 @@ using std::string;
 
 typedef map<string, Levenshtein> LevenshteinMap;
 LevenshteinMap *FuzzyAlgorithm::levenshtein_map = NULLPTR;
+bool FuzzyAlgorithm::m_used = false;
 
 void FuzzyAlgorithm::init_static() {
 	eix_assert_static(levenshtein_map == NULLPTR);
@@ -84,5 +86,6 @@ bool EndAlgorithm::operator()(const char *s, Package *p ATTRIBUTE_UNUSED) {
 
 bool PatternAlgorithm::operator()(const char *s, Package *p ATTRIBUTE_UNUSED) {
 	UNUSED(p);
+	Stats::count(Stats::FNMATCH_CALLS);
 	return (fnmatch(search_string.c_str(), s, FNMATCH_FLAGS) == 0);
 }
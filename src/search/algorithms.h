@@ -10,12 +10,16 @@
 #ifndef SRC_SEARCH_ALGORITHMS_H_
 #define SRC_SEARCH_ALGORITHMS_H_ 1
 
+#include <cstring>
+
 #include <map>
 #include <string>
 
+#include "eixTk/null.h"
 #include "eixTk/regexp.h"
 #include "eixTk/unused.h"
 #include "search/levenshtein.h"
+#include "search/literal_search.h"
 
 class Package;
 class matchtree;
@@ -38,17 +42,29 @@ class BaseAlgorithm {
 		}
 
 		virtual bool operator()(const char *s, Package *p) ATTRIBUTE_NONNULL((2)) = 0;
+
+		/**
+		@return true if the result depends only on the string,
+		so that it can be remembered for strings which occur repeatedly
+		**/
+		virtual bool pure() const {
+			return true;
+		}
 };
 
 /**
 Use regex to test strings for a match.
+Literal patterns are searched without the regex machinery unless
+non-ASCII characters might match them by case folding.
 **/
 class RegexAlgorithm : public BaseAlgorithm {
 	protected:
 		Regex re;
+		LiteralSearch literal;
+		bool use_literal;
 
 	public:
-		RegexAlgorithm() {
+		RegexAlgorithm() : use_literal(false) {
 		}
 
 		~RegexAlgorithm() {
@@ -57,11 +73,20 @@ class RegexAlgorithm : public BaseAlgorithm {
 
 		void setString(const std::string& s) {
 			search_string = s;
-			re.compile(search_string.c_str(), REG_ICASE);
+			use_literal = literal.assign_regex(search_string);
+			if(use_literal && literal.exact()) {
+				re.free();
+			} else {
+				re.compile(search_string.c_str(), REG_ICASE);
+			}
 		}
 
 		bool operator()(const char *s, Package *p ATTRIBUTE_UNUSED) ATTRIBUTE_NONNULL((2)) {
 			UNUSED(p);
+			if(use_literal) {
+				// A literal match is always a match of the regular expression
+				return (literal.match(s) || (!literal.exact(s) && re.match(s)));
+			}
 			return re.match(s);
 		}
 };
@@ -81,7 +106,7 @@ class SubstringAlgorithm : public BaseAlgorithm {
 	public:
 		bool operator()(const char *s, Package *p ATTRIBUTE_UNUSED) ATTRIBUTE_NONNULL((2)) {
 			UNUSED(p);
-			return (std::string(s).find(search_string) != std::string::npos);
+			return (std::strstr(s, search_string.c_str()) != NULLPTR);
 		}
 };
 
@@ -116,18 +141,35 @@ class FuzzyAlgorithm : public BaseAlgorithm {
 		**/
 		static std::map<std::string, Levenshtein> *levenshtein_map;
 
+		/**
+		Is some FuzzyAlgorithm used, so that the matches will be sorted?
+		**/
+		static bool m_used;
+
 	public:
 		explicit FuzzyAlgorithm(Levenshtein max) : max_levenshteindistance(max) {
+			m_used = true;
 		}
 
 		bool operator()(const char *s, Package *p);
 
+		bool pure() const {
+			return false;
+		}
+
 		static bool compare(Package *p1, Package *p2) ATTRIBUTE_NONNULL_;
 
 		static bool sort_by_levenshtein() {
 			return (!levenshtein_map->empty());
 		}
 
+		/**
+		@return true if the matches might be sorted by sort_by_levenshtein()
+		**/
+		static bool used() {
+			return m_used;
+		}
+
 		static void init_static();
 };
 
@@ -0,0 +1,202 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <cstring>
+
+#include <string>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2_TARGET
+#include <immintrin.h>
+#endif
+
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "search/literal_search.h"
+
+using std::string;
+
+static inline char ascii_lower(char c) ATTRIBUTE_CONST;
+static inline char ascii_lower(char c) {
+	return (((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c + ('a' - 'A')) : c);
+}
+
+/**
+Compare m characters of s case-insensitively with the lowercase p.
+A terminating '\0' of s stops the comparison since p contains none.
+**/
+static bool equal_lower(const char *s, const char *p, string::size_type m) ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+static bool equal_lower(const char *s, const char *p, string::size_type m) {
+	for(; m != 0; --m) {
+		if(ascii_lower(*(s++)) != *(p++)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool find_scalar(const char *s, string::size_type n, const char *p, string::size_type m) ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+static bool find_scalar(const char *s, string::size_type n, const char *p, string::size_type m) {
+	if(m > n) {
+		return false;
+	}
+	const char first(p[0]);
+	for(const char *end(s + (n - m)); s <= end; ++s) {
+		if((ascii_lower(*s) == first) && equal_lower(s + 1, p + 1, m - 1)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+#ifdef __SSE2__
+static inline __m128i lower_sse2(__m128i x) {
+	__m128i upper(_mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('A' - 1)),
+		_mm_cmplt_epi8(x, _mm_set1_epi8('Z' + 1))));
+	return _mm_add_epi8(x, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+}
+
+/**
+Compare the first and last character of p with 16 positions at once and
+verify only the candidates
+**/
+static bool find_sse2(const char *s, string::size_type n, const char *p, string::size_type m) ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+static bool find_sse2(const char *s, string::size_type n, const char *p, string::size_type m) {
+	if(m > n) {
+		return false;
+	}
+	const __m128i first(_mm_set1_epi8(p[0]));
+	const __m128i last(_mm_set1_epi8(p[m - 1]));
+	string::size_type i(0);
+	for(; i + m + 15 <= n; i += 16) {
+		__m128i block_first(lower_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i))));
+		__m128i block_last(lower_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + m - 1))));
+		unsigned int mask(static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(
+			_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)))));
+		for(; mask != 0; mask &= mask - 1) {
+			if(equal_lower(s + i + __builtin_ctz(mask), p, m)) {
+				return true;
+			}
+		}
+	}
+	return find_scalar(s + i, n - i, p, m);
+}
+#endif
+
+#ifdef HAVE_AVX2_TARGET
+__attribute__ ((target ("avx2")))
+static inline __m256i lower_avx2(__m256i x) {
+	__m256i upper(_mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8('A' - 1)),
+		_mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), x)));
+	return _mm256_add_epi8(x, _mm256_and_si256(upper, _mm256_set1_epi8('a' - 'A')));
+}
+
+/**
+As find_sse2(), but with 32 positions at once
+**/
+static bool find_avx2(const char *s, string::size_type n, const char *p, string::size_type m) ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+__attribute__ ((target ("avx2")))
+static bool find_avx2(const char *s, string::size_type n, const char *p, string::size_type m) {
+	if(m > n) {
+		return false;
+	}
+	const __m256i first(_mm256_set1_epi8(p[0]));
+	const __m256i last(_mm256_set1_epi8(p[m - 1]));
+	string::size_type i(0);
+	for(; i + m + 31 <= n; i += 32) {
+		__m256i block_first(lower_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i))));
+		__m256i block_last(lower_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i + m - 1))));
+		unsigned int mask(static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_and_si256(
+			_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last)))));
+		for(; mask != 0; mask &= mask - 1) {
+			if(equal_lower(s + i + __builtin_ctz(mask), p, m)) {
+				return true;
+			}
+		}
+	}
+	return find_scalar(s + i, n - i, p, m);
+}
+#endif
+
+LiteralSearch::FindKernel LiteralSearch::select_kernel() {
+#ifdef HAVE_AVX2_TARGET
+	if(__builtin_cpu_supports("avx2")) {
+		return &find_avx2;
+	}
+#endif
+#ifdef __SSE2__
+	return &find_sse2;
+#else
+	return &find_scalar;
+#endif
+}
+
+bool LiteralSearch::assign_regex(const string& re) {
+	string::size_type begin(0);
+	string::size_type end(re.size());
+	bool anchor_begin((end != 0) && (re[0] == '^'));
+	if(anchor_begin) {
+		++begin;
+	}
+	bool anchor_end((end > begin) && (re[end - 1] == '$'));
+	if(anchor_end) {
+		--end;
+	}
+	if(unlikely(begin == end) && !anchor_begin && !anchor_end) {
+		return false;
+	}
+	string lower;
+	lower.reserve(end - begin);
+	for(string::size_type i(begin); likely(i != end); ++i) {
+		char c(re[i]);
+		if(unlikely(static_cast<unsigned char>(c) >= 0x80) ||
+			(std::strchr(".[]()*+?{}|^$\\", c) != NULLPTR)) {
+			return false;
+		}
+		lower.append(1, ascii_lower(c));
+	}
+	m_fold = (lower.find_first_of("iks") != string::npos);
+	m_lower.swap(lower);
+	m_begin = anchor_begin;
+	m_end = anchor_end;
+	m_find = select_kernel();
+	return true;
+}
+
+bool LiteralSearch::match(const char *s) const {
+	string::size_type m(m_lower.size());
+	if(m_begin) {
+		if(!equal_lower(s, m_lower.c_str(), m)) {
+			return false;
+		}
+		return (!m_end || (s[m] == '\0'));
+	}
+	if(unlikely(m == 0)) {  // $
+		return true;
+	}
+	string::size_type n(std::strlen(s));
+	if(m_end) {
+		return ((n >= m) && equal_lower(s + (n - m), m_lower.c_str(), m));
+	}
+	return (*m_find)(s, n, m_lower.c_str(), m);
+}
+
+bool LiteralSearch::exact(const char *s) const {
+	if(!m_fold) {
+		return true;
+	}
+	for(; *s != '\0'; ++s) {
+		if(static_cast<unsigned char>(*s) >= 0x80) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,66 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_SEARCH_LITERAL_SEARCH_H_
+#define SRC_SEARCH_LITERAL_SEARCH_H_ 1
+
+#include <string>
+
+#include "eixTk/null.h"
+
+/**
+Case-insensitive search for a literal ASCII string, possibly anchored at
+the beginning or end. Candidates for a substring are found by comparing
+the first and last character of the pattern with 16 or 32 positions at
+once if the processor supports it; no memory is allocated for matching.
+**/
+class LiteralSearch {
+	public:
+		typedef bool (*FindKernel)(const char *s, std::string::size_type n, const char *p, std::string::size_type m);
+
+		LiteralSearch() : m_fold(false), m_find(NULLPTR) {
+		}
+
+		/**
+		@return true if the extended regular expression re (matched with
+		REG_ICASE) is an ASCII literal, possibly with ^ or $ anchors.
+		In this case, use it as the pattern.
+		**/
+		bool assign_regex(const std::string& re);
+
+		/**
+		@return true if the pattern matches s
+		**/
+		bool match(const char *s) const ATTRIBUTE_NONNULL_;
+
+		/**
+		In some locales, non-ASCII characters match i, k, or s with
+		REG_ICASE, which match() does not take into account.
+		@return true if match() agrees with the regular expression for
+		all strings
+		**/
+		bool exact() const {
+			return !m_fold;
+		}
+
+		/**
+		@return true if match() agrees with the regular expression for s
+		**/
+		bool exact(const char *s) const ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+
+	private:
+		/**
+		The pattern in lowercase
+		**/
+		std::string m_lower;
+		bool m_begin, m_end, m_fold;
+		FindKernel m_find;
+
+		static FindKernel select_kernel() ATTRIBUTE_PURE;
+};
+
+#endif  // SRC_SEARCH_LITERAL_SEARCH_H_
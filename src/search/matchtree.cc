@@ -13,6 +13,7 @@
 #include <cstdlib>
 #endif
 
+#include <algorithm>
 #include <iostream>
 #include <stack>
 
@@ -106,6 +107,88 @@ bool MatchAtomTest::match(PackageReader *p) {
 #endif
 }
 
+unsigned int MatchAtomTest::cost() const {
+	unsigned int c((m_test == NULLPTR) ? 0 : m_test->cost());
+	if(m_pipe != NULLPTR) {
+		// The pipe tests are added only after parsing
+		c += 8;
+	}
+	return c;
+}
+
+bool MatchAtomTest::reorderable() const {
+	return ((m_test == NULLPTR) || m_test->reorderable());
+}
+
+bool MatchAtomTest::requires_installed() const {
+	return (!m_negate && (m_test != NULLPTR) && m_test->requires_installed());
+}
+
+MatchAtomGroup::~MatchAtomGroup() {
+	for(Operands::iterator it(m_operands.begin());
+		likely(it != m_operands.end()); ++it) {
+		delete *it;
+	}
+}
+
+bool MatchAtomGroup::match(PackageReader *p) {
+	bool is_match(m_and);
+	for(Operands::iterator it(m_operands.begin());
+		likely(it != m_operands.end()); ++it) {
+		if((*it)->match(p) != m_and) {
+			is_match = !m_and;
+			break;
+		}
+	}
+	if(m_negate) {
+		return !is_match;
+	}
+	return is_match;
+}
+
+unsigned int MatchAtomGroup::cost() const {
+	unsigned int c(0);
+	for(Operands::const_iterator it(m_operands.begin());
+		likely(it != m_operands.end()); ++it) {
+		c += (*it)->cost();
+	}
+	return c;
+}
+
+bool MatchAtomGroup::reorderable() const {
+	for(Operands::const_iterator it(m_operands.begin());
+		likely(it != m_operands.end()); ++it) {
+		if(unlikely(!(*it)->reorderable())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool MatchAtomGroup::requires_installed() const {
+	if(m_negate || m_operands.empty()) {
+		return false;
+	}
+	// For AND, some operand must require it; for OR, all of them
+	for(Operands::const_iterator it(m_operands.begin());
+		likely(it != m_operands.end()); ++it) {
+		if((*it)->requires_installed() == m_and) {
+			return m_and;
+		}
+	}
+	return !m_and;
+}
+
+bool MatchAtomGroup::cheaper(const MatchAtom *a, const MatchAtom *b) {
+	return (a->cost() < b->cost());
+}
+
+void MatchAtomGroup::sort() {
+	if(likely(reorderable())) {
+		std::stable_sort(m_operands.begin(), m_operands.end(), cheaper);
+	}
+}
+
 void MatchAtomTest::set_test(PackageTest *gtest) {
 #ifdef DEBUG_MATCHTREE
 	static int t_count(0);
@@ -138,6 +221,10 @@ bool MatchTree::match(PackageReader *p) {
 	return ((root == NULLPTR) || root->match(p));
 }
 
+bool MatchTree::requires_installed() const {
+	return ((root != NULLPTR) && root->requires_installed());
+}
+
 void MatchTree::set_pipetest(PackageTest *gtest) {
 	MatchAtomTest *p(new MatchAtomTest);
 	p->set_test(gtest);
@@ -145,10 +232,13 @@ void MatchTree::set_pipetest(PackageTest *gtest) {
 		piperoot = p;
 		return;
 	}
-	MatchAtomOperator *o(new MatchAtomOperator(MatchAtomOperator::AtomOr));
-	o->m_left = piperoot;
-	o->m_right = p;
-	piperoot = o;
+	MatchAtomGroup *o(piperoot->as_group());
+	if(o == NULLPTR) {
+		o = new MatchAtomGroup(false, false);
+		o->m_operands.push_back(piperoot);
+		piperoot = o;
+	}
+	o->m_operands.push_back(p);
 }
 
 MatchAtomTest *MatchTree::parse_new_leaf() {
@@ -276,11 +366,48 @@ void MatchTree::parse_close() {
 	parse_closeforce();
 }
 
+MatchAtom *MatchTree::optimize(MatchAtom *atom) {
+	if(atom == NULLPTR) {
+		return new MatchAtom;
+	}
+	MatchAtomOperator *op(atom->as_operator());
+	if(op == NULLPTR) {
+		return atom;
+	}
+	bool is_and(op->m_operator == MatchAtomOperator::AtomAnd);
+	MatchAtomGroup *group(new MatchAtomGroup(is_and, op->m_negate));
+	MatchAtom *operands[2] = { op->m_left, op->m_right };
+	op->m_left = op->m_right = NULLPTR;
+	delete op;
+	for(unsigned int i(0); i != 2; ++i) {
+		MatchAtom *operand(optimize(operands[i]));
+		MatchAtomGroup *g(operand->as_group());
+		if((g == NULLPTR) || (g->m_and != is_and) || g->m_negate) {
+			group->m_operands.push_back(operand);
+			continue;
+		}
+		group->m_operands.insert(group->m_operands.end(),
+			g->m_operands.begin(), g->m_operands.end());
+		g->m_operands.clear();
+		delete g;
+	}
+	group->sort();
+	return group;
+}
+
 void MatchTree::end_parse() {
+	if(parser_stack.empty()) {
+		return;
+	}
 	parse_local_negate();
 	while(!parser_stack.empty()) {
 		parse_closeforce();
 	}
+#ifndef DEBUG_MATCHTREE
+	if(root != NULLPTR) {
+		root = optimize(root);
+	}
+#endif
 #ifdef DEBUG_MATCHTREE
 	if(root == NULLPTR) {
 		cout << "root=NULLPTR\n";
@@ -9,9 +9,11 @@
 #define SRC_SEARCH_MATCHTREE_H_ 1
 
 #include <stack>
+#include <vector>
 
 #include "eixTk/null.h"
 
+class MatchAtomGroup;
 class MatchAtomOperator;
 class MatchAtomTest;
 class MatchTree;
@@ -50,6 +52,32 @@ class MatchAtom {
 		virtual MatchAtomTest *as_test() {
 			return NULLPTR;
 		}
+
+		virtual MatchAtomGroup *as_group() {
+			return NULLPTR;
+		}
+
+		/**
+		@return an estimate of the cost of match()
+		**/
+		virtual unsigned int cost() const {
+			return 0;
+		}
+
+		/**
+		@return false if match() has side effects which forbid to
+		change the order of evaluation
+		**/
+		virtual bool reorderable() const {
+			return true;
+		}
+
+		/**
+		@return true if only installed packages can match
+		**/
+		virtual bool requires_installed() const {
+			return false;
+		}
 };
 
 class MatchAtomOperator : public MatchAtom {
@@ -92,6 +120,50 @@ class MatchAtomTest : public MatchAtom {
 		MatchAtomTest *as_test() {
 			return this;
 		}
+
+		unsigned int cost() const ATTRIBUTE_PURE;
+
+		bool reorderable() const ATTRIBUTE_PURE;
+
+		bool requires_installed() const ATTRIBUTE_PURE;
+};
+
+/**
+AND or OR of arbitrarily many operands.
+After parsing, MatchTree replaces nested MatchAtomOperator nodes by these.
+If possible, the operands are sorted so that cheap tests come first.
+**/
+class MatchAtomGroup : public MatchAtom {
+		friend class MatchTree;
+	private:
+		typedef std::vector<MatchAtom *> Operands;
+		bool m_and;
+		Operands m_operands;
+
+		static bool cheaper(const MatchAtom *a, const MatchAtom *b) ATTRIBUTE_NONNULL_;
+
+	public:
+		MatchAtomGroup(bool is_and, bool negate) : MatchAtom(negate), m_and(is_and) {
+		}
+
+		~MatchAtomGroup();
+
+		bool match(PackageReader *p);
+
+		MatchAtomGroup *as_group() {
+			return this;
+		}
+
+		unsigned int cost() const;
+
+		bool reorderable() const;
+
+		bool requires_installed() const;
+
+		/**
+		Sort the operands by cost, unless some is not reorderable
+		**/
+		void sort();
 };
 
 class MatchParseData {
@@ -165,6 +237,12 @@ class MatchTree {
 		**/
 		void parse_closeforce();
 
+		/**
+		Flatten nested operators into MatchAtomGroup and sort them.
+		@return the replacement for atom which is freed
+		**/
+		static MatchAtom *optimize(MatchAtom *atom);
+
 	public:
 		explicit MatchTree(bool default_is_or);
 
@@ -172,6 +250,11 @@ class MatchTree {
 
 		bool match(PackageReader *p);
 
+		/**
+		@return true if only installed packages can match
+		**/
+		bool requires_installed() const;
+
 		void set_pipetest(PackageTest *gtest);
 
 		void parse_test(PackageTest *gtest, bool with_pipe);
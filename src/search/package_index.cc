@@ -0,0 +1,92 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <fnmatch.h>
+
+#include <string>
+
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/stats.h"
+#include "portage/basicversion.h"
+#include "portage/mask.h"
+#include "portage/package.h"
+#include "portage/version.h"
+#include "search/package_index.h"
+
+using std::string;
+
+static bool is_glob(const string& s) ATTRIBUTE_PURE;
+
+static bool is_glob(const string& s) {
+	return (s.find_first_of("*?[") != string::npos);
+}
+
+PackageIndex::~PackageIndex() {
+	for(Categories::iterator c(categories.begin());
+		likely(c != categories.end()); ++c) {
+		for(Names::iterator n(c->second.begin());
+			likely(n != c->second.end()); ++n) {
+			delete n->second;
+		}
+	}
+}
+
+void PackageIndex::add(const Package& pkg) {
+	Package *&p(categories[pkg.category][pkg.name]);
+	if(unlikely(p != NULLPTR)) {
+		delete p;
+	}
+	p = new Package(pkg.category, pkg.name);
+	for(Package::const_iterator it(pkg.begin()); likely(it != pkg.end()); ++it) {
+		Version *v(new Version);
+		*static_cast<BasicVersion *>(v) = **it;
+		v->slotname = it->slotname;
+		v->subslotname = it->subslotname;
+		v->reponame = it->reponame;
+		p->push_back(v);
+	}
+}
+
+bool PackageIndex::have_match(const Names& names, const Mask& m) {
+	const char *name(m.getName());
+	if(!is_glob(name)) {
+		Names::const_iterator it(names.find(name));
+		return ((it != names.end()) && m.ismatch(*(it->second)));
+	}
+	for(Names::const_iterator it(names.begin()); likely(it != names.end()); ++it) {
+		Stats::count(Stats::FNMATCH_CALLS);
+		if((fnmatch(name, it->first.c_str(), 0) == 0) && m.ismatch(*(it->second))) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool PackageIndex::have_match(const Mask& m) const {
+	const char *category(m.getCategory());
+	if(!is_glob(category)) {
+		Categories::const_iterator it(categories.find(category));
+		return ((it != categories.end()) && have_match(it->second, m));
+	}
+	for(Categories::const_iterator it(categories.begin());
+		likely(it != categories.end()); ++it) {
+		Stats::count(Stats::FNMATCH_CALLS);
+		if((fnmatch(category, it->first.c_str(), 0) == 0) && have_match(it->second, m)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool PackageIndex::have_package(const string& category, const string& name) const {
+	Categories::const_iterator it(categories.find(category));
+	return ((it != categories.end()) &&
+		(it->second.find(name) != it->second.end()));
+}
@@ -0,0 +1,52 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_SEARCH_PACKAGE_INDEX_H_
+#define SRC_SEARCH_PACKAGE_INDEX_H_ 1
+
+#include <map>
+#include <string>
+
+class Mask;
+class Package;
+
+/**
+Index of the names and versions of all packages of the database by
+category and name. Only what Mask::ismatch() needs is kept.
+This is used to find the entries of /etc/portage which match no package.
+**/
+class PackageIndex {
+	private:
+		typedef std::map<std::string, Package *> Names;
+		typedef std::map<std::string, Names> Categories;
+
+		Categories categories;
+
+		static bool have_match(const Names& names, const Mask& m);
+
+	public:
+		~PackageIndex();
+
+		/**
+		Store category, name, and the version, slot and repository data
+		of pkg
+		**/
+		void add(const Package& pkg);
+
+		/**
+		@return true if m matches some package.
+		Only those packages are tested whose category and name can match
+		**/
+		bool have_match(const Mask& m) const;
+
+		/**
+		@return true if the package category/name is in the index
+		**/
+		bool have_package(const std::string& category, const std::string& name) const ATTRIBUTE_PURE;
+};
+
+#endif  // SRC_SEARCH_PACKAGE_INDEX_H_
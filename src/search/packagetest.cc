@@ -14,6 +14,9 @@
 #include <string>
 #include <vector>
 
+#include "database/header.h"
+#include "database/io.h"
+#include "database/names_index.h"
 #include "database/package_reader.h"
 #include "eixTk/assert.h"
 #include "eixTk/eixint.h"
@@ -41,7 +44,6 @@
 #include "search/nowarn.h"
 #include "search/packagetest.h"
 
-class DBHeader;
 class SetStability;
 
 using std::map;
@@ -109,16 +111,20 @@ PackageTest::PackageTest(VarDbPkg *vdb, PortageSettings *p, const PrintFormat *f
 	from_overlay_inst_list = NULLPTR;
 	from_foreign_overlay_inst_list = NULLPTR;
 	marked_list = NULLPTR;
+	rdeps_db = NULLPTR;
+	rdeps_field = NONE;
+	rdeps_packages = NULLPTR;
 
 	field = NONE;
 	need = PackageReader::NONE;
+	m_cost = 0;
 	overlay = obsolete = upgrade = installed = multi_installed =
 		slotted = multi_slot =
 		world = world_only_selected = world_only_file =
 		worldset = worldset_only_selected =
 		dup_versions = dup_packages =
 		have_virtual = have_nonvirtual =
-		know_pattern = false;
+		know_pattern = cache_matches = false;
 	restrictions = ExtendedVersion::RESTRICT_NONE;
 	properties = ExtendedVersion::PROPERTIES_NONE;
 	binarynum = 0;
@@ -134,11 +140,19 @@ PackageTest::~PackageTest() {
 	delete in_overlay_inst_list;
 	delete from_overlay_inst_list;
 	delete from_foreign_overlay_inst_list;
+	delete rdeps_packages;
 }
 
 void PackageTest::calculateNeeds() {
 	need = PackageReader::NONE;
-	if((field & (EAPI | SLOT | FULLSLOT | SET)) != NONE) {
+	// Without the split layout, the versions are read only as a whole
+	// (after DESCRIPTION, HOMEPAGE, and LICENSE)
+	PackageReader::Attributes slots((header->names_first) ?
+		PackageReader::SLOTS : PackageReader::VERSIONS);
+	if((field & (SLOT | FULLSLOT)) != NONE) {
+		setNeeds(slots);
+	}
+	if((field & (EAPI | SET)) != NONE) {
 		setNeeds(PackageReader::VERSIONS);
 	}
 	if((field & HOMEPAGE) != NONE) {
@@ -165,15 +179,22 @@ void PackageTest::calculateNeeds() {
 	if(!Depend::use_depend) {
 		field &= ~DEPS;
 	}
-	if(((field & (IUSE | DEPS)) != NONE)  ||
-		dup_packages || dup_versions || slotted ||
-		upgrade || overlay || obsolete ||
-		world || worldset ||
+	if((field & (IUSE | DEPS)) != NONE) {
+		setNeeds(PackageReader::DETAILS);
+	}
+	if(rdeps_db != NULLPTR) {
+		setNeeds((rdeps_packages != NULLPTR) ? PackageReader::NAME : PackageReader::DETAILS);
+	}
+	if(dup_packages || dup_versions || slotted || overlay ||
 		have_virtual || have_nonvirtual ||
+		(overlay_list != NULLPTR) || (overlay_only_list != NULLPTR) ||
+		(in_overlay_inst_list != NULLPTR)) {
+		setNeeds(slots);
+	}
+	if(upgrade || obsolete ||
+		world || worldset ||
 		(from_overlay_inst_list != NULLPTR) ||
 		(from_foreign_overlay_inst_list != NULLPTR) ||
-		(overlay_list != NULLPTR) || (overlay_only_list != NULLPTR) ||
-		(in_overlay_inst_list != NULLPTR) ||
 		(marked_list != NULLPTR) ||
 		(restrictions != ExtendedVersion::RESTRICT_NONE) ||
 		(properties != ExtendedVersion::PROPERTIES_NONE) ||
@@ -185,6 +206,50 @@ void PackageTest::calculateNeeds() {
 		setNeeds(PackageReader::VERSIONS);
 }
 
+/**
+The numbers are only meant to order tests: Reading versions is more
+expensive than reading the other attributes; anything which looks into
+the installed packages or calculates the stability is far more expensive.
+**/
+void PackageTest::calculateCost() {
+	if(need < PackageReader::VERSIONS) {
+		m_cost = need;
+	} else {
+		m_cost = ((need == PackageReader::VERSIONS) ? 8 : 12);
+	}
+	if((field & (EAPI | SLOT | FULLSLOT | IUSE)) != NONE) {
+		m_cost += 4;
+	}
+	if(((field & (DEPS | SET)) != NONE) ||
+		((rdeps_db != NULLPTR) && (rdeps_packages == NULLPTR))) {
+		m_cost += 8;
+	}
+	if((field & (USE_ENABLED | USE_DISABLED | INST_EAPI | INST_SLOT | INST_FULLSLOT)) != NONE) {
+		m_cost += 32;
+	}
+	if(installed || (in_overlay_inst_list != NULLPTR) ||
+		(from_overlay_inst_list != NULLPTR) ||
+		(from_foreign_overlay_inst_list != NULLPTR) ||
+		(restrictions != ExtendedVersion::RESTRICT_NONE) ||
+		(properties != ExtendedVersion::PROPERTIES_NONE) ||
+		(binarynum != 0)) {
+		m_cost += 16;
+	}
+	if(marked_list != NULLPTR) {
+		m_cost += 4;
+	}
+	if(world || worldset ||
+		(test_stability_default != STABLE_NONE) ||
+		(test_stability_local != STABLE_NONE) ||
+		(test_stability_nonlocal != STABLE_NONE) ||
+		(test_instability != STABLE_NONE)) {
+		m_cost += 32;
+	}
+	if(upgrade || obsolete) {
+		m_cost += 64;
+	}
+}
+
 typedef map<string, PackageTest::MatchField> MatchFieldMap;
 static MatchFieldMap *static_match_field_map = NULLPTR;
 
@@ -431,11 +496,144 @@ void PackageTest::setPattern(const char *p) {
 	algorithm->setString(p);
 }
 
+void PackageTest::ReverseDeps(const char *atom, Database *db) {
+	string word(atom);
+	if(word.find('/') >= word.find_first_of(":[")) {
+		// No category (a slash can only be in a subslot): Parse the
+		// bare name with a dummy category which is removed below
+		string::size_type begin(word.find_first_not_of("<>=~"));
+		word.insert(((begin == string::npos) ? word.size() : begin), "_/");
+	}
+	WordSet names;
+	Depend::insert_names(&names, word);
+	rdeps_name = (names.empty() ? atom : *(names.begin()));
+	if(rdeps_name.compare(0, 2, "_/") == 0) {
+		rdeps_name.erase(0, 2);
+	}
+	rdeps_db = db;
+}
+
+void PackageTest::lookup_rdeps() {
+	delete rdeps_packages;
+	rdeps_packages = NULLPTR;
+	if(!header->names_index || !Depend::use_depend) {
+		return;
+	}
+	static const MatchField fields[] = { DEPEND, RDEPEND, PDEPEND, HDEPEND };
+	static const NamesIndex::Dictionary dictionaries[] = {
+		NamesIndex::DEPEND, NamesIndex::RDEPEND,
+		NamesIndex::PDEPEND, NamesIndex::HDEPEND
+	};
+	eix::OffsetType pos(rdeps_db->tell());
+	NamesIndex index;
+	if(likely(index.read_trailer(rdeps_db))) {
+		WordSet *packages(new WordSet);
+		string errtext;
+		WordVec names;
+		if(rdeps_name.find('/') != string::npos) {
+			names.push_back(rdeps_name);
+		} else if(unlikely(!index.find_categories(rdeps_db, rdeps_name, &names, &errtext))) {
+			cerr << errtext << endl;
+			delete packages;
+			packages = NULLPTR;
+		} else if(names.empty()) {
+			// No such package: Look into the dependencies themselves
+			delete packages;
+			packages = NULLPTR;
+		}
+		for(WordVec::const_iterator name(names.begin());
+			likely(packages != NULLPTR) && likely(name != names.end()); ++name) {
+			string prefix(*name + " ");
+			for(unsigned int i(0); likely(i != sizeof(fields) / sizeof(fields[0])); ++i) {
+				if((rdeps_field & fields[i]) == NONE) {
+					continue;
+				}
+				NamesIndex::Entries entries;
+				if(unlikely(!index.find(rdeps_db, dictionaries[i], prefix, &entries, &errtext))) {
+					cerr << errtext << endl;
+					delete packages;
+					packages = NULLPTR;
+					break;
+				}
+				for(NamesIndex::Entries::const_iterator it(entries.begin());
+					likely(it != entries.end()); ++it) {
+					packages->insert(it->first.substr(prefix.size()));
+				}
+			}
+		}
+		rdeps_packages = packages;
+	}
+	rdeps_db->seekabs(pos, NULLPTR);
+}
+
 void PackageTest::finalize() {
+	if(rdeps_db != NULLPTR) {
+		rdeps_field = field & DEPS;
+		if(rdeps_field == NONE) {
+			rdeps_field = DEPS;
+		}
+		if(!know_pattern) {
+			// The fields only select the dependency classes
+			field &= ~DEPS;
+		}
+		lookup_rdeps();
+	}
 	if(!know_pattern) {
 		setPattern("");
 	}
+	cache_matches = algorithm->pure();
+	match_cache.clear();
 	calculateNeeds();
+	calculateCost();
+}
+
+bool PackageTest::rdepsMatch(const Package *pkg) const {
+	if(!Depend::use_depend) {
+		return false;
+	}
+	if(rdeps_packages != NULLPTR) {
+		return (rdeps_packages->find(pkg->category + "/" + pkg->name) != rdeps_packages->end());
+	}
+	WordSet names;
+	for(Package::const_iterator it(pkg->begin()); likely(it != pkg->end()); ++it) {
+		const Depend& dep(it->depend);
+		if((rdeps_field & DEPEND) != NONE) {
+			Depend::insert_names(&names, dep.get_depend());
+		}
+		if((rdeps_field & RDEPEND) != NONE) {
+			Depend::insert_names(&names, dep.get_rdepend());
+		}
+		if((rdeps_field & PDEPEND) != NONE) {
+			Depend::insert_names(&names, dep.get_pdepend());
+		}
+		if((rdeps_field & HDEPEND) != NONE) {
+			Depend::insert_names(&names, dep.get_hdepend());
+		}
+	}
+	if(rdeps_name.find('/') != string::npos) {
+		return (names.find(rdeps_name) != names.end());
+	}
+	// A bare name matches in every category
+	for(WordSet::const_iterator it(names.begin()); likely(it != names.end()); ++it) {
+		string::size_type slash(it->find('/'));
+		if(it->compare(slash + 1, string::npos, rdeps_name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool PackageTest::hashedMatch(const string& s, Package *pkg) const {
+	if(unlikely(!cache_matches)) {
+		return (*algorithm)(s.c_str(), pkg);
+	}
+	MatchCache::const_iterator it(match_cache.find(s));
+	if(likely(it != match_cache.end())) {
+		return it->second;
+	}
+	bool result((*algorithm)(s.c_str(), pkg));
+	match_cache.insert(MatchCache::value_type(s, result));
+	return result;
 }
 
 /**
@@ -444,7 +642,7 @@ void PackageTest::finalize() {
 bool PackageTest::stringMatch(Package *pkg) const {
 	if((((field & NAME) != NONE) && (*algorithm)(pkg->name.c_str(), pkg))
 	|| (((field & DESCRIPTION) != NONE)  && (*algorithm)(pkg->desc.c_str(), pkg))
-	|| (((field & LICENSE) != NONE) && (*algorithm)(pkg->licenses.c_str(), pkg))
+	|| (((field & LICENSE) != NONE) && hashedMatch(pkg->licenses, pkg))
 	|| (((field & CATEGORY) != NONE) && (*algorithm)(pkg->category.c_str(), pkg))
 	|| (((field & CATEGORY_NAME) != NONE) && (*algorithm)((pkg->category + "/" + pkg->name).c_str(), pkg))
 	|| (((field & HOMEPAGE) != NONE) && (*algorithm)(pkg->homepage.c_str(), pkg))) {
@@ -454,7 +652,7 @@ bool PackageTest::stringMatch(Package *pkg) const {
 	if((field & EAPI) != NONE) {
 		for(Package::iterator it(pkg->begin());
 			likely(it != pkg->end()); ++it) {
-			if((*algorithm)(it->eapi.get().c_str(), pkg))
+			if(hashedMatch(it->eapi.get(), pkg))
 				return true;
 		}
 	}
@@ -462,7 +660,7 @@ bool PackageTest::stringMatch(Package *pkg) const {
 	if((field & SLOT) != NONE) {
 		for(Package::iterator it(pkg->begin());
 			likely(it != pkg->end()); ++it) {
-			if((*algorithm)(it->get_longslot().c_str(), pkg))
+			if(hashedMatch(it->get_longslot(), pkg))
 				return true;
 		}
 	}
@@ -470,7 +668,7 @@ bool PackageTest::stringMatch(Package *pkg) const {
 	if((field & FULLSLOT) != NONE) {
 		for(Package::iterator it(pkg->begin());
 			likely(it != pkg->end()); ++it) {
-			if((*algorithm)(it->get_longfullslot().c_str(), pkg))
+			if(hashedMatch(it->get_longfullslot(), pkg))
 				return true;
 		}
 	}
@@ -479,7 +677,7 @@ bool PackageTest::stringMatch(Package *pkg) const {
 		const IUseSet::IUseStd& s(pkg->iuse.asStd());
 		for(IUseSet::IUseStd::const_iterator it(s.begin());
 			it != s.end(); ++it) {
-			if((*algorithm)(it->name().c_str(), NULLPTR))
+			if(hashedMatch(it->name(), NULLPTR))
 				return true;
 		}
 	}
@@ -795,6 +993,14 @@ bool PackageTest::match(PackageReader *pkg) const {
 		}
 	}
 
+	if(unlikely(rdeps_db != NULLPTR)) {
+		// --rdeps
+		get_p(&p, pkg);
+		if(!rdepsMatch(p)) {
+			return false;
+		}
+	}
+
 	if(unlikely(slotted)) {
 		// -1 or -2
 		get_p(&p, pkg);
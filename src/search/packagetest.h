@@ -10,6 +10,7 @@
 #ifndef SRC_SEARCH_PACKAGETEST_H_
 #define SRC_SEARCH_PACKAGETEST_H_ 1
 
+#include <map>
 #include <set>
 #include <string>
 #include <vector>
@@ -19,6 +20,7 @@
 #include "eixTk/inttypes.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/stringtypes.h"
 #include "portage/extendedversion.h"
 #include "portage/keywords.h"
 #include "portage/package.h"
@@ -26,6 +28,7 @@
 #include "search/redundancy.h"
 
 class BaseAlgorithm;
+class Database;
 class Mask;
 class MatcherAlgorithm;
 class MatcherField;
@@ -118,6 +121,23 @@ class PackageTest {
 		**/
 		void finalize();
 
+		/**
+		@return a rough estimate of the cost of match(), known after finalize()
+		**/
+		unsigned int cost() const {
+			return m_cost;
+		}
+
+		/**
+		@return false if the order in which match() is called for this and
+		other tests matters: This is the case for the fuzzy algorithm
+		which remembers distances for sorting, or for -T which modifies the
+		masks of the package
+		**/
+		bool reorderable() const {
+			return (cache_matches && !obsolete);
+		}
+
 		/*
 		The constructor of the class *must* set the least restrictive choice.
 		Since --selected --world must act like --selected, the less restrictive
@@ -135,6 +155,13 @@ class PackageTest {
 			installed = multi_installed = true;
 		}
 
+		/**
+		@return true if only installed packages can match
+		**/
+		bool requires_installed() const {
+			return installed;
+		}
+
 		void Slotted() {
 			slotted = true;
 		}
@@ -258,6 +285,15 @@ class PackageTest {
 			return from_foreign_overlay_inst_list;
 		}
 
+		/**
+		Test for packages with a dependency on the category/name of atom;
+		if atom has no category, on the name in any category.
+		The dependency classes are those of the match field (all if none).
+		If the database has a names index, db is used to read the
+		depending packages from it when the test is finalized.
+		**/
+		void ReverseDeps(const char *atom, Database *db) ATTRIBUTE_NONNULL_;
+
 		void DuplVersions(bool only_overlay) {
 			dup_versions = true;
 			dup_versions_overlay = only_overlay;
@@ -313,11 +349,20 @@ class PackageTest {
 		What we need to read so we can do our testing
 		**/
 		PackageReader::Attributes need;
+		unsigned int m_cost;
 		/**
 		Our string matching algorithm
 		**/
 		BaseAlgorithm *algorithm;
 
+		/**
+		Results of a pure algorithm for values like EAPI, slot, IUSE or
+		license which repeat in many versions of the database
+		**/
+		typedef std::map<std::string, bool> MatchCache;
+		mutable MatchCache match_cache;
+		bool cache_matches;
+
 		/**
 		Other flags for tests
 		**/
@@ -344,6 +389,16 @@ class PackageTest {
 
 		MaskList<Mask> *marked_list;
 
+		/**
+		For --rdeps: The category/name (or the bare name) of the dependency,
+		the dependency classes and, if there is an index, the depending
+		category/name
+		**/
+		Database *rdeps_db;
+		std::string rdeps_name;
+		MatchField rdeps_field;
+		WordSet *rdeps_packages;
+
 		PortageSettings *portagesettings;
 		/**
 		Lookup stuff about user flags here
@@ -367,6 +422,19 @@ class PackageTest {
 
 		bool stringMatch(Package *pkg) const ATTRIBUTE_NONNULL_;
 
+		/**
+		Read rdeps_packages from the index of the database if possible
+		**/
+		void lookup_rdeps();
+
+		bool rdepsMatch(const Package *pkg) const ATTRIBUTE_NONNULL_;
+
+		/**
+		@return the result of the algorithm for s, calling the algorithm
+		only once for each distinct s if it is pure
+		**/
+		bool hashedMatch(const std::string& s, Package *pkg) const;
+
 		void setNeeds(const PackageReader::Attributes i) {
 			if(need < i) {
 				need = i;
@@ -378,6 +446,11 @@ class PackageTest {
 		**/
 		void calculateNeeds();
 
+		/**
+		Estimate m_cost from the needs and the tests
+		**/
+		void calculateCost();
+
 		bool have_redundant(const Package& p, Keywords::Redundant r, const RedAtom& t) const;
 		bool have_redundant(const Package& p, Keywords::Redundant r) const;
 		bool instabilitytest(const Package *p, TestStability what) const ATTRIBUTE_NONNULL_;
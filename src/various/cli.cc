@@ -79,7 +79,7 @@ static bool optional_numeric_increase(ArgumentReader::const_iterator *arg, const
 	} \
 } while(0)
 
-void parse_cli(MatchTree *matchtree, EixRc *eixrc, VarDbPkg *varpkg_db, PortageSettings *portagesettings, const PrintFormat *print_format, const SetStability *stability, const DBHeader *header, const ParseError *parse_error, MaskList<Mask> **marked_list, const ArgumentReader& ar) {
+void parse_cli(MatchTree *matchtree, EixRc *eixrc, VarDbPkg *varpkg_db, PortageSettings *portagesettings, const PrintFormat *print_format, const SetStability *stability, const DBHeader *header, Database *db, const ParseError *parse_error, MaskList<Mask> **marked_list, const ArgumentReader& ar) {
 	bool	use_pipe(false),      // A pipe is used somewhere
 		force_test(false),    // There is a current test or a pipe
 		curr_pipe(false),     // There is a current pipe
@@ -280,6 +280,11 @@ void parse_cli(MatchTree *matchtree, EixRc *eixrc, VarDbPkg *varpkg_db, PortageS
 					(*portagesettings)["PORTDIR"].c_str());
 				test->FromForeignOverlayInstList()->push_back("");
 				break;
+			case O_RDEPS: USE_TEST;
+				if(likely(optional_increase(&arg, ar))) {
+					test->ReverseDeps(arg->m_argument, db);
+				}
+				break;
 			case 'd': USE_TEST;
 				test->DuplPackages(eixrc->getBool("DUP_PACKAGES_ONLY_OVERLAYS"));
 				break;
@@ -13,6 +13,7 @@
 #include "eixTk/argsreader.h"
 
 class DBHeader;
+class Database;
 class EixRc;
 class Mask;
 class MatchTree;
@@ -23,7 +24,7 @@ class SetStability;
 class VarDbPkg;
 template<typename m_Type> class MaskList;
 
-void parse_cli(MatchTree *matchtree, EixRc *eixrc, VarDbPkg *varpkg_db, PortageSettings *portagesettings, const PrintFormat *print_format, const SetStability *stability, const DBHeader *header, const ParseError *parse_error, MaskList<Mask> **marked_list, const ArgumentReader& ar) ATTRIBUTE_NONNULL_;
+void parse_cli(MatchTree *matchtree, EixRc *eixrc, VarDbPkg *varpkg_db, PortageSettings *portagesettings, const PrintFormat *print_format, const SetStability *stability, const DBHeader *header, Database *db, const ParseError *parse_error, MaskList<Mask> **marked_list, const ArgumentReader& ar) ATTRIBUTE_NONNULL_;
 
 /*
 	If you want to add a new parameter to eix just insert a line into
@@ -35,6 +36,7 @@ void parse_cli(MatchTree *matchtree, EixRc *eixrc, VarDbPkg *varpkg_db, PortageS
 enum cli_options {
 	O_FMT = 256,
 	O_XML,
+	O_JSON,
 	O_PRINT_VAR,
 	O_PIPE_MASK,
 	O_ANSI,
@@ -62,6 +64,7 @@ enum cli_options {
 	O_HASH_DEPEND,
 	O_PROFILE_PATHS,
 	O_WORLD_SETS,
+	O_COMPLETE,
 	O_STABLE_DEFAULT,
 	O_TESTING_DEFAULT,
 	O_NONMASKED_DEFAULT,
@@ -101,6 +104,7 @@ enum cli_options {
 	O_NONVIRTUAL,
 	O_VIRTUAL,
 	O_DEBUG,
+	O_STATS,
 	O_SEARCH_EAPI,
 	O_SEARCH_INST_EAPI,
 	O_SEARCH_SLOT,
@@ -114,6 +118,7 @@ enum cli_options {
 	O_PDEPEND,
 	O_HDEPEND,
 	O_DEPS,
+	O_RDEPS,
 	O_RESTRICT_FETCH,
 	O_RESTRICT_MIRROR,
 	O_RESTRICT_PRIMARYURI,
@@ -0,0 +1,250 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include <iostream>
+#include <string>
+
+#include "eixTk/formated.h"
+#include "eixTk/i18n.h"
+#include "eixTk/likely.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/unused.h"
+#include "eixTk/utils.h"
+#include "various/watch.h"
+
+using std::string;
+
+using std::cerr;
+using std::endl;
+
+#ifdef HAVE_SYS_INOTIFY_H
+
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | \
+	IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF)
+
+static int nodot_selector(SCANDIR_ARG3 dent);
+
+static int nodot_selector(SCANDIR_ARG3 dent) {
+	return (dent->d_name[0] != '.');
+}
+
+Watcher::~Watcher() {
+	if(fd >= 0) {
+		close(fd);
+	}
+}
+
+bool Watcher::init(string *errtext) {
+	// The descriptor must not survive the exec of a restart
+#ifdef IN_CLOEXEC
+	fd = inotify_init1(IN_CLOEXEC);
+#else
+	fd = inotify_init();
+	if(likely(fd >= 0)) {
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+	}
+#endif
+	if(likely(fd >= 0)) {
+		return true;
+	}
+	*errtext = eix::format(_("cannot initialize inotify: %s")) % strerror(errno);
+	return false;
+}
+
+bool Watcher::add_watch(const Watch& w) {
+	int wd(inotify_add_watch(fd, w.path.c_str(), WATCH_MASK | IN_ONLYDIR));
+	if(wd < 0) {
+		return false;
+	}
+	watches[wd] = w;
+	return true;
+}
+
+bool Watcher::add(const string& path, const string& cat) {
+	Watch w;
+	w.path = path;
+	w.category = cat;
+	w.restart = false;
+	w.subdirs = false;
+	return add_watch(w);
+}
+
+bool Watcher::add_tree(const string& path, const string& cat) {
+	Watch w;
+	w.path = path;
+	w.category = cat;
+	w.restart = false;
+	w.subdirs = true;
+	if(!add_watch(w)) {
+		return (errno != ENOSPC);
+	}
+	WordVec subdirs;
+	if(!scandir_cc(path, &subdirs, nodot_selector, false)) {
+		return true;
+	}
+	for(WordVec::const_iterator it(subdirs.begin());
+		likely(it != subdirs.end()); ++it) {
+		// Plain files are rejected by IN_ONLYDIR
+		if(unlikely(!add(path + "/" + (*it), cat) && (errno == ENOSPC))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Watcher::add_restart(const string& path, const string& only_name) {
+	Watch w;
+	w.path = path;
+	w.only_name = only_name;
+	w.restart = true;
+	w.subdirs = false;
+	return add_watch(w);
+}
+
+/**
+Read all pending events (blocking if there are none)
+**/
+bool Watcher::read_events(Names *touched, bool *restart, string *errtext) {
+	char buf[16 * (sizeof(struct inotify_event) + 256)]
+		__attribute__ ((aligned(__alignof__(struct inotify_event))));
+	ssize_t len(read(fd, buf, sizeof(buf)));
+	if(unlikely(len <= 0)) {
+		if((len < 0) && (errno == EINTR)) {
+			return true;
+		}
+		*errtext = eix::format(_("cannot read inotify events: %s")) % strerror(errno);
+		return false;
+	}
+	for(char *p(buf); p < buf + len; ) {
+		const struct inotify_event *ev(reinterpret_cast<const struct inotify_event *>(p));
+		p += sizeof(struct inotify_event) + ev->len;
+		if(unlikely(ev->mask & IN_Q_OVERFLOW)) {
+			// Events were lost: Only a full update is reliable
+			cerr << _("warning: inotify events were lost; doing a full update") << endl;
+			*restart = true;
+			continue;
+		}
+		Watches::iterator it(watches.find(ev->wd));
+		if(it == watches.end()) {
+			continue;
+		}
+		string name((ev->len != 0) ? ev->name : "");
+		Watch& w(it->second);
+		if(w.restart) {
+			if(w.only_name.empty() || (w.only_name == name)) {
+				*restart = true;
+			}
+		} else if(!w.category.empty()) {
+			touched->insert(w.category);
+			if(w.subdirs && (ev->mask & (IN_CREATE | IN_MOVED_TO)) && (ev->mask & IN_ISDIR)) {
+				add(w.path + "/" + name, w.category);
+			}
+		} else if(!name.empty()) {
+			touched->insert(name);
+			if((ev->mask & (IN_CREATE | IN_MOVED_TO)) && (ev->mask & IN_ISDIR)) {
+				add(w.path + "/" + name, name);
+			}
+		}
+		if(ev->mask & IN_IGNORED) {
+			watches.erase(it);
+		}
+	}
+	return true;
+}
+
+bool Watcher::wait(unsigned int delay, Names *touched, bool *restart, string *errtext) {
+	touched->clear();
+	*restart = false;
+	if(unlikely(!read_events(touched, restart, errtext))) {
+		return false;
+	}
+	// Collect further changes until it is quiet for delay seconds
+	for(;;) {
+		struct pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		int r(poll(&pfd, 1, static_cast<int>(delay) * 1000));
+		if(r == 0) {
+			return true;
+		}
+		if(unlikely(r < 0)) {
+			if(errno == EINTR) {
+				continue;
+			}
+			*errtext = eix::format(_("cannot read inotify events: %s")) % strerror(errno);
+			return false;
+		}
+		if(unlikely(!read_events(touched, restart, errtext))) {
+			return false;
+		}
+	}
+}
+
+#else
+// ifndef HAVE_SYS_INOTIFY_H
+
+Watcher::~Watcher() {
+}
+
+bool Watcher::init(string *errtext) {
+	*errtext = _("watching is not supported on this system (no inotify)");
+	return false;
+}
+
+bool Watcher::add_watch(const Watch& w ATTRIBUTE_UNUSED) {
+	UNUSED(w);
+	return false;
+}
+
+bool Watcher::add(const string& path ATTRIBUTE_UNUSED, const string& cat ATTRIBUTE_UNUSED) {
+	UNUSED(path);
+	UNUSED(cat);
+	return false;
+}
+
+bool Watcher::add_tree(const string& path ATTRIBUTE_UNUSED, const string& cat ATTRIBUTE_UNUSED) {
+	UNUSED(path);
+	UNUSED(cat);
+	return false;
+}
+
+bool Watcher::add_restart(const string& path ATTRIBUTE_UNUSED, const string& only_name ATTRIBUTE_UNUSED) {
+	UNUSED(path);
+	UNUSED(only_name);
+	return false;
+}
+
+bool Watcher::read_events(Names *touched ATTRIBUTE_UNUSED, bool *restart ATTRIBUTE_UNUSED, string *errtext ATTRIBUTE_UNUSED) {
+	UNUSED(touched);
+	UNUSED(restart);
+	UNUSED(errtext);
+	return false;
+}
+
+bool Watcher::wait(unsigned int delay ATTRIBUTE_UNUSED, Names *touched ATTRIBUTE_UNUSED, bool *restart ATTRIBUTE_UNUSED, string *errtext) {
+	UNUSED(delay);
+	UNUSED(touched);
+	UNUSED(restart);
+	*errtext = _("watching is not supported on this system (no inotify)");
+	return false;
+}
+
+#endif
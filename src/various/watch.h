@@ -0,0 +1,80 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_VARIOUS_WATCH_H_
+#define SRC_VARIOUS_WATCH_H_ 1
+
+#include <map>
+#include <set>
+#include <string>
+
+/**
+Collect changes in directories (using inotify if available).
+Each watched directory is associated with a category whose data become
+stale by changes, or it is marked as requiring a restart.
+**/
+class Watcher {
+	public:
+		typedef std::set<std::string> Names;
+
+		Watcher() : fd(-1) {
+		}
+
+		~Watcher();
+
+		/**
+		@return false (with errtext set) if watching is not possible
+		**/
+		bool init(std::string *errtext) ATTRIBUTE_NONNULL_;
+
+		/**
+		Watch directory path. Changes in it touch category cat.
+		If cat is empty, the name of the changed entry is the category
+		(and newly created subdirectories are watched for that category).
+		@return false if path cannot be watched (e.g. does not exist)
+		**/
+		bool add(const std::string& path, const std::string& cat);
+
+		/**
+		Watch directory path and its subdirectories (one level deep).
+		Changes in any of them touch category cat; subdirectories
+		created later are watched as well.
+		@return false if some subdirectory could not be watched because
+		the limit of inotify watches is exhausted
+		**/
+		bool add_tree(const std::string& path, const std::string& cat);
+
+		/**
+		Watch directory path. Changes in it require a restart.
+		If only_name is nonempty, only changes of this entry count.
+		@return false if path cannot be watched (e.g. does not exist)
+		**/
+		bool add_restart(const std::string& path, const std::string& only_name);
+
+		/**
+		Wait for changes until there is no further change for delay seconds.
+		If events were lost, restart is set, since only a full update is reliable.
+		@return false (with errtext set) on errors
+		**/
+		bool wait(unsigned int delay, Names *touched, bool *restart, std::string *errtext) ATTRIBUTE_NONNULL((3, 4, 5));
+
+	private:
+		class Watch {
+			public:
+				std::string path, category, only_name;
+				bool restart, subdirs;
+		};
+		typedef std::map<int, Watch> Watches;
+
+		int fd;
+		Watches watches;
+
+		bool add_watch(const Watch& w);
+		bool read_events(Names *touched, bool *restart, std::string *errtext) ATTRIBUTE_NONNULL_;
+};
+
+#endif  // SRC_VARIOUS_WATCH_H_